@@ -5,6 +5,11 @@ from conan.tools.system.package_manager import Apt
 class HistoricalMap(ConanFile):
     settings = "os", "compiler", "build_type", "arch"
     generators = "CMakeToolchain", "CMakeDeps"
+    default_options = {
+        # the spatial index and the full-text search of the database
+        "sqlite3/*:enable_rtree": True,
+        "sqlite3/*:enable_fts5": True,
+    }
 
     def layout(self):
         cmake_layout(self)
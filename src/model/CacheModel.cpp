@@ -206,7 +206,7 @@ std::vector<std::string> CacheModel::getCityList(const std::string& source, int
     return {};
 }
 
-std::list<persistence::Coordinate> CacheModel::getContour(const std::string& source, int year, const std::string& name) const
+persistence::Contour CacheModel::getContour(const std::string& source, int year, const std::string& name) const
 {
     std::lock_guard lk(cacheLock);
 
@@ -260,10 +260,10 @@ bool CacheModel::delectFromContour(const std::string& source, int year, const st
 
     if (containsCountry(source, year, name)) {
         auto& infoCache = cache.at(source).at(year);
-        auto& contour = infoCache.getCountry(name).borderContour;
+        auto& country = infoCache.getCountry(name);
+        auto& contour = country.borderContour;
         if (idx < contour.size()) {
-            auto it = std::next(contour.begin(), idx);
-            contour.erase(it);
+            contour.erase(contour.begin() + idx);
             onModificationChange(source, year, true);
             onCountryUpdate(source, year);
             return true;
@@ -279,12 +279,14 @@ bool CacheModel::updateContour(const std::string& source, int year, const std::s
 
     if (containsCountry(source, year, name)) {
         auto& infoCache = cache.at(source).at(year);
-        auto& contour = infoCache.getCountry(name).borderContour;
-        auto it = std::next(contour.begin(), idx);
-        *it = coord;
-        onModificationChange(source, year, true);
-        onCountryUpdate(source, year);
-        return true;
+        auto& country = infoCache.getCountry(name);
+        auto& contour = country.borderContour;
+        if (idx < contour.size()) {
+            contour.update(idx, coord);
+            onModificationChange(source, year, true);
+            onCountryUpdate(source, year);
+            return true;
+        }
     }
 
     return false;
@@ -472,6 +474,28 @@ bool CacheModel::clearRemoved(const std::string& source, int year) noexcept
     return false;
 }
 
+std::optional<persistence::HistoricalCache::Changes> CacheModel::getChanges(const std::string& source, int year) const
+{
+    std::lock_guard lk(cacheLock);
+    if (containsHistoricalInfo(source, year)) {
+        return cache.at(source).at(year).getChanges();
+    }
+
+    return std::nullopt;
+}
+
+bool CacheModel::markSaved(const std::string& source, int year, uint64_t revision)
+{
+    std::lock_guard lk(cacheLock);
+    if (containsHistoricalInfo(source, year) && cache.at(source).at(year).markSaved(revision)) {
+        logger.debug("Mark CacheModel cache for source {} at year {} saved", source, year);
+        onModificationChange(source, year, false);
+        return true;
+    }
+
+    return false;
+}
+
 void CacheModel::setModificationState(const std::string& source, int year, bool isModified)
 {
     std::lock_guard lk(cacheLock);
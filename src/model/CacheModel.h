@@ -41,7 +41,7 @@ public:
     std::optional<std::string> getNote(const std::string& source, int year) const;
     std::vector<std::string> getCountryList(const std::string& source, int year) const;
     std::vector<std::string> getCityList(const std::string& source, int year) const;
-    std::list<persistence::Coordinate> getContour(const std::string& source, int year, const std::string& name) const;
+    persistence::Contour getContour(const std::string& source, int year, const std::string& name) const;
     std::optional<persistence::Coordinate> getCityCoord(const std::string& source, int year, const std::string& name) const;
     bool extendContour(const std::string& source, int year, const std::string& name, const persistence::Coordinate& coord);
     bool delectFromContour(const std::string& source, int year, const std::string& name, int idx);
@@ -57,6 +57,9 @@ public:
     std::optional<persistence::Data> getData(const std::string& source, int year) const noexcept;
     std::optional<persistence::Data> getRemoved(const std::string& source, int year) const noexcept;
     bool clearRemoved(const std::string& source, int year) noexcept;
+    std::optional<persistence::HistoricalCache::Changes> getChanges(const std::string& source, int year) const;
+    // returns false if the year is changed after the revision is taken, it stays modified then
+    bool markSaved(const std::string& source, int year, uint64_t revision);
 
     void setModificationState(const std::string& source, int year, bool isModified);
     bool isModified(const std::string& source, int year);
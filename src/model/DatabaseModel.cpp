@@ -2,6 +2,10 @@
 #include "src/logger/LoggerManager.h"
 #include "src/util/ExecuteablePath.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
 namespace model {
 constexpr int MIN_YEAR = -3000;
 constexpr int MAX_YEAR = 1911;
@@ -10,11 +14,38 @@ constexpr auto LOGGER_NAME = "DatabaseModel";
 
 DatabaseModel::DatabaseModel():
     logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
-    database{std::make_shared<sqlpp::sqlite3::connection_config>(
-        (util::getExecutablePath().remove_filename()/DATABASE_NAME).string(), 
-        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)},
+    contourCache{std::make_shared<persistence::ContourCache>()},
+    database{std::make_shared<sqlpp::sqlite3::connection_config>(getDatabasePath(), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE),
+             contourCache},
     currentYear{QIN_DYNASTY}
 {
+    // the readers are opened after the writer initialized the database and switched it to WAL mode
+    for (size_t i = 0; i < READER_COUNT; i++) {
+        readers.emplace_back(std::make_unique<Database>(
+            std::make_shared<sqlpp::sqlite3::connection_config>(getDatabasePath(), SQLITE_OPEN_READONLY),
+            contourCache));
+        idleReaders.emplace_back(readers.back().get());
+    }
+
+    // the snapshot is enabled as long as its file exists
+    if (std::filesystem::exists(getSnapshotPath())) {
+        database.setRevisionTracking(true);
+        snapshotEnabled = true;
+        openSnapshot();
+    }
+
+    maintenanceWorker.enqueue([this](){ migrateBorders(); });
+    scheduleGarbageCollection();
+}
+
+std::string DatabaseModel::getDatabasePath()
+{
+    return (util::getExecutablePath().remove_filename()/DATABASE_NAME).string();
+}
+
+std::string DatabaseModel::getSnapshotPath()
+{
+    return (util::getExecutablePath().remove_filename()/SNAPSHOT_NAME).string();
 }
 
 DatabaseModel& DatabaseModel::getInstance()
@@ -86,36 +117,493 @@ bool DatabaseModel::moveYearBackward() noexcept
 
 persistence::Data DatabaseModel::loadHistoricalInfo(int year)
 {
+    if (auto data = loadFromSnapshot(year, year)) {
+        logger.debug("Load item from snapshot for year {}.", year);
+        return std::move(data->front());
+    }
+
     logger.debug("Load item from database for year {}.", year);
-    std::scoped_lock lk{lock};
-    return database.load(year);
+    return read([year](Database& reader){ return reader.load(year); });
+}
+
+util::Generator<persistence::Data> DatabaseModel::loadHistoricalInfo(int yearFrom, int yearTo)
+{
+    logger.debug("Load items from database for years [{}, {}].", yearFrom, yearTo);
+
+    for (int from = yearFrom; from <= yearTo; from += RANGE_LOAD_CHUNK) {
+        const auto to = std::min(yearTo, from + RANGE_LOAD_CHUNK - 1);
+        auto chunk = loadFromSnapshot(from, to);
+        if (!chunk) {
+            // don't hold a reader while the caller consumes the years, it may access the database as well
+            chunk = read([from, to](Database& reader){ return reader.load(from, to); });
+        }
+
+        for (auto& data : *chunk) {
+            co_yield std::move(data);
+        }
+    }
+}
+
+persistence::Data DatabaseModel::loadHistoricalInfo(int year, const persistence::BoundingBox& bbox)
+{
+    logger.debug("Load items from database for year {} in west {}, south {}, east {}, north {}.", 
+                 year, bbox.west, bbox.south, bbox.east, bbox.north);
+    return read([year, &bbox](Database& reader){ return reader.load(year, bbox); });
+}
+
+std::vector<persistence::Country> DatabaseModel::loadCountriesAt(int year, const persistence::Coordinate& coordinate)
+{
+    logger.debug("Load countries from database for year {} at latitude {}, longitude {}.", 
+                 year, coordinate.latitude, coordinate.longitude);
+    return read([year, &coordinate](Database& reader){ return reader.loadCountriesAt(year, coordinate); });
+}
+
+std::vector<persistence::BorderPeriod> DatabaseModel::loadCountryTimeline(const std::string& name)
+{
+    logger.debug("Load timeline of {} from database.", name);
+    return read([&name](Database& reader){ return reader.loadCountryTimeline(name); });
+}
+
+std::vector<persistence::SearchHit> DatabaseModel::search(std::string_view text, size_t limit)
+{
+    logger.debug("Search {} in database.", text);
+    return read([text, limit](Database& reader){ return reader.search(text, limit); });
 }
 
 void DatabaseModel::updateHistoricalInfo(const persistence::Data& info)
 {
     logger.debug("Update item to database for year {}.", info.year);
-    std::scoped_lock lk{lock};
-    database.upsert(info);
+    {
+        std::scoped_lock lk{lock};
+        database.upsert(info);
+        markStaleYears();
+    }
+
+    scheduleGarbageCollection();
 }
 
 void DatabaseModel::removeHistoricalInfo(const persistence::Data& info)
 {
     logger.debug("Remove item from database for year {}.", info.year);
-    std::scoped_lock lk{lock};
+    {
+        std::scoped_lock lk{lock};
+        database.remove(info);
+        markStaleYears();
+    }
+
+    scheduleGarbageCollection();
+}
+
+util::Expected<void> DatabaseModel::writeBatch(const std::function<void(WriteBatch&)>& func)
+{
+    logger.debug("Start write batch.");
+    {
+        std::scoped_lock lk{lock};
+        try {
+            database.transaction([this, &func](){
+                WriteBatch batch{this->database, this->logger};
+                func(batch);
+            });
+            markStaleYears();
+        } catch (const std::exception& e) {
+            logger.error("Write batch failed and rolled back, error: {}", e.what());
+            return util::Unexpected{util::Error{util::ErrorCode::DATABASE_ERROR, e.what()}};
+        }
+    }
+
+    logger.debug("Write batch committed.");
+    scheduleGarbageCollection();
+    return util::SUCCESS;
+}
+
+// The years are parsed without holding the lock, it is only held while a batch is written.
+util::Expected<size_t> DatabaseModel::ingest(util::Generator<util::Expected<persistence::Data>> years,
+                                             const std::function<bool(size_t)>& onProgress)
+{
+    logger.debug("Start ingestion.");
+
+    size_t written = 0;
+    std::vector<persistence::Data> batch;
+    batch.reserve(INGEST_BATCH);
+
+    for (bool more = true; more;) {
+        batch.clear();
+        while (batch.size() < INGEST_BATCH && (more = years.next())) {
+            auto data = years.getValue();
+            if (!data) {
+                logger.error("Ingestion stopped after {} years, error: {}", written, data.error().msg);
+                return util::Unexpected{data.error()};
+            }
+
+            batch.emplace_back(std::move(*data));
+        }
+
+        if (batch.empty()) {
+            break;
+        }
+
+        {
+            std::scoped_lock lk{lock};
+            try {
+                database.transaction([this, &batch](){
+                    for (const auto& data : batch) {
+                        this->database.upsert(data);
+                    }
+                });
+                markStaleYears();
+            } catch (const std::exception& e) {
+                logger.error("Ingestion stopped after {} years, error: {}", written, e.what());
+                return util::Unexpected{util::Error{util::ErrorCode::DATABASE_ERROR, e.what()}};
+            }
+        }
+
+        written += batch.size();
+        scheduleGarbageCollection();
+
+        if (!onProgress(written)) {
+            logger.info("Ingestion canceled after {} years.", written);
+            break;
+        }
+    }
+
+    logger.debug("Ingested {} years.", written);
+    return written;
+}
+
+DatabaseModel::WriteBatch::WriteBatch(Database& database, logger::ModuleLogger& logger):
+    database{database},
+    logger{logger}
+{
+}
+
+void DatabaseModel::WriteBatch::updateHistoricalInfo(const persistence::Data& info)
+{
+    logger.debug("Batch update item to database for year {}.", info.year);
+    database.upsert(info);
+}
+
+void DatabaseModel::WriteBatch::removeHistoricalInfo(const persistence::Data& info)
+{
+    logger.debug("Batch remove item from database for year {}.", info.year);
     database.remove(info);
 }
 
+util::Expected<void> DatabaseModel::WriteBatch::saveHistoricalInfo(const persistence::Data& info, 
+                                                                   const persistence::Data& removed)
+{
+    // the year can be negative, which is not a valid savepoint name
+    const auto savepoint = "year_" + std::to_string(info.year < 0 ? -info.year : info.year) + (info.year < 0 ? "_bc" : "");
+
+    try {
+        database.savepoint(savepoint, [this, &info, &removed](){
+            this->database.upsert(info);
+            this->database.remove(removed);
+        });
+    } catch (const std::exception& e) {
+        logger.error("Save year {} failed and rolled back, error: {}", info.year, e.what());
+        return util::Unexpected{util::Error{util::ErrorCode::DATABASE_ERROR, e.what()}};
+    }
+
+    return util::SUCCESS;
+}
+
+void DatabaseModel::WriteBatch::saveHistoricalInfoForRange(const persistence::Data& info, 
+                                                            const persistence::Data& removed, 
+                                                            int yearFrom, 
+                                                            int yearTo)
+{
+    logger.debug("Batch save item to database for years [{}, {}].", yearFrom, yearTo);
+    database.saveRange(info, removed, yearFrom, yearTo);
+}
+
+// The borders written by older versions are rewritten to the compact format in small batches,
+// the lock is released between the batches so the loads and saves are not blocked for long.
+void DatabaseModel::migrateBorders()
+{
+    size_t migrated = 0;
+
+    {
+        std::scoped_lock lk{lock};
+        try {
+            database.transaction([this, &migrated](){
+                migrated = this->database.migrateBorders(BORDER_MIGRATION_BATCH);
+            });
+        } catch (const std::exception& e) {
+            logger.error("Migrate borders failed, error: {}", e.what());
+            return;
+        }
+    }
+
+    if (migrated > 0) {
+        logger.debug("Migrated {} borders to the compact format.", migrated);
+        maintenanceWorker.enqueue([this](){ migrateBorders(); });
+    }
+}
+
+void DatabaseModel::scheduleGarbageCollection()
+{
+    writes++;
+
+    if (!garbageCollectionScheduled.exchange(true)) {
+        maintenanceWorker.enqueue([this, writesBefore = writes.load()](){ collectGarbage(writesBefore); });
+    }
+}
+
+// The deletes only remove the relationships, the countries, borders, cities and notes no year uses
+// anymore are removed here in small slices, the lock is released between the slices so the saves
+// are not blocked for long.
+void DatabaseModel::collectGarbage(uint64_t writesBefore)
+{
+    bool finished = false;
+
+    {
+        std::scoped_lock lk{lock};
+        try {
+            database.transaction([this, &finished](){
+                finished = this->database.collectGarbage(GARBAGE_COLLECTION_SLICE);
+            });
+        } catch (const std::exception& e) {
+            logger.error("Collect garbage failed, error: {}", e.what());
+            garbageCollectionScheduled = false;
+            return;
+        }
+    }
+
+    if (!finished) {
+        maintenanceWorker.enqueue([this, writesBefore](){ collectGarbage(writesBefore); });
+        return;
+    }
+
+    logger.debug("Garbage collection pass finished.");
+    compact();
+    // the writes come in bursts, the snapshot is rebuilt once a burst is collected
+    if (snapshotEnabled) {
+        rebuildSnapshot();
+    }
+
+    garbageCollectionScheduled = false;
+    if (writes != writesBefore) {
+        // the rows left by the writes during the pass may be behind where it has swept
+        scheduleGarbageCollection();
+    }
+}
+
+void DatabaseModel::compact()
+{
+    std::scoped_lock lk{lock};
+    try {
+        if (database.compact(COMPACT_FREE_PAGE_RATIO)) {
+            logger.info("Compacted the database file.");
+        }
+    } catch (const std::exception& e) {
+        logger.error("Compact the database file failed, error: {}", e.what());
+    }
+}
+
 std::vector<std::string> DatabaseModel::loadCityList()
 {
     logger.debug("Load city list for all years.");
-    std::scoped_lock lk{lock};
-    return database.loadCityList();
+    return read([](Database& reader){ return reader.loadCityList(); });
 }
 
 std::optional<persistence::City> DatabaseModel::loadCity(const std::string& name)
 {
     logger.debug("Load city {}.", name);
+    return read([&name](Database& reader){ return reader.loadCity(name); });
+}
+
+void DatabaseModel::openSnapshot()
+{
+    if (!snapshotEnabled) {
+        return;
+    }
+
+    std::shared_ptr<const persistence::Snapshot> opened = persistence::Snapshot::open(getSnapshotPath());
+
     std::scoped_lock lk{lock};
-    return database.loadCity(name);
+    try {
+        const auto revision = database.getYearRevision();
+        std::set<int> changed;
+        if (opened && opened->getRevision() <= revision) {
+            for (const auto year : database.loadYearsChangedAfter(opened->getRevision())) {
+                changed.emplace(year);
+            }
+        } else if (opened) {
+            // written from a newer database than this one
+            opened.reset();
+        }
+
+        if (opened) {
+            logger.info("Opened the snapshot, {} years are changed after it.", changed.size());
+        }
+
+        std::scoped_lock snapshotLk{snapshotLock};
+        snapshot = std::move(opened);
+        staleYears = std::move(changed);
+        seenRevision = revision;
+    } catch (const std::exception& e) {
+        logger.error("Open the snapshot failed, error: {}", e.what());
+    }
+}
+
+void DatabaseModel::markStaleYears()
+{
+    // the years are not stamped while the snapshot is disabled
+    if (!snapshotEnabled) {
+        return;
+    }
+
+    const auto changed = database.loadYearsChangedAfter(seenRevision);
+    seenRevision = database.getYearRevision();
+
+    std::scoped_lock lk{snapshotLock};
+    staleYears.insert(changed.begin(), changed.end());
+}
+
+void DatabaseModel::enableSnapshot(bool enable)
+{
+    if (enable) {
+        logger.info("Enable the snapshot.");
+        {
+            // the years written from now on are stamped, the snapshot is rebuilt from all the years
+            std::scoped_lock lk{lock};
+            database.setRevisionTracking(true);
+            snapshotEnabled = true;
+        }
+        maintenanceWorker.enqueue([this](){ rebuildSnapshot(); });
+        return;
+    }
+
+    logger.info("Disable the snapshot.");
+    snapshotEnabled = false;
+    {
+        std::scoped_lock lk{snapshotLock};
+        snapshot.reset();
+    }
+
+    // after a rebuild which may be running
+    maintenanceWorker.enqueue([this](){
+        if (snapshotEnabled) {
+            return;
+        }
+
+        {
+            std::scoped_lock lk{snapshotLock};
+            snapshot.reset();
+        }
+
+        std::error_code error;
+        std::filesystem::remove(getSnapshotPath(), error);
+
+        // after the file is removed, a file left by a crash never misses a stamp
+        std::scoped_lock lk{lock};
+        if (!snapshotEnabled) {
+            database.setRevisionTracking(false);
+        }
+    });
+}
+
+// Only the sections having a year changed after the current snapshot are loaded from the database,
+// one section at a time, the other sections are copied from the current file as they are. The new
+// file replaces the old one, the loads go to the database while they are swapped.
+void DatabaseModel::rebuildSnapshot()
+{
+    if (!snapshotEnabled) {
+        return;
+    }
+
+    std::shared_ptr<const persistence::Snapshot> current;
+    {
+        std::scoped_lock lk{snapshotLock};
+        current = snapshot;
+    }
+    const auto revision = current ? current->getRevision() : 0;
+
+    uint64_t latest = 0;
+    std::set<int> changedSections;
+    try {
+        read([&latest, &changedSections, revision](Database& reader){
+            // the revision and the years are read from the same snapshot of the database, a section loaded
+            // later may be newer than the revision, the years changed after it are loaded from the database
+            reader.transaction([&reader, &latest, &changedSections, revision](){
+                latest = reader.getYearRevision();
+                if (latest == revision) {
+                    return;
+                }
+
+                for (const auto year : reader.loadYearsChangedAfter(revision)) {
+                    changedSections.emplace(persistence::Snapshot::sectionOf(year));
+                }
+            });
+        });
+    } catch (const std::exception& e) {
+        logger.error("Load the changed years for the snapshot failed, error: {}", e.what());
+        return;
+    }
+
+    if (current && latest == revision) {
+        return;
+    }
+
+    std::set<int> sections = changedSections;
+    if (current) {
+        for (const auto section : current->getSectionList()) {
+            sections.emplace(section);
+        }
+    }
+
+    persistence::Snapshot::Writer writer{getSnapshotPath(), latest};
+    try {
+        for (const auto section : sections) {
+            if (!changedSections.contains(section)) {
+                writer.copy(*current, section);
+                continue;
+            }
+
+            const auto years = persistence::Snapshot::yearsOf(section);
+            for (const auto& data : read([&years](Database& reader){ return reader.load(years.first, years.second); })) {
+                writer.add(data);
+            }
+        }
+    } catch (const std::exception& e) {
+        logger.error("Load the changed sections for the snapshot failed, error: {}", e.what());
+        return;
+    }
+
+    {
+        std::scoped_lock lk{snapshotLock};
+        // the file can't be replaced while it is mapped on Windows
+        snapshot.reset();
+    }
+    current.reset();
+
+    if (const auto ret = writer.finish(); ret) {
+        logger.info("Rebuilt the snapshot, {} of {} sections are changed.", changedSections.size(), sections.size());
+    } else {
+        logger.error("Rebuild the snapshot failed, error: {}", ret.error().msg);
+    }
+
+    openSnapshot();
+}
+
+std::optional<std::vector<persistence::Data>> DatabaseModel::loadFromSnapshot(int yearFrom, int yearTo)
+{
+    std::shared_ptr<const persistence::Snapshot> current;
+    {
+        std::scoped_lock lk{snapshotLock};
+        if (const auto stale = staleYears.lower_bound(yearFrom); 
+            !snapshot || (stale != staleYears.end() && *stale <= yearTo)) {
+            return std::nullopt;
+        }
+
+        current = snapshot;
+    }
+
+    std::vector<persistence::Data> range;
+    for (int year = yearFrom; year <= yearTo; year++) {
+        range.emplace_back(current->loadData(year));
+    }
+
+    return range;
+}
 }
-}
\ No newline at end of file
@@ -3,18 +3,55 @@
 
 #include "src/persistence/Data.h"
 #include "src/persistence/Database.h"
+#include "src/persistence/Snapshot.h"
 #include "src/logger/ModuleLogger.h"
 #include "src/util/Signal.h"
+#include "src/util/Error.h"
+#include "src/util/Worker.h"
+#include "src/util/Generator.h"
 
 #include "sqlpp11/sqlite3/sqlite3.h"
 #include "sqlpp11/sqlite3/connection_config.h"
 
 #include <mutex>
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+#include <string_view>
+#include <condition_variable>
 
 namespace model {
 class DatabaseModel {
+    using Database = persistence::Database<sqlpp::sqlite3::connection, sqlpp::sqlite3::connection_config>;
+
 public:
+    // Writes issued through a WriteBatch share one transaction, see DatabaseModel::writeBatch
+    class WriteBatch {
+    public:
+        void updateHistoricalInfo(const persistence::Data& info);
+        void removeHistoricalInfo(const persistence::Data& info);
+        // Save the modification of a year in its own savepoint, if it fails only 
+        // this year is rolled back and the rest of the batch can continue.
+        util::Expected<void> saveHistoricalInfo(const persistence::Data& info, const persistence::Data& removed);
+        // Apply the same modification to every year in [yearFrom, yearTo], the number of 
+        // statements depends on the size of the modification instead of the range.
+        void saveHistoricalInfoForRange(const persistence::Data& info, 
+                                        const persistence::Data& removed, 
+                                        int yearFrom, 
+                                        int yearTo);
+
+    private:
+        friend class DatabaseModel;
+
+        WriteBatch(Database& database, logger::ModuleLogger& logger);
+
+        Database& database;
+        logger::ModuleLogger& logger;
+    };
+
     static DatabaseModel& getInstance();
 
     bool setYear(int year) noexcept;
@@ -25,10 +62,32 @@ public:
     int getMinYear() const noexcept;
 
     persistence::Data loadHistoricalInfo(int year);
+    // Every year in [yearFrom, yearTo] in order, the years are loaded in chunks
+    // and the lock is released between the chunks.
+    util::Generator<persistence::Data> loadHistoricalInfo(int yearFrom, int yearTo);
+    // Only the countries whose borders intersect bbox and the cities inside it are loaded.
+    persistence::Data loadHistoricalInfo(int year, const persistence::BoundingBox& bbox);
+    std::vector<persistence::Country> loadCountriesAt(int year, const persistence::Coordinate& coordinate);
+    // The periods in which the country keeps the same border, see persistence::Database::loadCountryTimeline
+    std::vector<persistence::BorderPeriod> loadCountryTimeline(const std::string& name);
+    // Ranked hits of the notes, the country names and the city names, see persistence::Database::search
+    std::vector<persistence::SearchHit> search(std::string_view text, size_t limit);
     std::vector<std::string> loadCityList();
     std::optional<persistence::City> loadCity(const std::string& name);
     void updateHistoricalInfo(const persistence::Data& info);
     void removeHistoricalInfo(const persistence::Data& info);
+    // Run func in one transaction, it is committed if func returns 
+    // and rolled back entirely if any write fails outside a savepoint.
+    util::Expected<void> writeBatch(const std::function<void(WriteBatch&)>& func);
+    // Upsert every year of the generator, at most INGEST_BATCH years are held in the memory and written
+    // in one transaction. onProgress is called with the number of years written after each transaction,
+    // it stops the ingestion by returning false. The years written before a failure or a stop are kept.
+    util::Expected<size_t> ingest(util::Generator<util::Expected<persistence::Data>> years,
+                                  const std::function<bool(size_t)>& onProgress);
+    // The years are loaded from a snapshot file mapped into the memory, it is kept up to date in the
+    // background after the writes. It is off unless enabled, disabling it removes the file.
+    void enableSnapshot(bool enable);
+    bool isSnapshotEnabled() const noexcept { return snapshotEnabled; }
 
     DatabaseModel(DatabaseModel&&) = delete;
     DatabaseModel(const DatabaseModel&) = delete;
@@ -39,13 +98,87 @@ public:
 private:
     constexpr static int QIN_DYNASTY = -221;
     constexpr static auto DATABASE_NAME = "HistoricalMapDB";
+    constexpr static auto SNAPSHOT_NAME = "HistoricalMapDB.snapshot";
+
+    constexpr static size_t BORDER_MIGRATION_BATCH = 256;
+    constexpr static int RANGE_LOAD_CHUNK = 128;
+    constexpr static size_t READER_COUNT = 2;
+    constexpr static size_t INGEST_BATCH = 64;
+    // how many rows the garbage collection examines while holding the lock
+    constexpr static size_t GARBAGE_COLLECTION_SLICE = 512;
+    constexpr static double COMPACT_FREE_PAGE_RATIO = 0.25;
 
     logger::ModuleLogger logger;
-    persistence::Database<sqlpp::sqlite3::connection, sqlpp::sqlite3::connection_config> database;
+    // shared by the writer and the readers, a border decoded by one of them is reused by the others
+    std::shared_ptr<persistence::ContourCache> contourCache;
+    // the only connection writing the database, the writes are serialized by the lock
+    Database database;
     std::mutex lock;
+    // the read-only connections, a load takes an idle one and reads the last committed 
+    // snapshot in the WAL, it never waits for the writer
+    std::vector<std::unique_ptr<Database>> readers;
+    std::vector<Database*> idleReaders;
+    std::mutex readerLock;
+    std::condition_variable readerAvailable;
     std::atomic_int currentYear;
+    // bumped by every write, a garbage collection pass is repeated if it changes during the pass
+    std::atomic_uint64_t writes = 0;
+    std::atomic_bool garbageCollectionScheduled = false;
+    // The years are loaded from the snapshot except the ones changed after it is written, those
+    // are loaded from the database until the snapshot is rebuilt. It is null if there is no 
+    // valid snapshot file yet.
+    std::shared_ptr<const persistence::Snapshot> snapshot;
+    std::atomic_bool snapshotEnabled = false;
+    std::set<int> staleYears;
+    std::mutex snapshotLock;
+    // the revision of the years up to which staleYears is updated, guarded by lock
+    uint64_t seenRevision = 0;
+    // runs the border migration and the garbage collection,
+    // declared after the database so it is stopped before the database is closed
+    util::Worker<std::function<void()>> maintenanceWorker;
 
     DatabaseModel();
+
+    static std::string getDatabasePath();
+    static std::string getSnapshotPath();
+    void migrateBorders();
+    // called after every write, the rows it leaves unused are removed in the background
+    void scheduleGarbageCollection();
+    void collectGarbage(uint64_t writesBefore);
+    void compact();
+    // open the snapshot file and find the years changed after it, if the snapshot is enabled
+    void openSnapshot();
+    // called after every committed write with the lock held
+    void markStaleYears();
+    // runs on the maintenance worker
+    void rebuildSnapshot();
+    // nullopt if there is no snapshot or any year of the range is changed after it
+    std::optional<std::vector<persistence::Data>> loadFromSnapshot(int yearFrom, int yearTo);
+
+    template<typename Func>
+    requires (std::is_invocable_v<Func, Database&>)
+    auto read(Func&& func)
+    {
+        Database* reader = nullptr;
+        {
+            std::unique_lock lk{readerLock};
+            readerAvailable.wait(lk, [this](){ return !idleReaders.empty(); });
+            reader = idleReaders.back();
+            idleReaders.pop_back();
+        }
+
+        // the reader is returned to the pool even if func throws
+        const auto release = [this](Database* reader){
+            {
+                std::scoped_lock lk{readerLock};
+                idleReaders.emplace_back(reader);
+            }
+            readerAvailable.notify_one();
+        };
+        std::unique_ptr<Database, decltype(release)> lease{reader, release};
+
+        return func(*lease);
+    }
 };
 }
 
@@ -21,8 +21,8 @@ util::Expected<void> ImportModel::setFormat(const std::string& format)
     }
 }
 
-util::Generator<util::Expected<persistence::Data>> ImportModel::loadFromFile(const std::string& file)
+util::Generator<util::Expected<persistence::Data>> ImportModel::loadFromFile(const std::string& file, bool ordered)
 {
-    return importer->loadFromFile(file);
+    return importer->loadFromFile(file, ordered);
 }
 }
\ No newline at end of file
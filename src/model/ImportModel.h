@@ -17,7 +17,7 @@ public:
 
     std::vector<std::string> getSupportedFormat() const;
     util::Expected<void> setFormat(const std::string& format);
-    util::Generator<util::Expected<persistence::Data>> loadFromFile(const std::string& file);
+    util::Generator<util::Expected<persistence::Data>> loadFromFile(const std::string& file, bool ordered);
 
     ImportModel(ImportModel&&) = delete;
     ImportModel(const ImportModel&) = delete;
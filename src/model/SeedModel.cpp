@@ -0,0 +1,82 @@
+#include "src/model/SeedModel.h"
+#include "src/tile/TileSourceUrl.h"
+
+#include <algorithm>
+
+namespace model {
+constexpr int MIN_ZOOM_LEVEL = 0;
+constexpr int MAX_ZOOM_LEVEL = 18;
+// the web mercator projection doesn't go further to the poles
+constexpr float MAX_LATITUDE = 85.0511f;
+constexpr float MAX_LONGITUDE = 180.0f;
+
+util::Expected<void> SeedModel::start(const std::string& url,
+                                      const std::string& path,
+                                      const BoundingBox& bbox,
+                                      int minZoom,
+                                      int maxZoom,
+                                      const tile::TileSeeder::Options& options)
+{
+    if (isRunning()) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "The seeding is running"}};
+    }
+
+    if (minZoom < MIN_ZOOM_LEVEL || maxZoom > MAX_ZOOM_LEVEL || minZoom > maxZoom) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "Invalid zoom range"}};
+    }
+
+    if (bbox.south >= bbox.north) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "Invalid bounding box"}};
+    }
+
+    // not shared with the map, the seeded tiles would evict the ones in view from the disk cache
+    auto source = std::make_shared<tile::TileSourceUrl>(url);
+    if (!source->setUrl(url)) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "Invalid tile server url"}};
+    }
+
+    seeder = std::make_unique<tile::TileSeeder>(path, std::move(source), options);
+
+    return seeder->start(getTileRanges(bbox, minZoom, maxZoom));
+}
+
+void SeedModel::stop()
+{
+    if (seeder) {
+        seeder->stop();
+    }
+}
+
+tile::TileSeeder::Progress SeedModel::getProgress() const noexcept
+{
+    return seeder ? seeder->getProgress() : tile::TileSeeder::Progress{};
+}
+
+std::vector<tile::Viewport> SeedModel::getTileRanges(const BoundingBox& bbox, int minZoom, int maxZoom)
+{
+    const auto north = std::clamp(bbox.north, -MAX_LATITUDE, MAX_LATITUDE);
+    const auto south = std::clamp(bbox.south, -MAX_LATITUDE, MAX_LATITUDE);
+    const auto west = std::clamp(bbox.west, -MAX_LONGITUDE, MAX_LONGITUDE);
+    const auto east = std::clamp(bbox.east, -MAX_LONGITUDE, MAX_LONGITUDE);
+
+    std::vector<tile::Viewport> ranges;
+    for (auto zoom = minZoom; zoom <= maxZoom; zoom++) {
+        const auto limit = (1 << zoom) - 1;
+        const auto yMin = std::clamp(static_cast<int>(latitude2Y(north, zoom)), 0, limit);
+        const auto yMax = std::clamp(static_cast<int>(latitude2Y(south, zoom)), 0, limit);
+        const auto xOf = [zoom, limit](float longitude) {
+            return std::clamp(static_cast<int>(longitude2X(longitude, zoom)), 0, limit);
+        };
+
+        if (west <= east) {
+            ranges.push_back({zoom, xOf(west), xOf(east), yMin, yMax});
+        } else {
+            // crosses the antimeridian
+            ranges.push_back({zoom, xOf(west), limit, yMin, yMax});
+            ranges.push_back({zoom, 0, xOf(east), yMin, yMax});
+        }
+    }
+
+    return ranges;
+}
+}
@@ -0,0 +1,33 @@
+#ifndef SRC_MODEL_SEED_MODEL_H
+#define SRC_MODEL_SEED_MODEL_H
+
+#include "src/tile/TileSeeder.h"
+#include "src/model/Util.h"
+#include "src/util/Error.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace model {
+// Downloads the tiles of a region at a range of zoom levels into a MBTiles file for offline use
+class SeedModel {
+public:
+    util::Expected<void> start(const std::string& url,
+                               const std::string& path,
+                               const BoundingBox& bbox,
+                               int minZoom,
+                               int maxZoom,
+                               const tile::TileSeeder::Options& options);
+    void stop();
+    bool isRunning() const noexcept { return seeder && seeder->isRunning(); }
+    tile::TileSeeder::Progress getProgress() const noexcept;
+
+    static std::vector<tile::Viewport> getTileRanges(const BoundingBox& bbox, int minZoom, int maxZoom);
+
+private:
+    std::unique_ptr<tile::TileSeeder> seeder;
+};
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "src/model/TileModel.h"
 #include "src/logger/LoggerManager.h"
+#include "src/util/ExecuteablePath.h"
 
 #include <algorithm>
 
@@ -8,6 +9,8 @@ constexpr int MIN_ZOOM_LEVEL = 0;
 constexpr int MAX_ZOOM_LEVEL = 18;
 constexpr int PADDING = 0;
 constexpr auto LOGGER_NAME = "TileModel";
+constexpr auto DISK_CACHE_NAME = "HistoricalMapTiles.db";
+constexpr uint64_t DISK_CACHE_SIZE = 1ull << 30;
 
 TileModel& TileModel::getInstance()
 {
@@ -18,10 +21,12 @@ TileModel& TileModel::getInstance()
 TileModel::TileModel():
     logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
     tileLoader{tile::TileLoader::getInstance()},
-    supportedSourceType{"URL"}
+    supportedSourceType{"URL", "MBTiles", "Directory"},
+    diskCache{std::make_shared<tile::TileDiskCache>((util::getExecutablePath().remove_filename()/DISK_CACHE_NAME).string(), DISK_CACHE_SIZE)}
 {}
 
-std::vector<std::shared_ptr<tile::Tile>> TileModel::getTiles(const Range& xAxis,
+std::vector<std::shared_ptr<tile::Tile>> TileModel::getTiles(const void* owner,
+                                                             const Range& xAxis,
                                                              const Range& yAxis,
                                                              const Vec2& plotSize)
 {
@@ -44,6 +49,8 @@ std::vector<std::shared_ptr<tile::Tile>> TileModel::getTiles(const Range& xAxis,
 
     logger.trace("Zoom {} tile X from [{}, {}], Y from [{}, {}]", zoom, xMin, xMax, yMin, yMax);
 
+    tileLoader.setViewport(owner, {zoom, xMin, xMax, yMin, yMax});
+
     for (auto x = xMin; x <= xMax; x++) {
         for (auto y = yMin; y <= yMax; y++) {
             if (auto tile = tileLoader.loadTile({x, y, zoom}); tile) {
@@ -3,12 +3,13 @@
 
 #include "src/tile/TileEngineFactory.h"
 #include "src/tile/TileLoader.h"
+#include "src/tile/TileDiskCache.h"
 #include "src/model/Util.h"
 #include "src/util/Error.h"
 #include "src/logger/ModuleLogger.h"
 
 #include <string>
-#include <set>
+#include <vector>
 #include <memory>
 
 namespace model {
@@ -17,9 +18,12 @@ public:
     static TileModel& getInstance();
 
     BoundingBox getBoundingBox() const noexcept { return bbox; }
-    std::vector<std::shared_ptr<tile::Tile>> getTiles(const Range& xAxis,
+    // the owner tells the maps on the screen apart, each keeps its own viewport
+    std::vector<std::shared_ptr<tile::Tile>> getTiles(const void* owner,
+                                                      const Range& xAxis,
                                                       const Range& yAxis,
                                                       const Vec2& plotSize);
+    void removeViewport(const void* owner) { tileLoader.removeViewport(owner); }
     Vec2 getTileBoundMax(std::shared_ptr<tile::Tile> tile) const noexcept;
     Vec2 getTileBoundMin(std::shared_ptr<tile::Tile> tile) const noexcept;
 
@@ -28,13 +32,19 @@ public:
     auto getTileSourceTypes() const noexcept { return supportedSourceType; }
     void setTileSource(std::shared_ptr<tile::TileSource> tileSource);
     void clearCache();
+    std::shared_ptr<tile::TileDiskCache> getDiskCache() const noexcept { return diskCache; }
+    void setDiskCacheSize(uint64_t maxSize) { diskCache->setMaxSize(maxSize); }
+    void setConcurrency(size_t fetchWorkers, size_t decodeWorkers) { tileLoader.setConcurrency(fetchWorkers, decodeWorkers); }
+    size_t getFetchWorkers() const noexcept { return tileLoader.getFetchWorkers(); }
+    size_t getDecodeWorkers() const noexcept { return tileLoader.getDecodeWorkers(); }
 
 private:
     TileModel();
 
     logger::ModuleLogger logger;
-    std::set<std::string> supportedSourceType;
+    std::vector<std::string> supportedSourceType;
     tile::TileLoader& tileLoader;
+    std::shared_ptr<tile::TileDiskCache> diskCache;
     int zoom;
     BoundingBox bbox;
 };
@@ -0,0 +1,140 @@
+#ifndef SRC_PERSISTENCE_CONTOUR_CACHE_H
+#define SRC_PERSISTENCE_CONTOUR_CACHE_H
+
+#include "src/persistence/Data.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace persistence {
+// The decoded contours keyed by border id. A border is reused by the years it doesn't change,
+// so a contour decoded for one year is shared by all the others. The cache holds at most capacity
+// points, the least recently used contours are dropped first. The dropped contours stay alive as
+// long as a loaded year still uses them.
+// It can be shared by the connections of the same database file. Every erase starts a new epoch,
+// a reader passes the epoch taken before its snapshot so it neither sees the contours cached after
+// its snapshot nor caches a contour that may have been rewritten since.
+class ContourCache {
+public:
+    // about 32MB of points
+    static constexpr size_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+    explicit ContourCache(size_t capacity = DEFAULT_CAPACITY):
+        capacity{capacity}
+    {
+    }
+
+    uint64_t getEpoch() const
+    {
+        std::scoped_lock lk{lock};
+        return epoch;
+    }
+
+    std::shared_ptr<const Contour::Points> find(uint64_t borderId, uint64_t readerEpoch)
+    {
+        std::scoped_lock lk{lock};
+
+        if (const auto it = index.find(borderId); it != index.end() && it->second->epoch <= readerEpoch) {
+            statistics.hits++;
+            // move it to the front as the most recently used one
+            lifetime.splice(lifetime.begin(), lifetime, it->second);
+            return it->second->points;
+        }
+
+        statistics.misses++;
+        return nullptr;
+    }
+
+    std::shared_ptr<const Contour::Points> find(uint64_t borderId) { return find(borderId, getEpoch()); }
+
+    void insert(uint64_t borderId, std::shared_ptr<const Contour::Points> points, uint64_t readerEpoch)
+    {
+        std::scoped_lock lk{lock};
+
+        // the border may be changed after the reader took its snapshot
+        if (readerEpoch != epoch || !points || points->size() > capacity) {
+            return;
+        }
+
+        drop(borderId);
+
+        size += points->size();
+        lifetime.emplace_front(borderId, epoch, std::move(points));
+        index.emplace(borderId, lifetime.begin());
+
+        while (size > capacity) {
+            drop(lifetime.back().borderId);
+        }
+    }
+
+    void insert(uint64_t borderId, std::shared_ptr<const Contour::Points> points)
+    {
+        insert(borderId, std::move(points), getEpoch());
+    }
+
+    // the border is removed or rewritten, its id may be reused by another border
+    void erase(uint64_t borderId)
+    {
+        std::scoped_lock lk{lock};
+        epoch++;
+        drop(borderId);
+    }
+
+    void clear()
+    {
+        std::scoped_lock lk{lock};
+        epoch++;
+        lifetime.clear();
+        index.clear();
+        size = 0;
+    }
+
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    // how many points are cached
+    size_t getSize() const
+    {
+        std::scoped_lock lk{lock};
+        return size;
+    }
+
+    Statistics getStatistics() const
+    {
+        std::scoped_lock lk{lock};
+        return statistics;
+    }
+
+private:
+    struct Entry {
+        uint64_t borderId;
+        uint64_t epoch;
+        std::shared_ptr<const Contour::Points> points;
+    };
+
+    mutable std::mutex lock;
+    size_t capacity;
+    size_t size = 0;
+    uint64_t epoch = 0;
+    Statistics statistics;
+    std::list<Entry> lifetime;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+    void drop(uint64_t borderId)
+    {
+        if (const auto it = index.find(borderId); it != index.end()) {
+            size -= it->second->points->size();
+            lifetime.erase(it->second);
+            index.erase(it);
+        }
+    }
+};
+}
+
+#endif
@@ -1,9 +1,15 @@
 #ifndef SRC_PERSISTENCE_DATA_H
 #define SRC_PERSISTENCE_DATA_H
 
+#include "src/util/Hash.h"
+
 #include <cereal/archives/binary.hpp>
-#include <cereal/types/list.hpp>
+#include <cereal/types/vector.hpp>
 
+#include <algorithm>
+#include <array>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -11,6 +17,11 @@
 #include <list>
 #include <optional>
 #include <cmath>
+#include <tuple>
+#include <memory>
+#include <iterator>
+#include <initializer_list>
+#include <utility>
 
 namespace persistence {
 struct Coordinate {
@@ -42,9 +53,107 @@ struct Coordinate {
     }
 };
 
+// Contours are stored contiguously, a point costs 8 bytes instead of a list node and
+// the points can be accessed by index. Cereal frames a vector of non-arithmetic type
+// the same way as a list, so the blobs written before are still readable.
+// The points are shared by the copies of a contour, e.g. the same border of adjacent years or 
+// the cached copy of a loaded year, they are only copied when a shared contour is modified.
+// The content hash of the serialized points is cached along, e.g. the one stored in the database
+// when the border is loaded, so an unchanged border doesn't need to be hashed again when it is
+// saved. Every modification goes through detach(), which drops it.
+class Contour {
+public:
+    using Points = std::vector<Coordinate>;
+    using value_type = Coordinate;
+    using size_type = Points::size_type;
+    using const_iterator = Points::const_iterator;
+    // the points can only be modified by the member functions so the shared ones are copied first
+    using iterator = const_iterator;
+
+    Contour() = default;
+
+    Contour(std::initializer_list<Coordinate> coordinates):
+        points{std::make_shared<Points>(coordinates)}
+    {
+    }
+
+    template<std::input_iterator It>
+    Contour(It first, It last):
+        points{std::make_shared<Points>(first, last)}
+    {
+    }
+
+    explicit Contour(Points points):
+        points{std::make_shared<Points>(std::move(points))}
+    {
+    }
+
+    explicit Contour(std::shared_ptr<const Points> points):
+        points{std::move(points)}
+    {
+    }
+
+    const_iterator begin() const noexcept { return getPoints().cbegin(); }
+    const_iterator end() const noexcept { return getPoints().cend(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    size_type size() const noexcept { return getPoints().size(); }
+    bool empty() const noexcept { return getPoints().empty(); }
+    const Coordinate& operator[](size_type idx) const { return getPoints()[idx]; }
+    const Points& getPoints() const noexcept { return points ? *points : EMPTY; }
+    // the points shared with the copies of this contour, it can be nullptr if the contour is empty
+    std::shared_ptr<const Points> share() const noexcept { return points; }
+    const std::optional<util::Hash128>& getHash() const noexcept { return hash; }
+    // the hash has to be the one of the current points
+    void setHash(const std::optional<util::Hash128>& hash) noexcept { this->hash = hash; }
+
+    void reserve(size_type capacity) { detach().reserve(capacity); }
+
+    template<typename... Args>
+    Coordinate& emplace_back(Args&&... args) { return detach().emplace_back(std::forward<Args>(args)...); }
+
+    void push_back(const Coordinate& coordinate) { detach().push_back(coordinate); }
+
+    const_iterator erase(const_iterator pos)
+    {
+        // the iterator belongs to the shared points, find the position before they are copied 
+        const auto idx = pos - begin();
+        auto& own = detach();
+        return own.erase(own.cbegin() + idx);
+    }
+
+    void update(size_type idx, const Coordinate& coordinate) { detach()[idx] = coordinate; }
+
+    bool operator==(const Contour& other) const
+    {
+        return points == other.points || getPoints() == other.getPoints();
+    }
+
+    auto operator<=>(const Contour& other) const { return getPoints() <=> other.getPoints(); }
+
+private:
+    inline static const Points EMPTY;
+
+    std::shared_ptr<const Points> points;
+    std::optional<util::Hash128> hash;
+
+    // make the points owned only by this contour, they are copied if they are shared
+    Points& detach()
+    {
+        hash.reset();
+
+        if (!points || points.use_count() != 1) {
+            points = std::make_shared<Points>(getPoints());
+        }
+
+        // the points are always allocated as non-const, they are only exposed as const to the sharers
+        return const_cast<Points&>(*points);
+    }
+};
+
 struct Country {
     std::string name;
-    std::list<Coordinate> borderContour;
+    Contour borderContour;
 
     auto operator<=>(const Country&) const = default;
 };
@@ -71,6 +180,85 @@ struct Data {
     auto operator<=>(const Data&) const = default;
 };
 
+// A country keeps the same border in every year of [from, to]
+struct BorderPeriod {
+    int from = 0;
+    int to = 0;
+    Contour borderContour;
+
+    bool operator==(const BorderPeriod&) const = default;
+};
+
+struct SearchHit {
+    enum class Kind {
+        NOTE,
+        COUNTRY,
+        CITY
+    };
+
+    int year = 0;
+    Kind kind = Kind::NOTE;
+    // the name of the country or the city, empty for a note
+    std::string name;
+    // the text around the match, the matched terms are enclosed by [ and ]
+    std::string snippet;
+
+    auto operator<=>(const SearchHit&) const = default;
+};
+
+// In degrees, west and east are longitudes, south and north are latitudes
+struct BoundingBox {
+    float west = 0.0f;
+    float south = 0.0f;
+    float east = 0.0f;
+    float north = 0.0f;
+
+    bool intersects(const BoundingBox& other) const noexcept
+    {
+        return west <= other.east && east >= other.west && south <= other.north && north >= other.south;
+    }
+
+    auto operator<=>(const BoundingBox&) const = default;
+};
+
+inline BoundingBox getBoundingBox(const Contour& contour)
+{
+    if (contour.empty()) {
+        return BoundingBox{};
+    }
+
+    BoundingBox bbox{contour[0].longitude, contour[0].latitude, contour[0].longitude, contour[0].latitude};
+    for (const auto& coordinate : contour) {
+        bbox.west = std::min(bbox.west, coordinate.longitude);
+        bbox.east = std::max(bbox.east, coordinate.longitude);
+        bbox.south = std::min(bbox.south, coordinate.latitude);
+        bbox.north = std::max(bbox.north, coordinate.latitude);
+    }
+
+    return bbox;
+}
+
+// The contour is a closed polygon, the last point connects to the first one.
+// Even-odd rule, cast a ray to the east and count how many edges it crosses.
+inline bool contains(const Contour& contour, const Coordinate& coordinate)
+{
+    bool inside = false;
+
+    for (size_t i = 0, j = contour.size() - 1; i < contour.size(); j = i++) {
+        const auto& a = contour[i];
+        const auto& b = contour[j];
+
+        if ((a.latitude > coordinate.latitude) != (b.latitude > coordinate.latitude)) {
+            const auto crossing = a.longitude + (coordinate.latitude - a.latitude) * (b.longitude - a.longitude) / (b.latitude - a.latitude);
+            if (coordinate.longitude < crossing) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
 struct Stream : public std::stringstream {
     using std::stringstream::stringstream;
 
@@ -95,28 +283,139 @@ struct Stream : public std::stringstream {
     }
 };
 
+// The contour blob format version 2:
+//   magic "HMC2" | varint count | count * (zigzag varint delta latitude, zigzag varint delta longitude)
+// The coordinates are quantized to CONTOUR_PRECISION, a tenth of Coordinate::EPSILON, so the
+// decoded contour compares equal to the original one. Consecutive points of a border are close 
+// to each other, most of the deltas fit in one or two bytes instead of four. 
+// The blobs written by cereal before version 2 start with a 8 bytes size, they are still readable.
+constexpr std::array<uint8_t, 4> CONTOUR_MAGIC{'H', 'M', 'C', '2'};
+constexpr double CONTOUR_PRECISION = 1e-3;
+
+inline bool isLegacyContour(const uint8_t* blob, size_t len)
+{
+    return len < CONTOUR_MAGIC.size() || !std::equal(CONTOUR_MAGIC.cbegin(), CONTOUR_MAGIC.cend(), blob);
+}
+
+inline void writeVarint(std::ostream& os, uint64_t value)
+{
+    while (value >= 0x80) {
+        os.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    os.put(static_cast<char>(value));
+}
+
+inline uint64_t readVarint(const uint8_t*& it, const uint8_t* end)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (it == end) {
+            break;
+        }
+
+        const auto byte = *it++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    throw std::runtime_error{"Corrupted contour blob"};
+}
+
+inline uint64_t zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline int64_t quantize(float value)
+{
+    return std::llround(value / CONTOUR_PRECISION);
+}
+
 template<typename T>
-T serializeContour(const std::list<Coordinate>& contour)
+T serializeContour(const Contour& contour)
 {
     T ss;
-    {
-        cereal::BinaryOutputArchive oarchive(ss);
-        oarchive(contour); // Serialize the vector of Coordinates
+    ss.write(reinterpret_cast<const char*>(CONTOUR_MAGIC.data()), CONTOUR_MAGIC.size());
+    writeVarint(ss, contour.size());
+
+    int64_t latitude = 0;
+    int64_t longitude = 0;
+    for (const auto& coordinate : contour) {
+        const auto quantizedLatitude = quantize(coordinate.latitude);
+        const auto quantizedLongitude = quantize(coordinate.longitude);
+
+        writeVarint(ss, zigzagEncode(quantizedLatitude - latitude));
+        writeVarint(ss, zigzagEncode(quantizedLongitude - longitude));
+
+        latitude = quantizedLatitude;
+        longitude = quantizedLongitude;
     }
 
     return ss;
 }
 
+// The format written before version 2, it is only needed to find the borders not migrated yet
 template<typename T>
-auto deserializeContour(T&& ss)
+T serializeLegacyContour(const Contour& contour)
 {
-    std::list<Coordinate> contour;
+    T ss;
     {
+        cereal::BinaryOutputArchive oarchive(ss);
+        oarchive(contour.getPoints());
+    }
+
+    return ss;
+}
+
+inline Contour deserializeContour(const uint8_t* blob, size_t len)
+{
+    Contour::Points contour;
+
+    if (isLegacyContour(blob, len)) {
+        Stream ss{blob, len};
         cereal::BinaryInputArchive iarchive(ss);
-        iarchive(contour); // Deserialize data into deserializedBorderContour
+        iarchive(contour);
+
+        return Contour{std::move(contour)};
+    }
+
+    const auto end = blob + len;
+    auto it = blob + CONTOUR_MAGIC.size();
+    const auto count = readVarint(it, end);
+    // every point takes at least two bytes, don't trust the count of a corrupted blob
+    if (count > static_cast<uint64_t>(end - it) / 2) {
+        throw std::runtime_error{"Corrupted contour blob"};
+    }
+    contour.reserve(count);
+
+    int64_t latitude = 0;
+    int64_t longitude = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        latitude += zigzagDecode(readVarint(it, end));
+        longitude += zigzagDecode(readVarint(it, end));
+
+        contour.emplace_back(static_cast<float>(latitude * CONTOUR_PRECISION), 
+                             static_cast<float>(longitude * CONTOUR_PRECISION));
     }
 
-    return contour;
+    return Contour{std::move(contour)};
+}
+
+template<typename T>
+auto deserializeContour(T&& ss)
+{
+    const auto view = ss.view();
+
+    return deserializeContour(reinterpret_cast<const uint8_t*>(view.data()), view.size());
 }
 
 }
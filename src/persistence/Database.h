@@ -2,6 +2,9 @@
 #define SRC_PERSISTENCE_PERSISTENCE_H
 
 #include "src/persistence/Data.h"
+#include "src/persistence/ContourCache.h"
+#include "src/persistence/SqliteStatement.h"
+#include "src/util/Hash.h"
 
 // These are generated headers
 #include "src/persistence/Commands.h"
@@ -9,12 +12,21 @@
 
 #include "sqlpp11/sqlpp11.h"
 
+#include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <tuple>
 #include <vector>
+#include <array>
+#include <string_view>
+#include <span>
 #include <optional>
 #include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
 
 namespace persistence {
 constexpr const table::Years YEARS;
@@ -26,65 +38,76 @@ constexpr const table::Cities CITIES;
 constexpr const table::Notes NOTES;
 constexpr const table::YearNotes YEAR_NOTES;
 
-template <typename T>
-struct is_expression : std::false_type {};
-
-// Partial specialization for binary_expression_t
-template <typename Lhs, typename O, typename Rhs>
-struct is_expression<sqlpp::binary_expression_t<Lhs, O, Rhs>> : std::true_type {};
-
-// Partial specialization for unary_expression_t
-template <typename O, typename Rhs>
-struct is_expression<sqlpp::unary_expression_t<O, Rhs>> : std::true_type {};
-
-template <typename T>
-inline constexpr bool is_expression_v = is_expression<T>::value;
-
-template <typename T>
-struct is_column : std::false_type {};
-
-template <typename Table, typename ColumnSpec>
-struct is_column<sqlpp::column_t<Table, ColumnSpec>> : std::true_type {};
-
-template <typename T>
-inline constexpr bool is_column_v = is_column<T>::value;
+// the names of the parameters bound to the same column
+SQLPP_ALIAS_PROVIDER(yearFrom);
+SQLPP_ALIAS_PROVIDER(yearTo);
 
 template<typename Connection, typename Config>
 class Database {
 public:
-    Database(std::shared_ptr<Config> config) :
-        conn{config}
+    // A connection opened with SQLITE_OPEN_READONLY only loads, the database has to be initialized 
+    // and migrated by a read-write connection first. The connections of the same file can share 
+    // the contour cache.
+    Database(std::shared_ptr<Config> config, std::shared_ptr<ContourCache> contourCache = std::make_shared<ContourCache>()) :
+        conn{config},
+        readOnly{(config->flags & SQLITE_OPEN_READONLY) != 0},
+        contourCache{std::move(contourCache)}
     {
+        if (readOnly) {
+            hasLegacyBorders = getSchemaVersion() < STRONG_HASH_SCHEMA_VERSION;
+            return;
+        }
+
         // initialize the database if necessary
         for (const auto& command : COMMANDS) {
             conn.execute(command);
         }
 
         conn.execute("PRAGMA foreign_keys = ON;");
+        // the readers see the last committed snapshot instead of waiting for the writer,
+        // it is persistent in the file and an in-memory database ignores it
+        SqliteStatement{conn.native_handle(), "PRAGMA journal_mode = WAL;"}.execute();
+
+        migrate();
     }
 
+    struct StatementStatistics {
+        size_t prepared = 0;
+        size_t executed = 0;
+    };
+
     std::vector<std::string> loadCountryList(int year) 
     {
         std::vector<std::string> countries;
-
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
-
-            for (const auto& row : request<table::YearCountries>(YEAR_COUNTRIES.yearId == yearId)) {
-                const auto countryName = request<table::Countries>(COUNTRIES.id == row.countryId, COUNTRIES.name).front().name;
-
-                countries.emplace_back(countryName);
-            }
+        auto& statement = prepare([](){
+            return sqlpp::select(COUNTRIES.name)
+                   .from(YEARS.join(YEAR_COUNTRIES).on(YEARS.id == YEAR_COUNTRIES.yearId)
+                              .join(COUNTRIES).on(YEAR_COUNTRIES.countryId == COUNTRIES.id))
+                   .where(YEARS.year == sqlpp::parameter(YEARS.year))
+                   .order_by(YEAR_COUNTRIES.id.asc());
+        });
+        statement.params.year = year;
+
+        for (const auto& row : run(statement)) {
+            countries.emplace_back(row.name);
         }
 
         return countries;
     }
 
+    // the cities used by any year, the ones waiting to be collected are skipped
     std::vector<std::string> loadCityList()
     {
         std::vector<std::string> cities;
-
-        for (const auto& row : request<table::Cities>(CITIES.name)) {
+        auto& statement = prepare([](){
+            return sqlpp::select(CITIES.name)
+                   .from(CITIES.join(YEAR_CITIES).on(YEAR_CITIES.cityId == CITIES.id))
+                   .unconditionally()
+                   .group_by(CITIES.id, CITIES.name)
+                   .order_by(CITIES.id.asc());
+        });
+
+        for (const auto& row : run(statement)) {
             cities.emplace_back(row.name);
         }
 
@@ -94,350 +117,1680 @@ public:
     std::vector<std::string> loadCityList(int year)
     {
         std::vector<std::string> cities;
+        auto& statement = prepare([](){
+            return sqlpp::select(CITIES.name)
+                   .from(YEARS.join(YEAR_CITIES).on(YEARS.id == YEAR_CITIES.yearId)
+                              .join(CITIES).on(YEAR_CITIES.cityId == CITIES.id))
+                   .where(YEARS.year == sqlpp::parameter(YEARS.year))
+                   .order_by(YEAR_CITIES.id.asc());
+        });
+        statement.params.year = year;
+
+        for (const auto& row : run(statement)) {
+            cities.emplace_back(row.name);
+        }
 
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        return cities;
+    }
+
+    std::optional<Note> loadNote(int year)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(NOTES.text)
+                   .from(YEARS.join(YEAR_NOTES).on(YEARS.id == YEAR_NOTES.yearId)
+                              .join(NOTES).on(YEAR_NOTES.noteId == NOTES.id))
+                   .where(YEARS.year == sqlpp::parameter(YEARS.year));
+        });
+        statement.params.year = year;
+
+        std::optional<Note> note;
+        for (const auto& row : run(statement)) {
+            note = Note{row.text};
+        }
 
-            for (const auto& row : request<table::YearCities>(YEAR_CITIES.yearId == yearId, YEAR_CITIES.cityId)) {
-                const auto& cityRows = request<table::Cities>(CITIES.id == row.cityId, CITIES.name);
-                const auto& city = cityRows.front();
+        return note;
+    }
 
-                cities.emplace_back(city.name);
-            }
+    std::optional<Country> loadCountry(int year, const std::string& name)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(YEAR_COUNTRIES.borderId, BORDERS.hash)
+                   .from(YEARS.join(YEAR_COUNTRIES).on(YEARS.id == YEAR_COUNTRIES.yearId)
+                              .join(COUNTRIES).on(YEAR_COUNTRIES.countryId == COUNTRIES.id)
+                              .join(BORDERS).on(YEAR_COUNTRIES.borderId == BORDERS.id))
+                   .where(YEARS.year == sqlpp::parameter(YEARS.year) && COUNTRIES.name == sqlpp::parameter(COUNTRIES.name));
+        });
+        statement.params.year = year;
+        statement.params.name = name;
+
+        const auto epoch = contourCache->getEpoch();
+        std::optional<Country> country;
+        for (const auto& row : run(statement)) {
+            country = Country{name, loadBorder(row.borderId, toHash(row.hash), epoch)};
         }
 
-        return cities;
+        return country;
     }
 
-    std::optional<Note> loadNote(int year)
+    std::optional<City> loadCity(int year, const std::string& name)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(CITIES.name, CITIES.latitude, CITIES.longitude)
+                   .from(YEARS.join(YEAR_CITIES).on(YEARS.id == YEAR_CITIES.yearId)
+                              .join(CITIES).on(YEAR_CITIES.cityId == CITIES.id))
+                   .where(YEARS.year == sqlpp::parameter(YEARS.year) && CITIES.name == sqlpp::parameter(CITIES.name));
+        });
+        statement.params.year = year;
+        statement.params.name = name;
+
+        std::optional<City> city;
+        for (const auto& row : run(statement)) {
+            city = City{row.name, Coordinate{static_cast<float>(row.latitude), static_cast<float>(row.longitude)}};
+        }
+
+        return city;
+    }
+
+    std::optional<City> loadCity(const std::string& name)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(CITIES.name, CITIES.latitude, CITIES.longitude)
+                   .from(CITIES.join(YEAR_CITIES).on(YEAR_CITIES.cityId == CITIES.id))
+                   .where(CITIES.name == sqlpp::parameter(CITIES.name))
+                   .limit(1u);
+        });
+        statement.params.name = name;
+
+        std::optional<City> city;
+        for (const auto& row : run(statement)) {
+            city = City{row.name, Coordinate{static_cast<float>(row.latitude), static_cast<float>(row.longitude)}};
+        }
+
+        return city;
+    }
+
+    Data load(int year) 
+    {
+        return std::move(load(year, year).front());
+    }
+
+    // Load every year in [yearFrom, yearTo] with a fixed number of statements, no matter
+    // how many years, countries or cities the range has. The relationship tables are
+    // joined with the entity tables and ordered by the year and the relationship id so the
+    // result keeps the insertion order. Only the borders not in the contour cache
+    // are read and decoded, a border kept by adjacent years is decoded once.
+    // The years without any record are returned empty. The statements run in one
+    // transaction so they read the same snapshot.
+    std::vector<Data> load(int from, int to)
+    {
+        std::vector<Data> range;
+        if (from > to) {
+            return range;
+        }
+
+        refreshLegacyBorders();
+
+        range.reserve(static_cast<size_t>(to - from) + 1);
+        for (int year = from; year <= to; year++) {
+            range.emplace_back(Data{.year = year});
+        }
+        const auto at = [&range, from](int year) -> Data& { return range[year - from]; };
+
+        // taken before the snapshot, see ContourCache
+        const auto epoch = contourCache->getEpoch();
+        transaction([this, &range, &at, from, to, epoch](){
+            auto& countryStatement = prepare([](){
+                return sqlpp::select(YEARS.year, COUNTRIES.name, YEAR_COUNTRIES.borderId, BORDERS.hash)
+                       .from(YEARS.join(YEAR_COUNTRIES).on(YEARS.id == YEAR_COUNTRIES.yearId)
+                                  .join(COUNTRIES).on(YEAR_COUNTRIES.countryId == COUNTRIES.id)
+                                  .join(BORDERS).on(YEAR_COUNTRIES.borderId == BORDERS.id))
+                       .where(YEARS.year >= sqlpp::parameter(sqlpp::integral(), yearFrom) && 
+                              YEARS.year <= sqlpp::parameter(sqlpp::integral(), yearTo))
+                       .order_by(YEARS.year.asc(), YEAR_COUNTRIES.id.asc());
+            });
+            countryStatement.params.yearFrom = from;
+            countryStatement.params.yearTo = to;
+
+            for (const auto& row : run(countryStatement)) {
+                at(row.year).countries.emplace_back(row.name, loadBorder(row.borderId, toHash(row.hash), epoch));
+            }
+
+            auto& cityStatement = prepare([](){
+                return sqlpp::select(YEARS.year, CITIES.name, CITIES.latitude, CITIES.longitude)
+                       .from(YEARS.join(YEAR_CITIES).on(YEARS.id == YEAR_CITIES.yearId)
+                                  .join(CITIES).on(YEAR_CITIES.cityId == CITIES.id))
+                       .where(YEARS.year >= sqlpp::parameter(sqlpp::integral(), yearFrom) && 
+                              YEARS.year <= sqlpp::parameter(sqlpp::integral(), yearTo))
+                       .order_by(YEARS.year.asc(), YEAR_CITIES.id.asc());
+            });
+            cityStatement.params.yearFrom = from;
+            cityStatement.params.yearTo = to;
+
+            for (const auto& row : run(cityStatement)) {
+                at(row.year).cities.emplace_back(row.name, Coordinate{static_cast<float>(row.latitude), static_cast<float>(row.longitude)});
+            }
+
+            auto& noteStatement = prepare([](){
+                return sqlpp::select(YEARS.year, NOTES.text)
+                       .from(YEARS.join(YEAR_NOTES).on(YEARS.id == YEAR_NOTES.yearId)
+                                  .join(NOTES).on(YEAR_NOTES.noteId == NOTES.id))
+                       .where(YEARS.year >= sqlpp::parameter(sqlpp::integral(), yearFrom) && 
+                              YEARS.year <= sqlpp::parameter(sqlpp::integral(), yearTo));
+            });
+            noteStatement.params.yearFrom = from;
+            noteStatement.params.yearTo = to;
+
+            for (const auto& row : run(noteStatement)) {
+                at(row.year).note = Note{row.text};
+            }
+        });
+
+        return range;
+    }
+
+    void upsert(const Data& data)
     {
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        const auto yearId = findOrInsertYear(data.year);
+
+        for (const auto& country : data.countries) {
+            const auto contourHash = hashBorder(country);
+            const auto countryId = findOrInsertCountry(country.name);
+
+            if (const auto relationship = findYearCountry(yearId, countryId); !relationship) {
+                insertYearCountry(yearId, countryId, findOrInsertBorder(contourHash, country.borderContour));
+            } else if (const auto [relationshipId, borderId] = *relationship; 
+                       contourHash != findBorderHash(borderId)) {
+                // The same country in this year already exists but the border is changed,
+                // we don't update the border in place because it may be used by other countries or years,
+                // point the relationship to the new border instead, the old one is collected if nothing uses it.
+                updateYearCountryBorder(relationshipId, findOrInsertBorder(contourHash, country.borderContour));
+            }
+        }
 
-            if (const auto& ret = request<table::YearNotes>(YEAR_NOTES.yearId == yearId, YEAR_NOTES.noteId); !ret.empty()) {
-                return Note{request<table::Notes>(NOTES.id == ret.front().noteId, NOTES.text).front().text};
+        for (const auto& city : data.cities) {
+            const auto cityId = upsertCity(city);
+
+            if (!findYearCity(yearId, cityId)) {
+                insertYearCity(yearId, cityId);
             }
         }
 
-        return std::nullopt;
+        if (data.note) {
+            const auto hashedText = util::hash128(data.note->text);
+            // first search if the text exists, use its id if found otherwise insert it
+            const auto noteId = findOrInsertNote(hashedText, data.note->text);
+
+            if (const auto noteIdFromTable = findYearNote(yearId); !noteIdFromTable) {
+                // This year doesn't have note, 
+                insertYearNote(yearId, noteId);
+            } else if (noteId != *noteIdFromTable) {
+                // This year already has a different note, the old one is collected if no other year uses it
+                updateYearNote(yearId, noteId);
+            }
+        }
     }
 
-    std::optional<Country> loadCountry(int year, const std::string& name)
+    // Only the relationships are removed, the countries, borders, cities and notes no year 
+    // uses anymore are left to collectGarbage().
+    void remove(const Data& data)
     {
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        if (const auto yearId = findYear(data.year); yearId) {
+            for (const auto& country : data.countries) {
+                const auto countryId = findCountry(country.name);
+                auto borderId = findBorder(hashBorder(country));
 
-            if (const auto& country = request<table::Countries>(COUNTRIES.name == name, COUNTRIES.id); !country.empty()) {
-                const auto countryId = country.front().id;
+                if (!borderId && hasLegacyBorders) {
+                    // the border may be stored in the legacy format or with the legacy hash and not migrated yet
+                    borderId = findLegacyBorder(country.borderContour);
+                }
 
-                const auto borderId = request<table::YearCountries>(YEAR_COUNTRIES.yearId == yearId && YEAR_COUNTRIES.countryId == countryId,
-                                                                  YEAR_COUNTRIES.borderId).front().borderId;
-                const auto& borderRows = request<table::Borders>(BORDERS.id == borderId, BORDERS.contour);
-                const auto& borderContour = borderRows.front().contour;
-                const auto& contour = deserializeContour(Stream{borderContour.blob, borderContour.len});
+                if (countryId && borderId) {
+                    removeYearCountry(*yearId, *countryId, *borderId);
+                }
+            }
 
-                return Country{name, contour};
+            for (const auto& city : data.cities) {
+                if (const auto cityId = findCity(city.name); cityId) {
+                    removeYearCity(*yearId, *cityId);
+                }
+            }
+            
+            if (data.note) {
+                const auto hashedText = util::hash128(data.note->text);
+                if (const auto noteId = findNote(hashedText); noteId) {
+                    removeYearNote(*yearId, *noteId);
+                }
             }
         }
+    }
 
-        return std::nullopt;
+    // Load the countries whose borders intersect bbox and the cities inside bbox, the borders
+    // outside are neither read nor decoded. The bounding boxes are looked up in the R*Tree index.
+    Data load(int year, const BoundingBox& bbox)
+    {
+        refreshLegacyBorders();
+
+        Data data{.year = year};
+        const auto epoch = contourCache->getEpoch();
+        transaction([this, &data, &bbox, epoch](){
+            data.countries = loadCountriesIn(data.year, bbox, epoch);
+
+            auto& cityStatement = prepareNative([](){
+                return "SELECT cities.name, cities.latitude, cities.longitude FROM years "
+                       "JOIN yearCities ON yearCities.year_id = years.id "
+                       "JOIN cities ON cities.id = yearCities.city_id "
+                       "JOIN cityBounds ON cityBounds.id = yearCities.city_id "
+                       "WHERE years.year = ?1 AND cityBounds.west <= ?2 AND cityBounds.east >= ?3 AND "
+                       "cityBounds.south <= ?4 AND cityBounds.north >= ?5 "
+                       "ORDER BY yearCities.id;";
+            });
+            bindBoundingBox(cityStatement.bindInt(1, data.year), bbox);
+
+            while (cityStatement.step()) {
+                data.cities.emplace_back(cityStatement.getText(0), 
+                                         Coordinate{static_cast<float>(cityStatement.getDouble(1)), 
+                                                    static_cast<float>(cityStatement.getDouble(2))});
+            }
+            cityStatement.reset();
+
+            data.note = loadNote(data.year);
+        });
+
+        return data;
     }
 
-    std::optional<City> loadCity(int year, const std::string& name)
+    // The countries of the year whose borders contain the coordinate, in the order they are inserted.
+    // Only the borders whose bounding boxes contain the coordinate are tested.
+    std::vector<Country> loadCountriesAt(int year, const Coordinate& coordinate)
     {
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        refreshLegacyBorders();
+
+        const auto epoch = contourCache->getEpoch();
+        auto countries = loadCountriesIn(year, 
+                                         BoundingBox{coordinate.longitude, coordinate.latitude, coordinate.longitude, coordinate.latitude}, 
+                                         epoch);
+        std::erase_if(countries, [&coordinate](const Country& country){ return !contains(country.borderContour, coordinate); });
 
-            if (const auto& ret = request<table::Cities>(CITIES.name == name); !ret.empty()) {
-                const auto& city = ret.front();
+        return countries;
+    }
+
+    // The periods in which the country keeps the same border, ordered by year. The consecutive years
+    // sharing a border are merged by the query, a year without the country ends a period. Year 0 doesn't
+    // exist, -1 and 1 are consecutive. A border used by several periods is decoded once and shared by them.
+    std::vector<BorderPeriod> loadCountryTimeline(const std::string& name)
+    {
+        refreshLegacyBorders();
+
+        std::vector<BorderPeriod> timeline;
+        const auto epoch = contourCache->getEpoch();
+        transaction([this, &name, &timeline, epoch](){
+            std::vector<std::tuple<uint64_t, std::optional<util::Hash128>, size_t>> borderOfPeriods;
+            auto& statement = prepareNative([](){
+                // the years of a run minus their row numbers in the border are the same, which groups the run
+                return "SELECT period.first, period.last, period.border_id, borders.hash FROM ("
+                       "SELECT MIN(year) AS first, MAX(year) AS last, border_id FROM ("
+                       "SELECT years.year AS year, yearCountries.border_id AS border_id, "
+                       "years.year - (years.year > 0) - "
+                       "ROW_NUMBER() OVER (PARTITION BY yearCountries.border_id ORDER BY years.year) AS run "
+                       "FROM countries JOIN yearCountries ON yearCountries.country_id = countries.id "
+                       "JOIN years ON years.id = yearCountries.year_id WHERE countries.name = ?1"
+                       ") GROUP BY border_id, run"
+                       ") AS period JOIN borders ON borders.id = period.border_id ORDER BY period.first;";
+            });
+            statement.bindText(1, name);
+
+            while (statement.step()) {
+                borderOfPeriods.emplace_back(statement.getInt(2), toHash(statement.getBlob(3)), timeline.size());
+                timeline.emplace_back(static_cast<int>(statement.getInt(0)), 
+                                      static_cast<int>(statement.getInt(1)), 
+                                      Contour{});
+            }
+            statement.reset();
 
-                if (const auto& ret = request<table::YearCities>(YEAR_CITIES.yearId == yearId && YEAR_CITIES.cityId == city.id); !ret.empty()) {
-                    return City{city.name, Coordinate{static_cast<float>(city.latitude), static_cast<float>(city.longitude)}};
+            std::unordered_map<uint64_t, Contour> borders;
+            for (const auto& [borderId, hash, period] : borderOfPeriods) {
+                auto it = borders.find(borderId);
+                if (it == borders.end()) {
+                    it = borders.emplace(borderId, loadBorder(borderId, hash, epoch)).first;
                 }
+
+                timeline[period].borderContour = it->second;
             }
+        });
+
+        return timeline;
+    }
+
+    // Search the notes, the country names and the city names, every year using a matched entity is a hit.
+    // The terms separated by spaces all have to be found. The hits are ranked by bm25, the best first.
+    // The full-text index needs terms of at least 3 characters, a query with a shorter term is searched
+    // as one substring instead, the hits are not ranked and ordered by year.
+    std::vector<SearchHit> search(std::string_view text, size_t limit)
+    {
+        std::vector<std::string> terms;
+        for (size_t begin = 0; begin < text.size();) {
+            const auto end = std::min(text.find(' ', begin), text.size());
+            if (end > begin) {
+                terms.emplace_back(text.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+
+        std::vector<SearchHit> hits;
+        if (terms.empty()) {
+            return hits;
+        }
+
+        const bool indexed = std::all_of(terms.begin(), terms.end(), [](const auto& term){ return countCharacters(term) >= 3; });
+        auto& statement = indexed ? 
+            prepareNative([](){
+                return "SELECT year, kind, name, snippet FROM ("
+                       "SELECT years.year AS year, 0 AS kind, '' AS name, "
+                       "snippet(noteSearch, 0, '[', ']', '...', 16) AS snippet, bm25(noteSearch) AS rank "
+                       "FROM noteSearch JOIN yearNotes ON yearNotes.note_id = noteSearch.rowid "
+                       "JOIN years ON years.id = yearNotes.year_id WHERE noteSearch MATCH ?1 "
+                       "UNION ALL "
+                       "SELECT years.year, 1, countrySearch.name, snippet(countrySearch, 0, '[', ']', '...', 16), bm25(countrySearch) "
+                       "FROM countrySearch JOIN yearCountries ON yearCountries.country_id = countrySearch.rowid "
+                       "JOIN years ON years.id = yearCountries.year_id WHERE countrySearch MATCH ?1 "
+                       "UNION ALL "
+                       "SELECT years.year, 2, citySearch.name, snippet(citySearch, 0, '[', ']', '...', 16), bm25(citySearch) "
+                       "FROM citySearch JOIN yearCities ON yearCities.city_id = citySearch.rowid "
+                       "JOIN years ON years.id = yearCities.year_id WHERE citySearch MATCH ?1"
+                       ") ORDER BY rank, year LIMIT ?2;";
+            }).bindText(1, toMatchQuery(terms)) :
+            prepareNative([](){
+                return "SELECT year, kind, name, snippet FROM ("
+                       "SELECT years.year AS year, 0 AS kind, '' AS name, substr(notes.text, 1, 64) AS snippet "
+                       "FROM notes JOIN yearNotes ON yearNotes.note_id = notes.id "
+                       "JOIN years ON years.id = yearNotes.year_id WHERE notes.text LIKE ?1 ESCAPE '\\' "
+                       "UNION ALL "
+                       "SELECT years.year, 1, countries.name, countries.name "
+                       "FROM countries JOIN yearCountries ON yearCountries.country_id = countries.id "
+                       "JOIN years ON years.id = yearCountries.year_id WHERE countries.name LIKE ?1 ESCAPE '\\' "
+                       "UNION ALL "
+                       "SELECT years.year, 2, cities.name, cities.name "
+                       "FROM cities JOIN yearCities ON yearCities.city_id = cities.id "
+                       "JOIN years ON years.id = yearCities.year_id WHERE cities.name LIKE ?1 ESCAPE '\\'"
+                       ") ORDER BY year LIMIT ?2;";
+            }).bindText(1, toLikePattern(text));
+        statement.bindInt(2, static_cast<int64_t>(limit));
+
+        while (statement.step()) {
+            hits.emplace_back(static_cast<int>(statement.getInt(0)),
+                              static_cast<SearchHit::Kind>(statement.getInt(1)),
+                              statement.getText(2),
+                              statement.getText(3));
         }
+        statement.reset();
 
-        return std::nullopt;
+        return hits;
     }
 
-    std::optional<City> loadCity(const std::string& name)
+    // The years are only stamped while the revisions are tracked, it is off by default. A copy of the
+    // years taken before the tracking is turned off can't be brought up to date after it is turned on.
+    void setRevisionTracking(bool enable)
     {
-        if (const auto& ret = request<table::Cities>(CITIES.name == name); !ret.empty()) {
-            const auto& city = ret.front();
+        for (const auto& trigger : REVISION_TRIGGERS) {
+            if (enable) {
+                conn.execute("CREATE TEMP TRIGGER IF NOT EXISTS " + std::string{trigger.name} + " " + std::string{trigger.definition});
+            } else {
+                conn.execute("DROP TRIGGER IF EXISTS temp." + std::string{trigger.name} + ";");
+            }
+        }
+    }
+
+    // The latest revision stamped on the years, see REVISION_TRIGGERS. It is 0 if no year has been written.
+    uint64_t getYearRevision()
+    {
+        auto& statement = prepareNative([](){ return "SELECT IFNULL(MAX(revision), 0) FROM yearRevisions;"; });
+        const auto revision = statement.step() ? static_cast<uint64_t>(statement.getInt(0)) : 0;
+        statement.reset();
+
+        return revision;
+    }
+
+    // The years stamped with a revision after the given one in ascending order, all the years
+    // written before the revisions are tracked are stamped with 1.
+    std::vector<int> loadYearsChangedAfter(uint64_t revision)
+    {
+        std::vector<int> years;
+        auto& statement = prepareNative([](){ return "SELECT year FROM yearRevisions WHERE revision > ?1 ORDER BY year;"; });
+        statement.bindInt(1, static_cast<int64_t>(revision));
 
-            return City{city.name, Coordinate{static_cast<float>(city.latitude), static_cast<float>(city.longitude)}};
+        while (statement.step()) {
+            years.emplace_back(static_cast<int>(statement.getInt(0)));
         }
 
-        return std::nullopt;
+        return years;
     }
 
-    Data load(int year) 
+    // Apply the same modification to every year in [from, to], it has the same result as
+    // upsert(data) and then remove(removed) for each year, the years of data and removed are ignored.
+    // The statements are issued per country, city and note instead of per year, so the number of
+    // statements doesn't grow with the range. Run it in a transaction so they are synced once.
+    void saveRange(const Data& data, const Data& removed, int from, int to)
     {
-        Data data{.year = year};
+        if (from > to) {
+            return;
+        }
 
-        if (const auto& years = request<table::Years>(YEARS.year == year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        prepareForRange([](){
+            return "WITH RECURSIVE range(year) AS (SELECT ?1 UNION ALL SELECT year + 1 FROM range WHERE year < ?2) "
+                   "INSERT OR IGNORE INTO years (year) SELECT year FROM range;";
+        }, from, to).execute();
 
-            for (const auto& row : request<table::YearCountries>(YEAR_COUNTRIES.yearId == yearId)) {
-                const auto countryName = request<table::Countries>(COUNTRIES.id == row.countryId, COUNTRIES.name).front().name;
+        for (const auto& country : data.countries) {
+            const auto countryId = static_cast<int64_t>(findOrInsertCountry(country.name));
+            const auto borderId = static_cast<int64_t>(findOrInsertBorder(hashBorder(country), country.borderContour));
+
+            // the borders replaced in the range are collected afterwards if nothing else uses them
+            prepareForRange([](){
+                return "UPDATE yearCountries SET border_id = ?4 WHERE country_id = ?3 AND border_id != ?4 AND "
+                       "year_id IN (SELECT id FROM years WHERE year BETWEEN ?1 AND ?2);";
+            }, from, to).bindInt(3, countryId).bindInt(4, borderId).execute();
+            prepareForRange([](){
+                return "INSERT INTO yearCountries (year_id, country_id, border_id) SELECT id, ?3, ?4 FROM years "
+                       "WHERE year BETWEEN ?1 AND ?2 AND NOT EXISTS "
+                       "(SELECT 1 FROM yearCountries WHERE year_id = years.id AND country_id = ?3);";
+            }, from, to).bindInt(3, countryId).bindInt(4, borderId).execute();
+        }
 
-                const auto& borderRows = request<table::Borders>(BORDERS.id == row.borderId, BORDERS.contour);
-                const auto& borderContour = borderRows.front().contour;
-                const auto& contour = deserializeContour(Stream{borderContour.blob, borderContour.len});
+        for (const auto& city : data.cities) {
+            const auto cityId = static_cast<int64_t>(upsertCity(city));
 
-                data.countries.emplace_back(countryName, contour);
-            }
+            prepareForRange([](){
+                return "INSERT INTO yearCities (year_id, city_id) SELECT id, ?3 FROM years "
+                       "WHERE year BETWEEN ?1 AND ?2 AND NOT EXISTS "
+                       "(SELECT 1 FROM yearCities WHERE year_id = years.id AND city_id = ?3);";
+            }, from, to).bindInt(3, cityId).execute();
+        }
+
+        if (data.note) {
+            const auto noteId = static_cast<int64_t>(findOrInsertNote(util::hash128(data.note->text), data.note->text));
+
+            prepareForRange([](){
+                return "UPDATE yearNotes SET note_id = ?3 WHERE note_id != ?3 AND "
+                       "year_id IN (SELECT id FROM years WHERE year BETWEEN ?1 AND ?2);";
+            }, from, to).bindInt(3, noteId).execute();
+            prepareForRange([](){
+                return "INSERT INTO yearNotes (year_id, note_id) SELECT id, ?3 FROM years "
+                       "WHERE year BETWEEN ?1 AND ?2 AND NOT EXISTS (SELECT 1 FROM yearNotes WHERE year_id = years.id);";
+            }, from, to).bindInt(3, noteId).execute();
+        }
 
-            for (const auto& row : request<table::YearCities>(YEAR_CITIES.yearId == yearId, YEAR_CITIES.cityId)) {
-                const auto& cityRows = request<table::Cities>(CITIES.id == row.cityId);
-                const auto& city = cityRows.front();
+        for (const auto& country : removed.countries) {
+            const auto countryId = findCountry(country.name);
+            auto borderId = findBorder(hashBorder(country));
 
-                data.cities.emplace_back(city.name, Coordinate{static_cast<float>(city.latitude), static_cast<float>(city.longitude)});
+            if (!borderId && hasLegacyBorders) {
+                borderId = findLegacyBorder(country.borderContour);
             }
 
-            if (const auto& ret = request<table::YearNotes>(YEAR_NOTES.yearId == yearId, YEAR_NOTES.noteId); !ret.empty()) {
-                data.note = Note{request<table::Notes>(NOTES.id == ret.front().noteId, NOTES.text).front().text};
+            if (countryId && borderId) {
+                prepareForRange([](){
+                    return "DELETE FROM yearCountries WHERE country_id = ?3 AND border_id = ?4 AND "
+                           "year_id IN (SELECT id FROM years WHERE year BETWEEN ?1 AND ?2);";
+                }, from, to).bindInt(3, static_cast<int64_t>(*countryId)).bindInt(4, static_cast<int64_t>(*borderId)).execute();
             }
         }
 
-        return data;
+        for (const auto& city : removed.cities) {
+            if (const auto cityId = findCity(city.name); cityId) {
+                prepareForRange([](){
+                    return "DELETE FROM yearCities WHERE city_id = ?3 AND "
+                           "year_id IN (SELECT id FROM years WHERE year BETWEEN ?1 AND ?2);";
+                }, from, to).bindInt(3, static_cast<int64_t>(*cityId)).execute();
+            }
+        }
+
+        if (removed.note) {
+            if (const auto noteId = findNote(util::hash128(removed.note->text)); noteId) {
+                prepareForRange([](){
+                    return "DELETE FROM yearNotes WHERE note_id = ?3 AND "
+                           "year_id IN (SELECT id FROM years WHERE year BETWEEN ?1 AND ?2);";
+                }, from, to).bindInt(3, static_cast<int64_t>(*noteId)).execute();
+            }
+        }
     }
 
-    void upsert(const Data& data)
+    // Rewrite at most limit borders stored in the legacy format or with the legacy hash to the current 
+    // contour format and hash, returns how many borders are rewritten. It returns 0 once all the borders are migrated.
+    size_t migrateBorders(size_t limit)
     {
-        uint64_t yearId = 0;
-        if (const auto& years = request<table::Years>(YEARS.year == data.year, YEARS.id); !years.empty()) {
-            yearId = years.front().id;
-        } else {
-            yearId = insert<table::Years>(YEARS.year = data.year);
+        if (!hasLegacyBorders) {
+            return 0;
         }
 
-        for (const auto& country : data.countries) {
-            const auto stream = serializeContour<Stream>(country.borderContour);
-            const auto contourHash = std::hash<std::string>{}(stream);
-            const auto countryId = upsert<table::Countries>(COUNTRIES.name == country.name, COUNTRIES.name = country.name);
-            uint64_t borderId = 0;
-
-            if (const auto& relationshipsRows = request<table::YearCountries>(YEAR_COUNTRIES.yearId == yearId && YEAR_COUNTRIES.countryId == countryId,
-                                                                              YEAR_COUNTRIES.borderId, YEAR_COUNTRIES.id);
-                                                                              relationshipsRows.empty()) {
-                // We don't use upsert for border because update contour is relative slow
-                if (const auto& borderRow = request<table::Borders>(BORDERS.hash == contourHash, BORDERS.id); borderRow.empty()) {
-                    borderId = insert<table::Borders>(BORDERS.hash = contourHash, BORDERS.contour = std::vector<uint8_t>{stream});
-                } else {
-                    borderId = borderRow.front().id;
-                }
+        std::vector<std::pair<uint64_t, Contour>> legacyBorders;
+        {
+            // walk the borders by id so each call continues where the last one stopped
+            SqliteStatement selectLegacy{conn.native_handle(), 
+                "SELECT id, contour FROM borders WHERE id > ?1 AND (substr(contour, 1, 4) != ?2 OR typeof(hash) != 'blob') "
+                "ORDER BY id LIMIT ?3;"};
+            selectLegacy.bindInt(1, static_cast<int64_t>(lastMigratedBorderId))
+                        .bindBlob(2, CONTOUR_MAGIC)
+                        .bindInt(3, static_cast<int64_t>(limit));
+
+            while (selectLegacy.step()) {
+                const auto blob = selectLegacy.getBlob(1);
+                legacyBorders.emplace_back(selectLegacy.getInt(0), deserializeContour(blob.data(), blob.size()));
+            }
+        }
+
+        for (const auto& [borderId, contour] : legacyBorders) {
+            const auto stream = serializeContour<Stream>(contour);
+            const auto contourHash = util::hash128(stream.view());
 
-                insert<table::YearCountries>(YEAR_COUNTRIES.yearId = yearId,
-                                                    YEAR_COUNTRIES.countryId = countryId,
-                                                    YEAR_COUNTRIES.borderId = borderId);
+            if (const auto existing = findBorder(contourHash); existing) {
+                // the same border has been inserted in the current format already, 
+                // the hash is unique so point the relationships to it instead
+                updateBorderOfYearCountries(borderId, *existing);
+                removeBorder(borderId);
             } else {
-                // The same country in this year already exists, check if the border need to be updated
-                borderId = relationshipsRows.front().borderId;
-                if (contourHash != static_cast<decltype(contourHash)>(request<table::Borders>(BORDERS.id == borderId, 
-                                                                                              BORDERS.hash).front().hash)) {
-                    if (const auto& boardUsedByOthers = request<table::YearCountries>(YEAR_COUNTRIES.borderId == borderId && 
-                                                                                      YEAR_COUNTRIES.id != relationshipsRows.front().id,
-                                                                                      YEAR_COUNTRIES.borderId);
-                                                                                      boardUsedByOthers.empty()) {
-                        // The existing contour is not used on other places, delete it first
-                        remove<table::Borders>(BORDERS.id == borderId);
-                        // then create a new one
-                        borderId = upsert<table::Borders>(BORDERS.hash == contourHash, 
-                                                          BORDERS.hash = contourHash, 
-                                                          BORDERS.contour = std::vector<uint8_t>{stream});
-                        // and insert to the relationship table because the previous relationship is deleted due to ON DELETE CASCADE
-                        insert<table::YearCountries>(YEAR_COUNTRIES.borderId = borderId, 
-                                                     YEAR_COUNTRIES.yearId = yearId,
-                                                     YEAR_COUNTRIES.countryId = countryId);
-                    } else {
-                        // This border is used on other places, we can't update it because it will affect the countries use it
-                        // We create a new one instead if this border doesn't exist
-                        borderId = upsert<table::Borders>(BORDERS.hash == contourHash, 
-                                                          BORDERS.hash = contourHash, 
-                                                          BORDERS.contour = std::vector<uint8_t>{stream});
-                        update<table::YearCountries>(YEAR_COUNTRIES.id == relationshipsRows.front().id,
-                                                     YEAR_COUNTRIES.borderId = borderId);
+                updateBorder(borderId, contourHash, stream);
+            }
+
+            lastMigratedBorderId = borderId;
+        }
+
+        if (legacyBorders.size() < limit) {
+            hasLegacyBorders = false;
+            setSchemaVersion(STRONG_HASH_SCHEMA_VERSION);
+        }
+
+        return legacyBorders.size();
+    }
+
+    // Examine at most limit rows of the borders, countries, cities and notes, continuing where the last 
+    // call stopped, and remove the ones no year uses anymore. Returns true once a pass over all the 
+    // tables is finished, the next call starts a new pass. Run it in a transaction so the removals are synced once.
+    bool collectGarbage(size_t limit)
+    {
+        static constexpr std::array<GarbageSweep, 4> SWEEPS{{
+            {"SELECT id, EXISTS (SELECT 1 FROM yearCountries WHERE border_id = borders.id) FROM borders "
+             "WHERE id > ?1 ORDER BY id LIMIT ?2;", &Database::removeBorder},
+            {"SELECT id, EXISTS (SELECT 1 FROM yearCountries WHERE country_id = countries.id) FROM countries "
+             "WHERE id > ?1 ORDER BY id LIMIT ?2;", &Database::removeCountry},
+            {"SELECT id, EXISTS (SELECT 1 FROM yearCities WHERE city_id = cities.id) FROM cities "
+             "WHERE id > ?1 ORDER BY id LIMIT ?2;", &Database::removeCity},
+            {"SELECT id, EXISTS (SELECT 1 FROM yearNotes WHERE note_id = notes.id) FROM notes "
+             "WHERE id > ?1 ORDER BY id LIMIT ?2;", &Database::removeNote},
+        }};
+
+        while (limit > 0) {
+            const auto& [select, removeOrphan] = SWEEPS[garbageSweep];
+            std::vector<uint64_t> orphans;
+            size_t examined = 0;
+            {
+                // the relationship tables are indexed by the referenced id, each row costs one index lookup
+                SqliteStatement statement{conn.native_handle(), select};
+                statement.bindInt(1, static_cast<int64_t>(lastCollectedId)).bindInt(2, static_cast<int64_t>(limit));
+
+                while (statement.step()) {
+                    examined++;
+                    lastCollectedId = statement.getInt(0);
+                    if (statement.getInt(1) == 0) {
+                        orphans.emplace_back(lastCollectedId);
                     }
                 }
             }
+
+            for (const auto id : orphans) {
+                (this->*removeOrphan)(id);
+            }
+
+            if (examined < limit) {
+                // the end of the table
+                lastCollectedId = 0;
+                if (++garbageSweep == SWEEPS.size()) {
+                    garbageSweep = 0;
+                    return true;
+                }
+            }
+
+            limit -= examined;
         }
 
-        for (const auto& city : data.cities) {
-            const auto cityId = upsert<table::Cities>(CITIES.name == city.name, 
-                                                      CITIES.name = city.name, 
-                                                      CITIES.latitude = city.coordinate.latitude,
-                                                      CITIES.longitude = city.coordinate.longitude);
+        return false;
+    }
 
-            upsert<table::YearCities>(YEAR_CITIES.yearId == yearId && YEAR_CITIES.cityId == cityId, 
-                                      YEAR_CITIES.yearId = yearId, YEAR_CITIES.cityId = cityId);
+    // The removed rows leave free pages in the file, rebuild it if at least freeRatio of the pages
+    // are free. Returns true if the file is rebuilt. It can't be called in a transaction.
+    bool compact(double freeRatio)
+    {
+        int64_t freeCount = 0;
+        int64_t pageCount = 0;
+        {
+            // VACUUM fails while any statement of the connection is in progress
+            SqliteStatement freePages{conn.native_handle(), "PRAGMA freelist_count;"};
+            SqliteStatement pages{conn.native_handle(), "PRAGMA page_count;"};
+            freeCount = freePages.step() ? freePages.getInt(0) : 0;
+            pageCount = pages.step() ? pages.getInt(0) : 0;
         }
 
-        if (data.note) {
-            const auto hashedText = std::hash<std::string>{}(data.note->text);
-            // first search if the text exists
-            int noteId = 0;
-            if (const auto& notesRows = request<table::Notes>(NOTES.hash == hashedText, NOTES.id); notesRows.empty()) {
-                // no same text found, insert it
-                noteId = insert<table::Notes>(NOTES.hash = hashedText, NOTES.text = data.note->text);
-            } else {
-                // same text found, use its id
-                noteId = notesRows.front().id;
+        if (pageCount == 0 || static_cast<double>(freeCount) / static_cast<double>(pageCount) < freeRatio) {
+            return false;
+        }
+
+        // the ids are integer primary keys, they are kept by VACUUM so the contour cache stays valid
+        conn.execute("VACUUM;");
+
+        return true;
+    }
+
+    // How many statements are compiled and how many times they are executed, 
+    // the ratio shows how well the prepared statements are reused.
+    StatementStatistics getStatementStatistics() const noexcept { return statistics; }
+
+    // How many borders are loaded from the contour cache instead of being decoded.
+    ContourCache::Statistics getContourCacheStatistics() const { return contourCache->getStatistics(); }
+
+    // Run func in one transaction so all the statements it issues are journaled
+    // and synced once. Everything is rolled back if func throws. A nested call
+    // runs as a savepoint of the outer transaction.
+    template<typename Func>
+    requires (std::is_invocable_v<Func>)
+    void transaction(Func&& func)
+    {
+        if (transactionDepth > 0) {
+            savepoint("nested_" + std::to_string(transactionDepth), std::forward<Func>(func));
+            return;
+        }
+
+        conn.start_transaction();
+        transactionDepth++;
+
+        try {
+            func();
+        } catch (...) {
+            transactionDepth--;
+            conn.rollback_transaction(false);
+            invalidateChangedBorders();
+            throw;
+        }
+
+        transactionDepth--;
+        conn.commit_transaction();
+        invalidateChangedBorders();
+    }
+
+    // Run func in a savepoint, if func throws only the statements issued by func
+    // are rolled back and the exception is rethrown to the caller.
+    template<typename Func>
+    requires (std::is_invocable_v<Func>)
+    void savepoint(const std::string& name, Func&& func)
+    {
+        conn.execute("SAVEPOINT " + name);
+        transactionDepth++;
+
+        try {
+            func();
+        } catch (...) {
+            transactionDepth--;
+            conn.execute("ROLLBACK TO SAVEPOINT " + name);
+            conn.execute("RELEASE SAVEPOINT " + name);
+            throw;
+        }
+
+        transactionDepth--;
+        conn.execute("RELEASE SAVEPOINT " + name);
+    }
+
+private:
+    // The schema versions stored in "PRAGMA user_version", add the corresponding step to migrate() for a new one.
+    // Version 1 added the indexes of the relationship tables.
+    static constexpr int64_t INDEXED_SCHEMA_VERSION = 1;
+    // Version 2 had all the borders stored in the compact contour format. Version 3 has the borders
+    // and notes hashed by util::hash128 instead of std::hash as well. migrateBorders() rewrites a border
+    // to the compact format and the new hash in one go, so files of version 2 and older are both
+    // brought to version 3: the notes by migrate() and the borders by migrateBorders().
+    static constexpr int64_t STRONG_HASH_SCHEMA_VERSION = 3;
+
+    Connection conn;
+    bool readOnly;
+    int transactionDepth = 0;
+    bool hasLegacyBorders = false;
+    uint64_t lastMigratedBorderId = 0;
+    StatementStatistics statistics;
+    std::shared_ptr<ContourCache> contourCache;
+    // the borders changed by the current transaction
+    std::unordered_set<uint64_t> changedBorders;
+    // where collectGarbage() stopped
+    size_t garbageSweep = 0;
+    uint64_t lastCollectedId = 0;
+    // statement shape -> prepared statement of this connection, the key is the type of the lambda
+    // building the statement so each call site is compiled only once
+    std::unordered_map<std::type_index, std::shared_ptr<void>> preparedStatements;
+
+    // The full-text indexes of the notes, the country names and the city names. They are external content 
+    // tables, only the index is stored and the text is read from the indexed table. The triggers keep 
+    // them in sync with every insert and delete, including the ones of collectGarbage(). The trigram 
+    // tokenizer matches any substring of at least 3 characters, the text is mostly Chinese without spaces.
+    static constexpr std::array<std::string_view, 12> SEARCH_COMMANDS{
+        "CREATE VIRTUAL TABLE IF NOT EXISTS noteSearch USING fts5(text, content='notes', content_rowid='id', tokenize='trigram');",
+        "CREATE VIRTUAL TABLE IF NOT EXISTS countrySearch USING fts5(name, content='countries', content_rowid='id', tokenize='trigram');",
+        "CREATE VIRTUAL TABLE IF NOT EXISTS citySearch USING fts5(name, content='cities', content_rowid='id', tokenize='trigram');",
+        "CREATE TRIGGER IF NOT EXISTS noteSearchInsert AFTER INSERT ON notes BEGIN "
+        "INSERT INTO noteSearch (rowid, text) VALUES (new.id, new.text); END;",
+        "CREATE TRIGGER IF NOT EXISTS noteSearchDelete AFTER DELETE ON notes BEGIN "
+        "INSERT INTO noteSearch (noteSearch, rowid, text) VALUES ('delete', old.id, old.text); END;",
+        "CREATE TRIGGER IF NOT EXISTS noteSearchUpdate AFTER UPDATE OF text ON notes BEGIN "
+        "INSERT INTO noteSearch (noteSearch, rowid, text) VALUES ('delete', old.id, old.text); "
+        "INSERT INTO noteSearch (rowid, text) VALUES (new.id, new.text); END;",
+        "CREATE TRIGGER IF NOT EXISTS countrySearchInsert AFTER INSERT ON countries BEGIN "
+        "INSERT INTO countrySearch (rowid, name) VALUES (new.id, new.name); END;",
+        "CREATE TRIGGER IF NOT EXISTS countrySearchDelete AFTER DELETE ON countries BEGIN "
+        "INSERT INTO countrySearch (countrySearch, rowid, name) VALUES ('delete', old.id, old.name); END;",
+        "CREATE TRIGGER IF NOT EXISTS countrySearchUpdate AFTER UPDATE OF name ON countries BEGIN "
+        "INSERT INTO countrySearch (countrySearch, rowid, name) VALUES ('delete', old.id, old.name); "
+        "INSERT INTO countrySearch (rowid, name) VALUES (new.id, new.name); END;",
+        "CREATE TRIGGER IF NOT EXISTS citySearchInsert AFTER INSERT ON cities BEGIN "
+        "INSERT INTO citySearch (rowid, name) VALUES (new.id, new.name); END;",
+        "CREATE TRIGGER IF NOT EXISTS citySearchDelete AFTER DELETE ON cities BEGIN "
+        "INSERT INTO citySearch (citySearch, rowid, name) VALUES ('delete', old.id, old.name); END;",
+        "CREATE TRIGGER IF NOT EXISTS citySearchUpdate AFTER UPDATE OF name ON cities BEGIN "
+        "INSERT INTO citySearch (citySearch, rowid, name) VALUES ('delete', old.id, old.name); "
+        "INSERT INTO citySearch (rowid, name) VALUES (new.id, new.name); END;",
+    };
+
+    // The bounding boxes of the borders and the cities keyed by their ids, a city is a box of a point
+    static constexpr std::array<std::string_view, 2> SPATIAL_COMMANDS{
+        "CREATE VIRTUAL TABLE IF NOT EXISTS borderBounds USING rtree(id, west, east, south, north);",
+        "CREATE VIRTUAL TABLE IF NOT EXISTS cityBounds USING rtree(id, west, east, south, north);",
+    };
+
+    // Every change of what a year has stamps the year with the next revision, a copy of the years
+    // taken at a revision, e.g. a Snapshot, only has to reload the years stamped after it. The 
+    // coordinate of a city is shared by the years using it, they are all stamped when it is updated.
+    static constexpr std::array<std::string_view, 2> REVISION_COMMANDS{
+        "CREATE TABLE IF NOT EXISTS yearRevisions (year INTEGER PRIMARY KEY, revision INTEGER NOT NULL);",
+        // the next revision is looked up by every stamp
+        "CREATE INDEX IF NOT EXISTS yearRevisionsRevisionIndex ON yearRevisions (revision);",
+    };
+
+    // A stamp costs a lookup and an upsert per written row, so the triggers are only created while
+    // the revisions are tracked, see setRevisionTracking(). They are TEMP triggers of the connection
+    // writing the database, nothing is left in the file.
+    struct RevisionTrigger {
+        std::string_view name;
+        std::string_view definition;
+    };
+
+    static constexpr std::array<RevisionTrigger, 9> REVISION_TRIGGERS{
+        RevisionTrigger{"yearCountriesRevisionInsert",
+            "AFTER INSERT ON yearCountries BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = new.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearCountriesRevisionUpdate",
+            "AFTER UPDATE ON yearCountries BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = new.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearCountriesRevisionDelete",
+            "AFTER DELETE ON yearCountries BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = old.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearCitiesRevisionInsert",
+            "AFTER INSERT ON yearCities BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = new.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearCitiesRevisionDelete",
+            "AFTER DELETE ON yearCities BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = old.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearNotesRevisionInsert",
+            "AFTER INSERT ON yearNotes BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = new.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearNotesRevisionUpdate",
+            "AFTER UPDATE ON yearNotes BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = new.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"yearNotesRevisionDelete",
+            "AFTER DELETE ON yearNotes BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM years WHERE id = old.year_id ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+        RevisionTrigger{"cityRevisionUpdate",
+            "AFTER UPDATE OF latitude, longitude ON cities "
+            "WHEN old.latitude != new.latitude OR old.longitude != new.longitude BEGIN "
+            "INSERT INTO yearRevisions (year, revision) SELECT years.year, (SELECT IFNULL(MAX(revision), 0) + 1 FROM yearRevisions) "
+            "FROM yearCities JOIN years ON years.id = yearCities.year_id WHERE yearCities.city_id = new.id "
+            "ON CONFLICT (year) DO UPDATE SET revision = excluded.revision; END;"},
+    };
+
+    // Select the rows of a table after ?1 in the order of id, at most ?2 rows, with a flag telling 
+    // if any relationship uses the row, and the member removing an unused row.
+    struct GarbageSweep {
+        std::string_view select;
+        void (Database::*removeOrphan)(uint64_t);
+    };
+
+    // The tables and indexes are created by COMMANDS if they don't exist, this only does the
+    // work that can't be expressed by "IF NOT EXISTS" for the files created by older versions.
+    void migrate()
+    {
+        const auto version = getSchemaVersion();
+
+        if (version < INDEXED_SCHEMA_VERSION) {
+            // collect the statistics so the query planner picks the new indexes for the existing data
+            conn.execute("ANALYZE;");
+            setSchemaVersion(INDEXED_SCHEMA_VERSION);
+        }
+
+        if (version < STRONG_HASH_SCHEMA_VERSION) {
+            rehashNotes();
+        }
+
+        // rewriting the borders takes time, it is done incrementally by migrateBorders()
+        hasLegacyBorders = version < STRONG_HASH_SCHEMA_VERSION;
+
+        if (!hasTable("borderBounds")) {
+            transaction([this](){ buildSpatialIndex(); });
+        }
+
+        if (!hasTable("noteSearch")) {
+            transaction([this](){ buildSearchIndex(); });
+        }
+
+        if (!hasTable("yearRevisions")) {
+            transaction([this](){ trackYearRevisions(); });
+        }
+
+        // the files written by the previous version keep the triggers in the file
+        for (const auto& trigger : REVISION_TRIGGERS) {
+            conn.execute("DROP TRIGGER IF EXISTS main." + std::string{trigger.name} + ";");
+        }
+    }
+
+    // The years already in the file are stamped with the first revision, they are all
+    // changed after revision 0.
+    void trackYearRevisions()
+    {
+        for (const auto command : REVISION_COMMANDS) {
+            conn.execute(std::string{command});
+        }
+
+        conn.execute("INSERT INTO yearRevisions (year, revision) SELECT year, 1 FROM years;");
+    }
+
+    // Like the spatial index, the tables and the triggers are not in Table.sql, the trigger bodies
+    // can't be split by Ddl2SqlCommands.py. The indexes are rebuilt from the existing rows once.
+    void buildSearchIndex()
+    {
+        for (const auto command : SEARCH_COMMANDS) {
+            conn.execute(std::string{command});
+        }
+
+        conn.execute("INSERT INTO noteSearch (noteSearch) VALUES ('rebuild');");
+        conn.execute("INSERT INTO countrySearch (countrySearch) VALUES ('rebuild');");
+        conn.execute("INSERT INTO citySearch (citySearch) VALUES ('rebuild');");
+    }
+
+    // Each term is quoted so the characters of the FTS5 query syntax in the input are matched as they are
+    static std::string toMatchQuery(const std::vector<std::string>& terms)
+    {
+        std::string query;
+        for (const auto& term : terms) {
+            if (!query.empty()) {
+                query += ' ';
             }
 
-            if (const auto& yearNotesRows = request<table::YearNotes>(YEAR_NOTES.yearId == yearId, YEAR_NOTES.noteId); yearNotesRows.empty()) {
-                // This year doesn't have note, 
-                insert<table::YearNotes>(YEAR_NOTES.yearId = yearId, YEAR_NOTES.noteId = noteId);
-            } else {
-                // This year already has note, check if it is the same
-                const size_t noteIdFromTable = yearNotesRows.front().noteId;
-                if (noteId != noteIdFromTable) {
-                    update<table::YearNotes>(YEAR_NOTES.yearId == yearId, YEAR_NOTES.noteId = noteId);
-                    if (const auto& ret = request<table::YearNotes>(YEAR_NOTES.noteId == noteIdFromTable); ret.empty()) {
-                        // the noteId is not used in other years, we are safe to delete the old one after update the noteId in the yearNotes table
-                        remove<table::Notes>(NOTES.id == noteIdFromTable);
-                    }
+            query += '"';
+            for (const auto c : term) {
+                query += c;
+                if (c == '"') {
+                    query += '"';
                 }
             }
+            query += '"';
         }
+
+        return query;
     }
 
-    void remove(const Data& data)
+    static std::string toLikePattern(std::string_view text)
     {
-        if (const auto& years = request<table::Years>(YEARS.year == data.year, YEARS.id); !years.empty()) {
-            const auto yearId = years.front().id;
+        std::string pattern{"%"};
+        for (const auto c : text) {
+            if (c == '%' || c == '_' || c == '\\') {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        pattern += '%';
 
-            for (const auto& country : data.countries) {
-                std::optional<uint64_t> countryId;
-                std::optional<uint64_t> borderId;
-                const auto stream  = serializeContour<Stream>(country.borderContour);
-                const auto contourHash = std::hash<std::string>{}(stream);
+        return pattern;
+    }
 
-                if (const auto rows = request<table::Countries>(COUNTRIES.name == country.name, COUNTRIES.id); !rows.empty()) {
-                    countryId = rows.front().id;
-                }
+    static size_t countCharacters(std::string_view text)
+    {
+        // the continuation bytes of UTF-8 are 10xxxxxx
+        return std::count_if(text.begin(), text.end(), [](char c){ return (static_cast<uint8_t>(c) & 0xC0) != 0x80; });
+    }
 
-                if (const auto rows = request<table::Borders>(BORDERS.hash == contourHash, BORDERS.id); !rows.empty()) {
-                    borderId = rows.front().id;
-                }
+    bool hasTable(std::string_view name)
+    {
+        SqliteStatement statement{conn.native_handle(), "SELECT 1 FROM sqlite_master WHERE name = ?1;"};
+        return statement.bindText(1, name).step();
+    }
 
-                if (countryId && borderId) {
-                    remove<table::YearCountries>(YEAR_COUNTRIES.yearId == yearId &&
-                                                 YEAR_COUNTRIES.countryId == *countryId &&
-                                                 YEAR_COUNTRIES.borderId == *borderId);
-                }
+    // The R*Tree tables are not in Table.sql because sqlpp11 can't generate the table types for virtual
+    // tables. They are filled from the existing borders and cities once, then maintained by the writes.
+    void buildSpatialIndex()
+    {
+        for (const auto command : SPATIAL_COMMANDS) {
+            conn.execute(std::string{command});
+        }
 
-                if (countryId) {
-                    if (const auto& rows = request<table::YearCountries>(YEAR_COUNTRIES.countryId == *countryId, YEAR_COUNTRIES.id); rows.empty()) {
-                        // we don't have any record of this country in the relationships table, so we can safely remove it from the countries table
-                        remove<table::Countries>(COUNTRIES.id == *countryId);
-                    }
-                }
-                
-                if (borderId) {
-                    if (const auto& rows = request<table::YearCountries>(YEAR_COUNTRIES.borderId == *borderId, YEAR_COUNTRIES.id); rows.empty()) {
-                        // we don't have any record of this border in the relationships table, so we can safely remove it from the borders table
-                        remove<table::Borders>(BORDERS.id == *borderId);
-                    }
-                }
+        std::vector<std::pair<uint64_t, BoundingBox>> bounds;
+        {
+            SqliteStatement selectBorders{conn.native_handle(), "SELECT id, contour FROM borders;"};
+            while (selectBorders.step()) {
+                const auto blob = selectBorders.getBlob(1);
+                bounds.emplace_back(selectBorders.getInt(0), getBoundingBox(deserializeContour(blob.data(), blob.size())));
             }
+        }
 
-            for (const auto& city : data.cities) {
-                if (const auto& rows = request<table::Cities>(CITIES.name == city.name); !rows.empty()) {
-                    const auto cityId = rows.front().id;
+        for (const auto& [borderId, bbox] : bounds) {
+            insertBorderBounds(borderId, bbox);
+        }
 
-                    remove<table::YearCities>(YEAR_CITIES.cityId == cityId && YEAR_CITIES.yearId == yearId);
+        conn.execute("INSERT OR REPLACE INTO cityBounds (id, west, east, south, north) "
+                     "SELECT id, longitude, longitude, latitude, latitude FROM cities;");
+    }
 
-                    if (const auto rows = request<table::YearCities>(YEAR_CITIES.cityId == cityId); rows.empty()) {
-                        // we don't have any record of this city in the yearCities table, so we can safely remove it from the cities table
-                        remove<table::Cities>(CITIES.id == cityId);
-                    }
-                }
+    // There are only a few notes, they are rehashed at once. The notes rehashed before are skipped
+    // so it is fine to run it again until the borders are migrated and the schema version is updated.
+    void rehashNotes()
+    {
+        std::vector<std::pair<int64_t, std::string>> notes;
+        {
+            SqliteStatement selectLegacy{conn.native_handle(), "SELECT id, text FROM notes WHERE typeof(hash) != 'blob';"};
+            while (selectLegacy.step()) {
+                notes.emplace_back(selectLegacy.getInt(0), selectLegacy.getText(1));
             }
-            
-            if (data.note) {
-                const auto hashedText = std::hash<std::string>{}(data.note->text);
-                if (const auto& notesRows = request<table::Notes>(NOTES.hash == hashedText, NOTES.id); !notesRows.empty()) {
-                    const auto noteId = notesRows.front().id;
+        }
 
-                    remove<table::YearNotes>(YEAR_NOTES.noteId == noteId && YEAR_NOTES.yearId == yearId);
+        SqliteStatement updateHash{conn.native_handle(), "UPDATE notes SET hash = ?1 WHERE id = ?2;"};
+        for (const auto& [id, text] : notes) {
+            updateHash.bindBlob(1, util::hash128(text).bytes()).bindInt(2, id).execute();
+        }
+    }
 
-                    if (const auto& yearNotesRows = request<table::YearNotes>(YEAR_NOTES.noteId == noteId && YEAR_NOTES.yearId != yearId); yearNotesRows.empty()) {
-                        // this note is not used in other years, it is safe to delete it
-                        remove<table::Notes>(NOTES.hash == hashedText);
-                    }
-                }
+    // The hash stored in the database is only trusted once the legacy hashes are migrated,
+    // a legacy hash read as a blob is the text of the integer.
+    std::optional<util::Hash128> toHash(std::span<const uint8_t> hash) const
+    {
+        if (hasLegacyBorders) {
+            return std::nullopt;
+        }
+
+        return util::Hash128::fromBytes(hash.data(), hash.size());
+    }
+
+    template<typename Blob>
+    std::optional<util::Hash128> toHash(const Blob& hash) const
+    {
+        return toHash(std::span<const uint8_t>{hash.blob, hash.len});
+    }
+
+    static std::vector<uint8_t> toBlob(const util::Hash128& hash)
+    {
+        const auto bytes = hash.bytes();
+        return std::vector<uint8_t>{bytes.cbegin(), bytes.cend()};
+    }
+
+    // a country loaded from the database carries the hash of its border, only the modified
+    // or new borders are serialized and hashed
+    static util::Hash128 hashBorder(const Country& country)
+    {
+        if (const auto& hash = country.borderContour.getHash(); hash) {
+            return *hash;
+        }
+
+        return util::hash128(serializeContour<Stream>(country.borderContour).view());
+    }
+
+    void refreshLegacyBorders()
+    {
+        if (readOnly && hasLegacyBorders) {
+            // the borders are migrated by the read-write connection
+            hasLegacyBorders = getSchemaVersion() < STRONG_HASH_SCHEMA_VERSION;
+        }
+    }
+
+    int64_t getSchemaVersion()
+    {
+        SqliteStatement getVersion{conn.native_handle(), "PRAGMA user_version;"};
+        return getVersion.step() ? getVersion.getInt(0) : 0;
+    }
+
+    // The border is dropped from the contour cache at once for the loads of this connection. It is
+    // dropped again when the transaction ends, for the readers whose snapshots are taken before the commit.
+    void invalidateBorder(uint64_t borderId)
+    {
+        contourCache->erase(borderId);
+
+        if (transactionDepth > 0) {
+            changedBorders.emplace(borderId);
+        }
+    }
+
+    void invalidateChangedBorders()
+    {
+        for (const auto borderId : changedBorders) {
+            contourCache->erase(borderId);
+        }
+
+        changedBorders.clear();
+    }
+
+    void setSchemaVersion(int64_t version)
+    {
+        conn.execute("PRAGMA user_version = " + std::to_string(version) + ";");
+    }
+
+    // the cached statements of saveRange, ?1 and ?2 are bound to the first and the last year of the range
+    template<typename Factory>
+    requires (std::is_invocable_r_v<std::string_view, Factory>)
+    SqliteStatement& prepareForRange(Factory&& factory, int from, int to)
+    {
+        auto& statement = prepareNative(std::forward<Factory>(factory));
+        statement.bindInt(1, from).bindInt(2, to);
+
+        return statement;
+    }
+
+    template<typename Factory>
+    requires (std::is_invocable_v<Factory>)
+    auto& prepare(Factory&& factory)
+    {
+        using Statement = decltype(conn.prepare(factory()));
+        const std::type_index key{typeid(std::remove_cvref_t<Factory>)};
+
+        auto it = preparedStatements.find(key);
+        if (it == preparedStatements.end()) {
+            it = preparedStatements.emplace(key, std::make_shared<Statement>(conn.prepare(factory()))).first;
+            statistics.prepared++;
+        }
+
+        return *static_cast<Statement*>(it->second.get());
+    }
+
+    // The same cache for the statements sqlpp11 can't express, e.g. the ones on the R*Tree tables,
+    // the factory returns the SQL. Step a select to the end or reset it after use.
+    template<typename Factory>
+    requires (std::is_invocable_r_v<std::string_view, Factory>)
+    SqliteStatement& prepareNative(Factory&& factory)
+    {
+        const std::type_index key{typeid(std::remove_cvref_t<Factory>)};
+
+        auto it = preparedStatements.find(key);
+        if (it == preparedStatements.end()) {
+            it = preparedStatements.emplace(key, std::make_shared<SqliteStatement>(conn.native_handle(), factory())).first;
+            statistics.prepared++;
+        }
+
+        statistics.executed++;
+        auto& statement = *static_cast<SqliteStatement*>(it->second.get());
+        // in case the last use threw before the statement was finished
+        statement.reset();
+
+        return statement;
+    }
+
+    template<typename Statement>
+    auto run(Statement& statement)
+    {
+        statistics.executed++;
+        return conn(statement);
+    }
+
+    // A cached select has to be stepped through all its rows, otherwise it stays active 
+    // and keeps the read transaction open until the next time it is executed.
+    template<typename Statement>
+    bool exists(Statement& statement)
+    {
+        bool found = false;
+        for ([[maybe_unused]] const auto& row : run(statement)) {
+            found = true;
+        }
+
+        return found;
+    }
+
+    std::optional<uint64_t> findYear(int year)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(YEARS.id).from(YEARS).where(YEARS.year == sqlpp::parameter(YEARS.year));
+        });
+        statement.params.year = year;
+
+        std::optional<uint64_t> id;
+        for (const auto& row : run(statement)) {
+            id = row.id;
+        }
+
+        return id;
+    }
+
+    uint64_t findOrInsertYear(int year)
+    {
+        if (const auto id = findYear(year); id) {
+            return *id;
+        }
+
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(YEARS).set(YEARS.year = sqlpp::parameter(YEARS.year));
+        });
+        statement.params.year = year;
+
+        return run(statement);
+    }
+
+    std::optional<uint64_t> findCountry(const std::string& name)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(COUNTRIES.id).from(COUNTRIES).where(COUNTRIES.name == sqlpp::parameter(COUNTRIES.name));
+        });
+        statement.params.name = name;
+
+        std::optional<uint64_t> id;
+        for (const auto& row : run(statement)) {
+            id = row.id;
+        }
+
+        return id;
+    }
+
+    uint64_t findOrInsertCountry(const std::string& name)
+    {
+        if (const auto id = findCountry(name); id) {
+            return *id;
+        }
+
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(COUNTRIES).set(COUNTRIES.name = sqlpp::parameter(COUNTRIES.name));
+        });
+        statement.params.name = name;
+
+        return run(statement);
+    }
+
+    void removeCountry(uint64_t countryId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(COUNTRIES).where(COUNTRIES.id == sqlpp::parameter(COUNTRIES.id));
+        });
+        statement.params.id = countryId;
+
+        run(statement);
+    }
+
+    std::optional<uint64_t> findBorder(const util::Hash128& hash)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(BORDERS.id).from(BORDERS).where(BORDERS.hash == sqlpp::parameter(BORDERS.hash));
+        });
+        statement.params.hash = toBlob(hash);
+
+        std::optional<uint64_t> id;
+        for (const auto& row : run(statement)) {
+            id = row.id;
+        }
+
+        return id;
+    }
+
+    std::vector<Country> loadCountriesIn(int year, const BoundingBox& bbox, uint64_t epoch)
+    {
+        std::vector<std::tuple<std::string, uint64_t, std::optional<util::Hash128>>> rows;
+        auto& statement = prepareNative([](){
+            return "SELECT countries.name, yearCountries.border_id, borders.hash FROM years "
+                   "JOIN yearCountries ON yearCountries.year_id = years.id "
+                   "JOIN countries ON countries.id = yearCountries.country_id "
+                   "JOIN borders ON borders.id = yearCountries.border_id "
+                   "JOIN borderBounds ON borderBounds.id = yearCountries.border_id "
+                   "WHERE years.year = ?1 AND borderBounds.west <= ?2 AND borderBounds.east >= ?3 AND "
+                   "borderBounds.south <= ?4 AND borderBounds.north >= ?5 "
+                   "ORDER BY yearCountries.id;";
+        });
+        bindBoundingBox(statement.bindInt(1, year), bbox);
+
+        while (statement.step()) {
+            rows.emplace_back(statement.getText(0), statement.getInt(1), toHash(statement.getBlob(2)));
+        }
+        statement.reset();
+
+        // finish the statement before the borders are read
+        std::vector<Country> countries;
+        countries.reserve(rows.size());
+        for (auto& [name, borderId, hash] : rows) {
+            countries.emplace_back(std::move(name), loadBorder(borderId, hash, epoch));
+        }
+
+        return countries;
+    }
+
+    // ?2 to ?5 of the statements selecting by a bounding box
+    static SqliteStatement& bindBoundingBox(SqliteStatement& statement, const BoundingBox& bbox)
+    {
+        return statement.bindDouble(2, bbox.east)
+                        .bindDouble(3, bbox.west)
+                        .bindDouble(4, bbox.north)
+                        .bindDouble(5, bbox.south);
+    }
+
+    Contour loadBorder(uint64_t borderId, uint64_t epoch)
+    {
+        // a reader may cache the committed version of a border changed by the current transaction
+        if (!changedBorders.contains(borderId)) {
+            if (auto points = contourCache->find(borderId, epoch); points) {
+                return Contour{std::move(points)};
             }
         }
+
+        auto& statement = prepare([](){
+            return sqlpp::select(BORDERS.contour).from(BORDERS).where(BORDERS.id == sqlpp::parameter(BORDERS.id));
+        });
+        statement.params.id = borderId;
+
+        Contour contour;
+        for (const auto& row : run(statement)) {
+            contour = deserializeContour(row.contour.blob, row.contour.len);
+        }
+
+        // the borders changed by an uncommitted transaction are not visible to the other connections
+        if (changedBorders.empty()) {
+            contourCache->insert(borderId, contour.share(), epoch);
+        }
+
+        return contour;
     }
 
-private:
-    Connection conn;
+    // the border with the hash stored along, so it isn't hashed again if it is saved unchanged
+    Contour loadBorder(uint64_t borderId, const std::optional<util::Hash128>& hash, uint64_t epoch)
+    {
+        auto contour = loadBorder(borderId, epoch);
+        contour.setHash(hash);
 
-    template<typename Table>
-    auto request()
+        return contour;
+    }
+
+    // a legacy hash is never equal to a util::Hash128
+    std::optional<util::Hash128> findBorderHash(uint64_t borderId)
     {
-        constexpr const Table table;
-        return conn(sqlpp::select(sqlpp::all_of(table)).from(table).unconditionally());
+        auto& statement = prepare([](){
+            return sqlpp::select(BORDERS.hash).from(BORDERS).where(BORDERS.id == sqlpp::parameter(BORDERS.id));
+        });
+        statement.params.id = borderId;
+
+        std::optional<util::Hash128> hash;
+        for (const auto& row : run(statement)) {
+            hash = util::Hash128::fromBytes(row.hash.blob, row.hash.len);
+        }
+
+        return hash;
     }
 
-    template<typename Table, typename... Column>
-    requires (is_column_v<std::remove_cvref_t<Column>>&&...)
-    auto request(Column&&... column)
+    // the border stored with the std::hash of the contour, in either the legacy or the current format
+    std::optional<uint64_t> findLegacyBorder(const Contour& contour)
     {
-        constexpr const Table table;
-        return conn(sqlpp::select(std::forward<Column>(column)...).from(table).unconditionally());
+        SqliteStatement selectLegacy{conn.native_handle(), "SELECT id FROM borders WHERE hash = ?1 OR hash = ?2;"};
+        selectLegacy.bindInt(1, static_cast<int64_t>(std::hash<std::string>{}(serializeLegacyContour<Stream>(contour))))
+                    .bindInt(2, static_cast<int64_t>(std::hash<std::string>{}(serializeContour<Stream>(contour))));
+
+        std::optional<uint64_t> id;
+        while (selectLegacy.step()) {
+            id = selectLegacy.getInt(0);
+        }
+
+        return id;
     }
 
-    template<typename Table, typename Expression, typename... Column>
-    requires (is_expression_v<std::remove_cvref_t<Expression>>)
-    auto request(Expression&& expression, Column&&... column)
+    // the contour is only serialized when the border doesn't exist
+    uint64_t findOrInsertBorder(const util::Hash128& hash, const Contour& contour)
     {
-        constexpr const Table table;
-        return conn(sqlpp::select(std::forward<Column>(column)...).from(table).where(std::forward<Expression>(expression)));
+        if (const auto id = findBorder(hash); id) {
+            return *id;
+        }
+
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(BORDERS).set(BORDERS.hash = sqlpp::parameter(BORDERS.hash), 
+                                                   BORDERS.contour = sqlpp::parameter(BORDERS.contour));
+        });
+        statement.params.hash = toBlob(hash);
+        statement.params.contour = std::vector<uint8_t>{serializeContour<Stream>(contour)};
+
+        const auto id = run(statement);
+        // the id of a removed border can be reused
+        invalidateBorder(id);
+        insertBorderBounds(id, getBoundingBox(contour));
+
+        return id;
     }
 
-    template<typename Table, typename Expression>
-    requires (is_expression_v<std::remove_cvref_t<Expression>>)
-    auto request(Expression&& expression)
+    void insertBorderBounds(uint64_t borderId, const BoundingBox& bbox)
     {
-        constexpr const Table table;
-        return conn(sqlpp::select(sqlpp::all_of(table)).from(table).where(std::forward<Expression>(expression)));
+        prepareNative([](){ 
+            return "INSERT OR REPLACE INTO borderBounds (id, west, east, south, north) VALUES (?1, ?2, ?3, ?4, ?5);"; 
+        }).bindInt(1, static_cast<int64_t>(borderId))
+          .bindDouble(2, bbox.west)
+          .bindDouble(3, bbox.east)
+          .bindDouble(4, bbox.south)
+          .bindDouble(5, bbox.north)
+          .execute();
     }
- 
-    template<typename Table, typename... Assignment>
-    uint64_t insert(Assignment&&... assignment)
+
+    void updateBorder(uint64_t borderId, const util::Hash128& hash, const Stream& stream)
     {
-        constexpr const Table table;
-        return conn(sqlpp::insert_into(table).set(std::make_tuple(std::forward<Assignment>(assignment)...)));
+        auto& statement = prepare([](){
+            return sqlpp::update(BORDERS)
+                   .set(BORDERS.hash = sqlpp::parameter(BORDERS.hash), 
+                        BORDERS.contour = sqlpp::parameter(BORDERS.contour))
+                   .where(BORDERS.id == sqlpp::parameter(BORDERS.id));
+        });
+        statement.params.hash = toBlob(hash);
+        statement.params.contour = std::vector<uint8_t>{stream};
+        statement.params.id = borderId;
+
+        run(statement);
+        invalidateBorder(borderId);
     }
 
-    template<typename Table, typename Expression, typename... Assignment>
-    void update(Expression&& expression, Assignment&&... assignment)
+    void removeBorder(uint64_t borderId)
     {
-        constexpr const Table table;
-        conn(sqlpp::update(table).set(std::make_tuple(std::forward<Assignment>(assignment)...)).where(std::forward<Expression>(expression)));
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(BORDERS).where(BORDERS.id == sqlpp::parameter(BORDERS.id));
+        });
+        statement.params.id = borderId;
+
+        run(statement);
+        invalidateBorder(borderId);
+
+        prepareNative([](){ return "DELETE FROM borderBounds WHERE id = ?1;"; })
+            .bindInt(1, static_cast<int64_t>(borderId))
+            .execute();
     }
 
-    template<typename Table, typename Expression, typename... Assignment>
-    uint64_t upsert(Expression&& expression, Assignment&&... assignment)
+    // returns the relationship id and the border id
+    std::optional<std::pair<uint64_t, uint64_t>> findYearCountry(uint64_t yearId, uint64_t countryId)
     {
-        // Here we can't forward the expression otherwise it will be moved inside the sqlpp,
-        // and the expression used by the following update will have empty expression
-        if (const auto& ret = request<Table>(expression); ret.empty()) {
-            return insert<Table>(std::forward<Assignment>(assignment)...);
-        } else {
-            uint64_t id = ret.front().id;
-            update<Table>(std::forward<Expression>(expression), std::forward<Assignment>(assignment)...);
-            return id;
+        auto& statement = prepare([](){
+            return sqlpp::select(YEAR_COUNTRIES.id, YEAR_COUNTRIES.borderId)
+                   .from(YEAR_COUNTRIES)
+                   .where(YEAR_COUNTRIES.yearId == sqlpp::parameter(YEAR_COUNTRIES.yearId) && 
+                          YEAR_COUNTRIES.countryId == sqlpp::parameter(YEAR_COUNTRIES.countryId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.countryId = countryId;
+
+        std::optional<std::pair<uint64_t, uint64_t>> relationship;
+        for (const auto& row : run(statement)) {
+            relationship = std::pair<uint64_t, uint64_t>(row.id, row.borderId);
         }
+
+        return relationship;
+    }
+
+    void insertYearCountry(uint64_t yearId, uint64_t countryId, uint64_t borderId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(YEAR_COUNTRIES).set(YEAR_COUNTRIES.yearId = sqlpp::parameter(YEAR_COUNTRIES.yearId),
+                                                          YEAR_COUNTRIES.countryId = sqlpp::parameter(YEAR_COUNTRIES.countryId),
+                                                          YEAR_COUNTRIES.borderId = sqlpp::parameter(YEAR_COUNTRIES.borderId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.countryId = countryId;
+        statement.params.borderId = borderId;
+
+        run(statement);
+    }
+
+    void updateYearCountryBorder(uint64_t relationshipId, uint64_t borderId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::update(YEAR_COUNTRIES)
+                   .set(YEAR_COUNTRIES.borderId = sqlpp::parameter(YEAR_COUNTRIES.borderId))
+                   .where(YEAR_COUNTRIES.id == sqlpp::parameter(YEAR_COUNTRIES.id));
+        });
+        statement.params.borderId = borderId;
+        statement.params.id = relationshipId;
+
+        run(statement);
+    }
+
+    void updateBorderOfYearCountries(uint64_t oldBorderId, uint64_t newBorderId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::update(YEAR_COUNTRIES)
+                   .set(YEAR_COUNTRIES.borderId = sqlpp::parameter(YEAR_COUNTRIES.borderId))
+                   .where(YEAR_COUNTRIES.borderId == sqlpp::parameter(BORDERS.id));
+        });
+        statement.params.borderId = newBorderId;
+        statement.params.id = oldBorderId;
+
+        run(statement);
+    }
+
+    void removeYearCountry(uint64_t yearId, uint64_t countryId, uint64_t borderId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(YEAR_COUNTRIES)
+                   .where(YEAR_COUNTRIES.yearId == sqlpp::parameter(YEAR_COUNTRIES.yearId) &&
+                          YEAR_COUNTRIES.countryId == sqlpp::parameter(YEAR_COUNTRIES.countryId) &&
+                          YEAR_COUNTRIES.borderId == sqlpp::parameter(YEAR_COUNTRIES.borderId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.countryId = countryId;
+        statement.params.borderId = borderId;
+
+        run(statement);
+    }
+
+    std::optional<uint64_t> findCity(const std::string& name)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(CITIES.id).from(CITIES).where(CITIES.name == sqlpp::parameter(CITIES.name));
+        });
+        statement.params.name = name;
+
+        std::optional<uint64_t> id;
+        for (const auto& row : run(statement)) {
+            id = row.id;
+        }
+
+        return id;
+    }
+
+    uint64_t upsertCity(const City& city)
+    {
+        const auto id = updateOrInsertCity(city);
+
+        prepareNative([](){ 
+            return "INSERT OR REPLACE INTO cityBounds (id, west, east, south, north) VALUES (?1, ?2, ?2, ?3, ?3);"; 
+        }).bindInt(1, static_cast<int64_t>(id))
+          .bindDouble(2, city.coordinate.longitude)
+          .bindDouble(3, city.coordinate.latitude)
+          .execute();
+
+        return id;
+    }
+
+    uint64_t updateOrInsertCity(const City& city)
+    {
+        if (const auto id = findCity(city.name); id) {
+            auto& statement = prepare([](){
+                return sqlpp::update(CITIES)
+                       .set(CITIES.latitude = sqlpp::parameter(CITIES.latitude), 
+                            CITIES.longitude = sqlpp::parameter(CITIES.longitude))
+                       .where(CITIES.id == sqlpp::parameter(CITIES.id));
+            });
+            statement.params.latitude = city.coordinate.latitude;
+            statement.params.longitude = city.coordinate.longitude;
+            statement.params.id = *id;
+
+            run(statement);
+            return *id;
+        }
+
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(CITIES).set(CITIES.name = sqlpp::parameter(CITIES.name),
+                                                  CITIES.latitude = sqlpp::parameter(CITIES.latitude), 
+                                                  CITIES.longitude = sqlpp::parameter(CITIES.longitude));
+        });
+        statement.params.name = city.name;
+        statement.params.latitude = city.coordinate.latitude;
+        statement.params.longitude = city.coordinate.longitude;
+
+        return run(statement);
+    }
+
+    void removeCity(uint64_t cityId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(CITIES).where(CITIES.id == sqlpp::parameter(CITIES.id));
+        });
+        statement.params.id = cityId;
+
+        run(statement);
+
+        prepareNative([](){ return "DELETE FROM cityBounds WHERE id = ?1;"; })
+            .bindInt(1, static_cast<int64_t>(cityId))
+            .execute();
+    }
+
+    bool findYearCity(uint64_t yearId, uint64_t cityId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(YEAR_CITIES.id)
+                   .from(YEAR_CITIES)
+                   .where(YEAR_CITIES.yearId == sqlpp::parameter(YEAR_CITIES.yearId) && 
+                          YEAR_CITIES.cityId == sqlpp::parameter(YEAR_CITIES.cityId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.cityId = cityId;
+
+        return exists(statement);
+    }
+
+    void insertYearCity(uint64_t yearId, uint64_t cityId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(YEAR_CITIES).set(YEAR_CITIES.yearId = sqlpp::parameter(YEAR_CITIES.yearId), 
+                                                       YEAR_CITIES.cityId = sqlpp::parameter(YEAR_CITIES.cityId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.cityId = cityId;
+
+        run(statement);
+    }
+
+    void removeYearCity(uint64_t yearId, uint64_t cityId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(YEAR_CITIES)
+                   .where(YEAR_CITIES.yearId == sqlpp::parameter(YEAR_CITIES.yearId) && 
+                          YEAR_CITIES.cityId == sqlpp::parameter(YEAR_CITIES.cityId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.cityId = cityId;
+
+        run(statement);
+    }
+
+    std::optional<uint64_t> findNote(const util::Hash128& hash)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(NOTES.id).from(NOTES).where(NOTES.hash == sqlpp::parameter(NOTES.hash));
+        });
+        statement.params.hash = toBlob(hash);
+
+        std::optional<uint64_t> id;
+        for (const auto& row : run(statement)) {
+            id = row.id;
+        }
+
+        return id;
+    }
+
+    uint64_t findOrInsertNote(const util::Hash128& hash, const std::string& text)
+    {
+        if (const auto id = findNote(hash); id) {
+            return *id;
+        }
+
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(NOTES).set(NOTES.hash = sqlpp::parameter(NOTES.hash), 
+                                                 NOTES.text = sqlpp::parameter(NOTES.text));
+        });
+        statement.params.hash = toBlob(hash);
+        statement.params.text = text;
+
+        return run(statement);
+    }
+
+    void removeNote(uint64_t noteId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(NOTES).where(NOTES.id == sqlpp::parameter(NOTES.id));
+        });
+        statement.params.id = noteId;
+
+        run(statement);
+    }
+
+    std::optional<uint64_t> findYearNote(uint64_t yearId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::select(YEAR_NOTES.noteId).from(YEAR_NOTES).where(YEAR_NOTES.yearId == sqlpp::parameter(YEAR_NOTES.yearId));
+        });
+        statement.params.yearId = yearId;
+
+        std::optional<uint64_t> noteId;
+        for (const auto& row : run(statement)) {
+            noteId = row.noteId;
+        }
+
+        return noteId;
+    }
+
+    void insertYearNote(uint64_t yearId, uint64_t noteId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::insert_into(YEAR_NOTES).set(YEAR_NOTES.yearId = sqlpp::parameter(YEAR_NOTES.yearId), 
+                                                      YEAR_NOTES.noteId = sqlpp::parameter(YEAR_NOTES.noteId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.noteId = noteId;
+
+        run(statement);
+    }
+
+    void updateYearNote(uint64_t yearId, uint64_t noteId)
+    {
+        auto& statement = prepare([](){
+            return sqlpp::update(YEAR_NOTES)
+                   .set(YEAR_NOTES.noteId = sqlpp::parameter(YEAR_NOTES.noteId))
+                   .where(YEAR_NOTES.yearId == sqlpp::parameter(YEAR_NOTES.yearId));
+        });
+        statement.params.noteId = noteId;
+        statement.params.yearId = yearId;
+
+        run(statement);
     }
 
-    template<typename Table, typename Expression>
-    auto remove(Expression&& expression)
+    void removeYearNote(uint64_t yearId, uint64_t noteId)
     {
-        constexpr const Table table;
-        return conn(sqlpp::remove_from(table).where(std::forward<Expression>(expression)));
+        auto& statement = prepare([](){
+            return sqlpp::remove_from(YEAR_NOTES)
+                   .where(YEAR_NOTES.yearId == sqlpp::parameter(YEAR_NOTES.yearId) && 
+                          YEAR_NOTES.noteId == sqlpp::parameter(YEAR_NOTES.noteId));
+        });
+        statement.params.yearId = yearId;
+        statement.params.noteId = noteId;
+
+        run(statement);
     }
 };
 }
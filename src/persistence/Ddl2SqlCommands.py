@@ -11,7 +11,10 @@ def main():
 
     with open(args.ddl, 'r') as ddl:
         contents = ddl.read(-1)
-        commands = re.findall('(CREATE TABLE.*?;)', contents, re.DOTALL)
+        # remove the comments first otherwise the semicolons in them will split the commands
+        contents = re.sub('--.*', '', contents)
+        # tables have to be created before the indexes referring them, keep the order in the ddl
+        commands = re.findall('(CREATE (?:TABLE|INDEX).*?;)', contents, re.DOTALL)
 
         with open(args.target, 'w') as out:
             out.write("// This file is automatically generated, do not modify.\n")
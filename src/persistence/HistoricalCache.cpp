@@ -43,18 +43,30 @@ HistoricalCache::HistoricalCache(persistence::Data&& info):
     constructCityInfo();
 }
 
+// the mutable reference is only taken to modify the entity
 persistence::Country& HistoricalCache::getCountry(const std::string& name)
 {
-    return *countries.at(name);
+    auto& country = *countries.at(name);
+    changedCountries.emplace(name);
+    revision++;
+
+    return country;
 }
 
 persistence::City& HistoricalCache::getCity(const std::string& name)
 {
-    return *cities.at(name);
+    auto& city = *cities.at(name);
+    changedCities.emplace(name);
+    revision++;
+
+    return city;
 }
 
 persistence::Note& HistoricalCache::getNote()
 {
+    noteChanged = true;
+    revision++;
+
     return *cache.note;
 }
 
@@ -88,6 +100,8 @@ void HistoricalCache::removeCountry(const std::string& name)
     removed.countries.emplace_back(*countries[name]);
     cache.countries.erase(countries[name]);
     countries.erase(name);
+    changedCountries.erase(name);
+    revision++;
 }
 
 void HistoricalCache::removeCity(const std::string& name)
@@ -95,6 +109,8 @@ void HistoricalCache::removeCity(const std::string& name)
     removed.cities.emplace_back(*cities[name]);
     cache.cities.erase(cities[name]);
     cities.erase(name);
+    changedCities.erase(name);
+    revision++;
 }
 
 bool HistoricalCache::addCountry(const std::string& name)
@@ -110,6 +126,10 @@ bool HistoricalCache::addCountry(const persistence::Country& country)
 
     cache.countries.emplace_back(country);
     countries.emplace(std::make_pair(country.name, --cache.countries.end()));
+    // the country added back replaces the removed one, the removal would delete it again otherwise
+    std::erase_if(removed.countries, [&country](const auto& removedCountry){ return removedCountry.name == country.name; });
+    changedCountries.emplace(country.name);
+    revision++;
 
     return true;
 }
@@ -122,6 +142,9 @@ bool HistoricalCache::addCity(const persistence::City& city)
 
     cache.cities.emplace_back(city);
     cities.emplace(std::make_pair(city.name, --cache.cities.end()));
+    std::erase_if(removed.cities, [&city](const auto& removedCity){ return removedCity.name == city.name; });
+    changedCities.emplace(city.name);
+    revision++;
 
     return true;
 }
@@ -134,6 +157,11 @@ bool HistoricalCache::addNote(const std::string& note)
         cache.note = persistence::Note{note};
     }
 
+    // the new note replaces the old one of the year, it doesn't need to be removed
+    removed.note.reset();
+    noteChanged = true;
+    revision++;
+
     return true;
 }
 
@@ -141,5 +169,41 @@ void HistoricalCache::removeNote()
 {
     removed.note = cache.note;
     cache.note = std::nullopt;
+    noteChanged = false;
+    revision++;
+}
+
+HistoricalCache::Changes HistoricalCache::getChanges() const
+{
+    Changes changes{persistence::Data{cache.year}, removed, revision};
+
+    for (const auto& name : changedCountries) {
+        changes.modified.countries.emplace_back(*countries.at(name));
+    }
+
+    for (const auto& name : changedCities) {
+        changes.modified.cities.emplace_back(*cities.at(name));
+    }
+
+    if (noteChanged) {
+        changes.modified.note = cache.note;
+    }
+
+    return changes;
+}
+
+bool HistoricalCache::markSaved(uint64_t savedRevision) noexcept
+{
+    if (savedRevision != revision) {
+        return false;
+    }
+
+    changedCountries.clear();
+    changedCities.clear();
+    noteChanged = false;
+    removed = persistence::Data{cache.year};
+    modified = false;
+
+    return true;
 }
 }
\ No newline at end of file
@@ -6,13 +6,24 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 #include <mutex>
 #include <vector>
+#include <cstdint>
 
 namespace persistence {
+// The mutable accessors, add* and remove* track the countries, cities and note changed since the
+// year is loaded or last saved, so a save only writes the changes, see getChanges().
 class HistoricalCache {
 public:
+    struct Changes {
+        // the countries, the cities and the note added or modified
+        persistence::Data modified;
+        persistence::Data removed;
+        uint64_t revision = 0;
+    };
+
     HistoricalCache() = default;
     explicit HistoricalCache(const persistence::Data& info);
     explicit HistoricalCache(persistence::Data&& info);
@@ -38,6 +49,10 @@ public:
     persistence::Data getData() const noexcept { return cache; }
     persistence::Data getRemoved() const noexcept { return removed; }
     void clearRemoved() noexcept { removed = persistence::Data{cache.year}; }
+    Changes getChanges() const;
+    // The changes up to the revision are saved, they are not tracked anymore. Returns false and keeps
+    // tracking everything if it has been changed after the revision.
+    bool markSaved(uint64_t savedRevision) noexcept;
 
     void setModificationState(bool isModified) noexcept { modified = isModified; }
     bool isMidified() const noexcept { return modified; }
@@ -47,6 +62,11 @@ private:
     persistence::Data removed;
     std::map<std::string, std::list<persistence::Country>::iterator> countries;
     std::map<std::string, std::list<persistence::City>::iterator> cities;
+    std::set<std::string> changedCountries;
+    std::set<std::string> changedCities;
+    bool noteChanged = false;
+    // increased by every change
+    uint64_t revision = 0;
     // we don't track if it is the same as the database
     // once it is modified, even though it may be modified back to the same 
     // as the counterpart in the database, we still treat it as modified.
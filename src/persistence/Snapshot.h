@@ -0,0 +1,738 @@
+#ifndef SRC_PERSISTENCE_SNAPSHOT_H
+#define SRC_PERSISTENCE_SNAPSHOT_H
+
+#include "src/persistence/ContourCache.h"
+#include "src/persistence/Data.h"
+#include "src/util/Error.h"
+#include "src/util/MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace persistence {
+// A read-only copy of the years of the database in one file. The file is mapped into the memory, a
+// year is viewed in place or loaded as Data without running SQL or decoding a blob. It is tagged with the revision of the database it is written from, the years
+// changed after that revision have to be loaded from the database instead, see
+// Database::getYearRevision().
+// The file is only a cache of the local database, it is written in the byte order of the machine.
+// The years are grouped in sections of SECTION_YEARS years. A section is the header followed by the
+// arrays of its years, countries, cities, contours, points, strings and characters, a contour or a
+// name used by several years of the section is stored once. The sections don't refer to each other,
+// so an unchanged one is copied to a new file as it is. The index of the sections follows them.
+// Everything starts at a multiple of 8 bytes.
+class Snapshot {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr int SECTION_YEARS = 128;
+
+    struct CountryView {
+        std::string_view name;
+        std::span<const Coordinate> border;
+    };
+
+    struct CityView {
+        std::string_view name;
+        Coordinate coordinate;
+    };
+
+    // Refers to the mapped file, it is only valid as long as the snapshot.
+    struct YearView {
+        int year = 0;
+        std::vector<CountryView> countries;
+        std::vector<CityView> cities;
+        std::optional<std::string_view> note;
+    };
+
+    // Returns nullptr if the file doesn't exist, it is written by another version or it is corrupted.
+    static std::unique_ptr<Snapshot> open(const std::filesystem::path& path)
+    {
+        util::MappedFile file{path};
+        if (!file.isMapped()) {
+            return nullptr;
+        }
+
+        std::unique_ptr<Snapshot> snapshot{new Snapshot{std::move(file)}};
+        if (!snapshot->validate()) {
+            return nullptr;
+        }
+
+        return snapshot;
+    }
+
+    class Writer;
+
+    static int sectionOf(int year) noexcept
+    {
+        return year >= 0 ? year / SECTION_YEARS : (year + 1) / SECTION_YEARS - 1;
+    }
+
+    // the first and the last year of a section
+    static std::pair<int, int> yearsOf(int section) noexcept
+    {
+        return {section * SECTION_YEARS, section * SECTION_YEARS + SECTION_YEARS - 1};
+    }
+
+    uint64_t getRevision() const noexcept { return header.revision; }
+
+    // the sections having any year, in ascending order
+    std::vector<int> getSectionList() const
+    {
+        std::vector<int> sections;
+        sections.reserve(header.sectionCount);
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            sections.emplace_back(read<SectionEntry>(header.indexOffset, i).section);
+        }
+
+        return sections;
+    }
+
+    // the years having any country, city or note
+    std::vector<int> getYearList() const
+    {
+        std::vector<int> years;
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            const auto section = getSection(read<SectionEntry>(header.indexOffset, i));
+            for (uint32_t j = 0; j < section.header.yearCount; j++) {
+                years.emplace_back(read<YearEntry>(section.layout.years, j).year);
+            }
+        }
+
+        return years;
+    }
+
+    // A year not in the snapshot is empty. Nothing is copied, the names and the points are in the mapping.
+    YearView load(int year) const
+    {
+        YearView view{year};
+        const auto found = find(year);
+        if (!found) {
+            return view;
+        }
+
+        const auto& [section, yearEntry] = *found;
+        view.countries.reserve(yearEntry.countryCount);
+        for (uint32_t i = 0; i < yearEntry.countryCount; i++) {
+            const auto country = read<CountryEntry>(section.layout.countries, yearEntry.firstCountry + i);
+            view.countries.emplace_back(CountryView{getString(section, country.name), getPoints(section, country.contour)});
+        }
+
+        view.cities.reserve(yearEntry.cityCount);
+        for (uint32_t i = 0; i < yearEntry.cityCount; i++) {
+            const auto city = read<CityEntry>(section.layout.cities, yearEntry.firstCity + i);
+            view.cities.emplace_back(CityView{getString(section, city.name), Coordinate{city.latitude, city.longitude}});
+        }
+
+        if (yearEntry.note != NO_NOTE) {
+            view.note = getString(section, yearEntry.note);
+        }
+
+        return view;
+    }
+
+    // Data owns its names and points, they can't stay in the mapping. The names are copied, the points
+    // of a contour are copied once and shared by the years using it as long as it is cached, the same
+    // as the borders decoded from the database.
+    Data loadData(int year) const
+    {
+        Data data{year};
+        const auto found = find(year);
+        if (!found) {
+            return data;
+        }
+
+        const auto& [section, yearEntry] = *found;
+        for (uint32_t i = 0; i < yearEntry.countryCount; i++) {
+            const auto country = read<CountryEntry>(section.layout.countries, yearEntry.firstCountry + i);
+            data.countries.emplace_back(std::string{getString(section, country.name)}, Contour{sharePoints(section, country.contour)});
+        }
+
+        for (uint32_t i = 0; i < yearEntry.cityCount; i++) {
+            const auto city = read<CityEntry>(section.layout.cities, yearEntry.firstCity + i);
+            data.cities.emplace_back(std::string{getString(section, city.name)}, Coordinate{city.latitude, city.longitude});
+        }
+
+        if (yearEntry.note != NO_NOTE) {
+            data.note = Note{std::string{getString(section, yearEntry.note)}};
+        }
+
+        return data;
+    }
+
+    ContourCache::Statistics getContourCacheStatistics() const { return contours.getStatistics(); }
+
+private:
+    static constexpr std::array<char, 8> MAGIC{'H', 'M', 'S', 'N', 'A', 'P', 'S', 'H'};
+    static constexpr uint32_t NO_NOTE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t ALIGNMENT = 8;
+
+    struct Header {
+        std::array<char, 8> magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t sectionCount = 0;
+        uint64_t revision = 0;
+        uint64_t indexOffset = 0;
+    };
+
+    struct SectionEntry {
+        int32_t section;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct SectionHeader {
+        uint32_t yearCount = 0;
+        uint32_t countryCount = 0;
+        uint32_t cityCount = 0;
+        uint32_t contourCount = 0;
+        uint32_t stringCount = 0;
+        uint32_t reserved = 0;
+        uint64_t pointCount = 0;
+        uint64_t characterCount = 0;
+    };
+
+    // the entries of a year are contiguous in the arrays of the countries and cities
+    struct YearEntry {
+        int32_t year;
+        uint32_t firstCountry;
+        uint32_t countryCount;
+        uint32_t firstCity;
+        uint32_t cityCount;
+        // index of the string or NO_NOTE
+        uint32_t note;
+    };
+
+    struct CountryEntry {
+        uint32_t name;
+        uint32_t contour;
+    };
+
+    struct CityEntry {
+        uint32_t name;
+        float latitude;
+        float longitude;
+    };
+
+    struct ContourEntry {
+        uint64_t firstPoint;
+        uint64_t pointCount;
+    };
+
+    struct StringEntry {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // the points are viewed in the mapping as they are
+    static_assert(std::is_trivially_copyable_v<Coordinate> && std::is_standard_layout_v<Coordinate> &&
+                  sizeof(Coordinate) == 2 * sizeof(float) && ALIGNMENT % alignof(Coordinate) == 0);
+
+    // where each array of a section starts, computed from the counts in its header
+    struct Layout {
+        size_t years = 0;
+        size_t countries = 0;
+        size_t cities = 0;
+        size_t contours = 0;
+        size_t points = 0;
+        size_t strings = 0;
+        size_t characters = 0;
+        size_t end = 0;
+
+        // start is a multiple of ALIGNMENT
+        static Layout of(const SectionHeader& header, size_t start)
+        {
+            const auto next = [](size_t offset, uint64_t count, size_t size){
+                return align(offset + static_cast<size_t>(count) * size);
+            };
+
+            Layout layout;
+            layout.years = next(start, 1, sizeof(SectionHeader));
+            layout.countries = next(layout.years, header.yearCount, sizeof(YearEntry));
+            layout.cities = next(layout.countries, header.countryCount, sizeof(CountryEntry));
+            layout.contours = next(layout.cities, header.cityCount, sizeof(CityEntry));
+            layout.points = next(layout.contours, header.contourCount, sizeof(ContourEntry));
+            layout.strings = next(layout.points, header.pointCount, sizeof(Coordinate));
+            layout.characters = next(layout.strings, header.stringCount, sizeof(StringEntry));
+            layout.end = layout.characters + static_cast<size_t>(header.characterCount);
+            return layout;
+        }
+    };
+
+    struct Section {
+        int section;
+        SectionHeader header;
+        Layout layout;
+    };
+
+    util::MappedFile file;
+    std::span<const std::byte> bytes;
+    Header header;
+    // keyed by the section and the index of the contour in it
+    mutable ContourCache contours;
+
+    explicit Snapshot(util::MappedFile&& mappedFile):
+        file{std::move(mappedFile)},
+        bytes{file.getBytes()}
+    {
+    }
+
+    static size_t align(size_t offset) noexcept
+    {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // The entries are copied out instead of being accessed in place, they are small and it needs
+    // no alignment guarantee.
+    template<typename Entry>
+    Entry read(size_t offset, size_t idx) const
+    {
+        Entry entry;
+        std::memcpy(&entry, bytes.data() + offset + idx * sizeof(Entry), sizeof(Entry));
+        return entry;
+    }
+
+    Section getSection(const SectionEntry& entry) const
+    {
+        const auto sectionHeader = read<SectionHeader>(entry.offset, 0);
+        return {entry.section, sectionHeader, Layout::of(sectionHeader, entry.offset)};
+    }
+
+    // Everything an entry refers to is checked once here so a load doesn't check the bounds.
+    bool validate()
+    {
+        // the mapping starts at a page, so the arrays starting at a multiple of ALIGNMENT are aligned
+        if (bytes.size() < sizeof(Header) || reinterpret_cast<uintptr_t>(bytes.data()) % ALIGNMENT != 0) {
+            return false;
+        }
+
+        header = read<Header>(0, 0);
+        if (header.magic != MAGIC || header.version != VERSION || header.indexOffset > bytes.size() ||
+            header.indexOffset % ALIGNMENT != 0 || header.sectionCount > bytes.size() / sizeof(SectionEntry) ||
+            header.indexOffset + header.sectionCount * sizeof(SectionEntry) != bytes.size()) {
+            return false;
+        }
+
+        size_t end = align(sizeof(Header));
+        for (uint32_t i = 0; i < header.sectionCount; i++) {
+            const auto entry = read<SectionEntry>(header.indexOffset, i);
+            if ((i > 0 && read<SectionEntry>(header.indexOffset, i - 1).section >= entry.section) ||
+                entry.offset < end || entry.offset % ALIGNMENT != 0 ||
+                entry.offset > header.indexOffset || entry.size > header.indexOffset - entry.offset ||
+                !validate(entry)) {
+                return false;
+            }
+
+            end = entry.offset + entry.size;
+        }
+
+        return true;
+    }
+
+    bool validate(const SectionEntry& entry) const
+    {
+        if (entry.size < sizeof(SectionHeader)) {
+            return false;
+        }
+
+        const auto sectionHeader = read<SectionHeader>(entry.offset, 0);
+        // the counts are checked against the size before the layout is computed so it can't overflow
+        if (sectionHeader.pointCount > entry.size || sectionHeader.characterCount > entry.size) {
+            return false;
+        }
+
+        const auto section = Section{entry.section, sectionHeader, Layout::of(sectionHeader, entry.offset)};
+        if (section.layout.end != entry.offset + entry.size) {
+            return false;
+        }
+
+        const auto [firstYear, lastYear] = yearsOf(entry.section);
+        for (uint32_t i = 0; i < sectionHeader.yearCount; i++) {
+            const auto year = read<YearEntry>(section.layout.years, i);
+            if ((i > 0 && read<YearEntry>(section.layout.years, i - 1).year >= year.year) ||
+                year.year < firstYear || year.year > lastYear ||
+                static_cast<uint64_t>(year.firstCountry) + year.countryCount > sectionHeader.countryCount ||
+                static_cast<uint64_t>(year.firstCity) + year.cityCount > sectionHeader.cityCount ||
+                (year.note != NO_NOTE && year.note >= sectionHeader.stringCount)) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < sectionHeader.countryCount; i++) {
+            const auto country = read<CountryEntry>(section.layout.countries, i);
+            if (country.name >= sectionHeader.stringCount || country.contour >= sectionHeader.contourCount) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < sectionHeader.cityCount; i++) {
+            if (read<CityEntry>(section.layout.cities, i).name >= sectionHeader.stringCount) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < sectionHeader.contourCount; i++) {
+            const auto contour = read<ContourEntry>(section.layout.contours, i);
+            if (contour.firstPoint > sectionHeader.pointCount || contour.pointCount > sectionHeader.pointCount - contour.firstPoint) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < sectionHeader.stringCount; i++) {
+            const auto string = read<StringEntry>(section.layout.strings, i);
+            if (string.offset > sectionHeader.characterCount || string.size > sectionHeader.characterCount - string.offset) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // binary search in the sorted index
+    std::optional<SectionEntry> findSection(int section) const
+    {
+        uint32_t low = 0;
+        uint32_t high = header.sectionCount;
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            if (read<SectionEntry>(header.indexOffset, middle).section < section) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        if (low < header.sectionCount) {
+            if (const auto entry = read<SectionEntry>(header.indexOffset, low); entry.section == section) {
+                return entry;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // binary search in the sorted years of the section
+    std::optional<YearEntry> findYear(const Section& section, int year) const
+    {
+        uint32_t low = 0;
+        uint32_t high = section.header.yearCount;
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            if (read<YearEntry>(section.layout.years, middle).year < year) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        if (low < section.header.yearCount) {
+            if (const auto entry = read<YearEntry>(section.layout.years, low); entry.year == year) {
+                return entry;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::pair<Section, YearEntry>> find(int year) const
+    {
+        const auto entry = findSection(sectionOf(year));
+        if (!entry) {
+            return std::nullopt;
+        }
+
+        const auto section = getSection(*entry);
+        if (const auto yearEntry = findYear(section, year); yearEntry) {
+            return std::make_pair(section, *yearEntry);
+        }
+
+        return std::nullopt;
+    }
+
+    std::string_view getString(const Section& section, uint32_t idx) const
+    {
+        const auto string = read<StringEntry>(section.layout.strings, idx);
+        return {reinterpret_cast<const char*>(bytes.data() + section.layout.characters + string.offset), static_cast<size_t>(string.size)};
+    }
+
+    std::span<const Coordinate> getPoints(const Section& section, uint32_t idx) const
+    {
+        const auto contour = read<ContourEntry>(section.layout.contours, idx);
+        const auto points = reinterpret_cast<const Coordinate*>(bytes.data() + section.layout.points);
+        return {points + contour.firstPoint, static_cast<size_t>(contour.pointCount)};
+    }
+
+    std::shared_ptr<const Contour::Points> sharePoints(const Section& section, uint32_t idx) const
+    {
+        const auto id = static_cast<uint64_t>(static_cast<uint32_t>(section.section)) << 32 | idx;
+        if (auto points = contours.find(id); points) {
+            return points;
+        }
+
+        const auto view = getPoints(section, idx);
+        auto points = std::make_shared<const Contour::Points>(view.begin(), view.end());
+        contours.insert(id, points);
+        return points;
+    }
+};
+
+// Writes a snapshot one section at a time, only the entries of the section being written are kept
+// in the memory. The years and the copied sections have to be given in ascending order.
+class Snapshot::Writer {
+public:
+    // The file is written next to path and renamed to it by finish(), a reader never sees a partial file.
+    Writer(const std::filesystem::path& path, uint64_t revision):
+        path{path},
+        temporary{path}
+    {
+        temporary += ".tmp";
+        stream.open(temporary, std::ios::binary | std::ios::trunc);
+
+        header.revision = revision;
+        // written again by finish() once the index is known
+        append(&header, sizeof(header));
+    }
+
+    ~Writer()
+    {
+        if (stream.is_open()) {
+            stream.close();
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    void add(const Data& data)
+    {
+        // an empty year is the same as a missing one
+        if (data.countries.empty() && data.cities.empty() && !data.note) {
+            return;
+        }
+
+        const auto section = sectionOf(data.year);
+        if (current && current->section != section) {
+            flush();
+        }
+
+        if (!current) {
+            current.emplace(section);
+        }
+
+        current->add(data);
+    }
+
+    // The bytes of the section are copied from the file of the snapshot, nothing is decoded.
+    void copy(const Snapshot& snapshot, int section)
+    {
+        flush();
+
+        if (const auto entry = snapshot.findSection(section); entry) {
+            appendSection(section, [this, &snapshot, &entry](){
+                append(snapshot.bytes.data() + entry->offset, static_cast<size_t>(entry->size));
+            });
+        }
+    }
+
+    util::Expected<void> finish()
+    {
+        flush();
+
+        pad(align(written) - written);
+        header.sectionCount = static_cast<uint32_t>(index.size());
+        header.indexOffset = written;
+        append(index.data(), index.size() * sizeof(SectionEntry));
+
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.close();
+
+        std::error_code error;
+        if (stream.fail()) {
+            std::filesystem::remove(temporary, error);
+            return util::Unexpected{util::Error{util::ErrorCode::FILE_WRITE_ERROR, "Failed to write " + temporary.string()}};
+        }
+
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            return util::Unexpected{util::Error{util::ErrorCode::FILE_WRITE_ERROR, "Failed to replace " + path.string()}};
+        }
+
+        return util::SUCCESS;
+    }
+
+private:
+    // the entries of the years of one section
+    struct SectionBuilder {
+        int section;
+        std::vector<YearEntry> years;
+        std::vector<CountryEntry> countries;
+        std::vector<CityEntry> cities;
+        // the contours are kept alive so the addresses of their points are not reused by others
+        std::vector<std::shared_ptr<const Contour::Points>> contours;
+        std::unordered_map<const Contour::Points*, uint32_t> contourIndex;
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint32_t> stringIndex;
+
+        explicit SectionBuilder(int section):
+            section{section}
+        {
+        }
+
+        void add(const Data& data)
+        {
+            YearEntry year{
+                .year = data.year,
+                .firstCountry = static_cast<uint32_t>(countries.size()),
+                .countryCount = static_cast<uint32_t>(data.countries.size()),
+                .firstCity = static_cast<uint32_t>(cities.size()),
+                .cityCount = static_cast<uint32_t>(data.cities.size()),
+                .note = data.note ? addString(data.note->text) : NO_NOTE,
+            };
+
+            for (const auto& country : data.countries) {
+                countries.emplace_back(CountryEntry{addString(country.name), addContour(country.borderContour)});
+            }
+
+            for (const auto& city : data.cities) {
+                cities.emplace_back(CityEntry{addString(city.name), city.coordinate.latitude, city.coordinate.longitude});
+            }
+
+            years.emplace_back(year);
+        }
+
+        uint32_t addContour(const Contour& contour)
+        {
+            // the contours loaded from the same border share their points
+            auto points = contour.share();
+            if (!points) {
+                points = std::make_shared<const Contour::Points>();
+            }
+
+            if (const auto it = contourIndex.find(points.get()); it != contourIndex.end()) {
+                return it->second;
+            }
+
+            const auto idx = static_cast<uint32_t>(contours.size());
+            contourIndex.emplace(points.get(), idx);
+            contours.emplace_back(std::move(points));
+            return idx;
+        }
+
+        uint32_t addString(const std::string& string)
+        {
+            const auto [it, inserted] = stringIndex.emplace(string, static_cast<uint32_t>(strings.size()));
+            if (inserted) {
+                strings.emplace_back(string);
+            }
+
+            return it->second;
+        }
+    };
+
+    std::filesystem::path path;
+    std::filesystem::path temporary;
+    std::ofstream stream;
+    size_t written = 0;
+    Header header;
+    std::vector<SectionEntry> index;
+    std::optional<SectionBuilder> current;
+
+    void append(const void* data, size_t size)
+    {
+        stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written += size;
+    }
+
+    // the gaps are shorter than the alignment
+    void pad(size_t size)
+    {
+        static constexpr std::array<char, ALIGNMENT> PADDING{};
+        append(PADDING.data(), size);
+    }
+
+    template<typename Func>
+    void appendSection(int section, Func&& appendBytes)
+    {
+        pad(align(written) - written);
+        const auto offset = written;
+        appendBytes();
+        index.emplace_back(SectionEntry{section, 0, offset, written - offset});
+    }
+
+    // write the section being built
+    void flush()
+    {
+        if (!current) {
+            return;
+        }
+
+        SectionHeader sectionHeader{
+            .yearCount = static_cast<uint32_t>(current->years.size()),
+            .countryCount = static_cast<uint32_t>(current->countries.size()),
+            .cityCount = static_cast<uint32_t>(current->cities.size()),
+            .contourCount = static_cast<uint32_t>(current->contours.size()),
+            .stringCount = static_cast<uint32_t>(current->strings.size()),
+        };
+
+        std::vector<ContourEntry> contourEntries;
+        contourEntries.reserve(current->contours.size());
+        for (const auto& points : current->contours) {
+            contourEntries.emplace_back(ContourEntry{sectionHeader.pointCount, points->size()});
+            sectionHeader.pointCount += points->size();
+        }
+
+        std::vector<StringEntry> stringEntries;
+        stringEntries.reserve(current->strings.size());
+        for (const auto& string : current->strings) {
+            stringEntries.emplace_back(StringEntry{sectionHeader.characterCount, string.size()});
+            sectionHeader.characterCount += string.size();
+        }
+
+        appendSection(current->section, [this, &sectionHeader, &contourEntries, &stringEntries](){
+            const auto layout = Layout::of(sectionHeader, written);
+            // each array starts at its offset in the layout, the gap before it is padded by zeros
+            const auto appendAt = [this](size_t offset, const void* data, size_t size){
+                pad(offset - written);
+                append(data, size);
+            };
+
+            appendAt(written, &sectionHeader, sizeof(sectionHeader));
+            appendAt(layout.years, current->years.data(), current->years.size() * sizeof(YearEntry));
+            appendAt(layout.countries, current->countries.data(), current->countries.size() * sizeof(CountryEntry));
+            appendAt(layout.cities, current->cities.data(), current->cities.size() * sizeof(CityEntry));
+            appendAt(layout.contours, contourEntries.data(), contourEntries.size() * sizeof(ContourEntry));
+            appendAt(layout.points, nullptr, 0);
+            for (const auto& points : current->contours) {
+                append(points->data(), points->size() * sizeof(Coordinate));
+            }
+            appendAt(layout.strings, stringEntries.data(), stringEntries.size() * sizeof(StringEntry));
+            appendAt(layout.characters, nullptr, 0);
+            for (const auto& string : current->strings) {
+                append(string.data(), string.size());
+            }
+        });
+
+        current.reset();
+    }
+};
+}
+
+#endif
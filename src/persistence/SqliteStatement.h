@@ -0,0 +1,137 @@
+#ifndef SRC_PERSISTENCE_SQLITE_STATEMENT_H
+#define SRC_PERSISTENCE_SQLITE_STATEMENT_H
+
+#include "sqlpp11/exception.h"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace persistence {
+// A thin wrapper of a sqlite3 statement, it is used for the SQLite specific
+// statements which can't be expressed by sqlpp11, such as pragmas. Errors are
+// reported by throwing sqlpp::exception like the sqlpp11 connector does.
+class SqliteStatement {
+public:
+    SqliteStatement(sqlite3* db, std::string_view sql):
+        db{db}
+    {
+        if (sqlite3_prepare_v2(db, sql.data(), static_cast<int>(sql.size()), &statement, nullptr) != SQLITE_OK) {
+            throw sqlpp::exception{"Failed to prepare \"" + std::string{sql} + "\", error: " + sqlite3_errmsg(db)};
+        }
+    }
+
+    ~SqliteStatement()
+    {
+        sqlite3_finalize(statement);
+    }
+
+    SqliteStatement(const SqliteStatement&) = delete;
+    SqliteStatement& operator=(const SqliteStatement&) = delete;
+
+    SqliteStatement(SqliteStatement&& other) noexcept:
+        db{other.db},
+        statement{std::exchange(other.statement, nullptr)}
+    {
+    }
+
+    SqliteStatement& operator=(SqliteStatement&& other) noexcept
+    {
+        if (this != &other) {
+            sqlite3_finalize(statement);
+            db = other.db;
+            statement = std::exchange(other.statement, nullptr);
+        }
+
+        return *this;
+    }
+
+    // the index of the parameters starts from 1
+    SqliteStatement& bindInt(int index, int64_t value)
+    {
+        check(sqlite3_bind_int64(statement, index, value));
+        return *this;
+    }
+
+    SqliteStatement& bindDouble(int index, double value)
+    {
+        check(sqlite3_bind_double(statement, index, value));
+        return *this;
+    }
+
+    SqliteStatement& bindText(int index, std::string_view value)
+    {
+        check(sqlite3_bind_text(statement, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT));
+        return *this;
+    }
+
+    SqliteStatement& bindBlob(int index, std::span<const uint8_t> value)
+    {
+        check(sqlite3_bind_blob(statement, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT));
+        return *this;
+    }
+
+    // returns true if a row is available
+    bool step()
+    {
+        switch (sqlite3_step(statement)) {
+        case SQLITE_ROW:
+            return true;
+        case SQLITE_DONE:
+            return false;
+        default:
+            throw sqlpp::exception{std::string{"Failed to step \""} + sqlite3_sql(statement) + "\", error: " + sqlite3_errmsg(db)};
+        }
+    }
+
+    // run the statement to the end and make it ready for the next execution
+    void execute()
+    {
+        while (step()) {
+        }
+
+        reset();
+    }
+
+    void reset()
+    {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+    }
+
+    // the index of the columns starts from 0
+    bool isNull(int column) const { return sqlite3_column_type(statement, column) == SQLITE_NULL; }
+    int64_t getInt(int column) const { return sqlite3_column_int64(statement, column); }
+    double getDouble(int column) const { return sqlite3_column_double(statement, column); }
+
+    std::string getText(int column) const
+    {
+        const auto text = reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+        return text ? std::string{text, static_cast<size_t>(sqlite3_column_bytes(statement, column))} : std::string{};
+    }
+
+    // the span is valid until the next step or reset
+    std::span<const uint8_t> getBlob(int column) const
+    {
+        const auto blob = reinterpret_cast<const uint8_t*>(sqlite3_column_blob(statement, column));
+        return {blob, static_cast<size_t>(sqlite3_column_bytes(statement, column))};
+    }
+
+private:
+    sqlite3* db = nullptr;
+    sqlite3_stmt* statement = nullptr;
+
+    void check(int code)
+    {
+        if (code != SQLITE_OK) {
+            throw sqlpp::exception{std::string{"Failed to bind parameter of \""} + sqlite3_sql(statement) + "\", error: " + sqlite3_errmsg(db)};
+        }
+    }
+};
+}
+
+#endif
@@ -33,7 +33,7 @@ CREATE TABLE IF NOT EXISTS yearNotes (
 
 CREATE TABLE IF NOT EXISTS notes (
     id INTEGER PRIMARY KEY,
-    hash INTEGER NOT NULL UNIQUE,
+    hash BLOB NOT NULL UNIQUE,
     text TEXT NOT NULL
 );
 
@@ -49,7 +49,21 @@ CREATE TABLE IF NOT EXISTS countries (
 
 CREATE TABLE IF NOT EXISTS borders (
     id INTEGER PRIMARY KEY,
-    hash INTEGER NOT NULL UNIQUE,
+    hash BLOB NOT NULL UNIQUE,
     contour blob NOT NULL,
     CHECK ((hash IS NULL AND contour IS NULL) OR (hash IS NOT NULL AND contour IS NOT NULL))
-);
\ No newline at end of file
+);
+
+-- Indexes of the relationship tables, the lookups by year are covered by the index
+-- so loading a year doesn't need to touch the relationship table itself.
+CREATE INDEX IF NOT EXISTS yearCountriesYearIndex ON yearCountries (year_id, country_id, border_id);
+
+CREATE INDEX IF NOT EXISTS yearCountriesCountryIndex ON yearCountries (country_id, year_id);
+
+CREATE INDEX IF NOT EXISTS yearCountriesBorderIndex ON yearCountries (border_id);
+
+CREATE INDEX IF NOT EXISTS yearCitiesYearIndex ON yearCities (year_id, city_id);
+
+CREATE INDEX IF NOT EXISTS yearCitiesCityIndex ON yearCities (city_id);
+
+CREATE INDEX IF NOT EXISTS yearNotesNoteIndex ON yearNotes (note_id);
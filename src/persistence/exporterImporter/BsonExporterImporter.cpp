@@ -1,9 +1,24 @@
 #include "src/persistence/exporterImporter/BsonExporterImporter.h"
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
-#include <iterator>
+#include <optional>
 
 namespace persistence {
+constexpr char BSON_END = 0x00;
+constexpr char BSON_DOUBLE = 0x01;
+constexpr char BSON_STRING = 0x02;
+constexpr char BSON_DOCUMENT = 0x03;
+constexpr char BSON_ARRAY = 0x04;
+constexpr char BSON_BINARY = 0x05;
+constexpr char BSON_BOOLEAN = 0x08;
+constexpr char BSON_NULL = 0x0A;
+constexpr char BSON_INT32 = 0x10;
+constexpr char BSON_UINT64 = 0x11;
+constexpr char BSON_INT64 = 0x12;
+constexpr std::uint32_t BSON_MIN_DOCUMENT_SIZE = 5;
+
 void BsonExporter::toStream(std::fstream stream, const nlohmann::json& json)
 {
     std::vector<std::uint8_t> binary = nlohmann::json::to_bson(json);
@@ -31,10 +46,112 @@ util::Expected<std::fstream> BsonImporter::openFile(const std::string& file)
     return std::fstream{file, std::ios::in | std::ios::binary};
 }
 
-nlohmann::json BsonImporter::parse(std::fstream stream)
+util::Expected<void> BsonImporter::split(std::fstream& stream, const std::function<bool(std::string&&)>& onYear)
 {
-    std::vector<uint8_t> binary{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    const auto readSize = [&stream]() -> std::optional<std::uint32_t> {
+        std::array<unsigned char, sizeof(std::uint32_t)> bytes;
+        if (!stream.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) {
+            return std::nullopt;
+        }
+
+        // little endian
+        return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+    };
+
+    const auto readElement = [&stream](char& type, std::string& name) {
+        return stream.get(type) && (type == BSON_END || std::getline(stream, name, '\0'));
+    };
+
+    const auto skip = [&stream, &readSize](char type) -> bool {
+        switch (type) {
+        case BSON_DOUBLE:
+        case BSON_INT64:
+        case BSON_UINT64:
+            return static_cast<bool>(stream.ignore(8));
+        case BSON_INT32:
+            return static_cast<bool>(stream.ignore(4));
+        case BSON_BOOLEAN:
+            return static_cast<bool>(stream.ignore(1));
+        case BSON_NULL:
+            return true;
+        case BSON_STRING:
+            if (const auto size = readSize(); size) {
+                return static_cast<bool>(stream.ignore(*size));
+            }
+            return false;
+        case BSON_BINARY:
+            if (const auto size = readSize(); size) {
+                return static_cast<bool>(stream.ignore(*size + 1));     // the subtype
+            }
+            return false;
+        case BSON_DOCUMENT:
+        case BSON_ARRAY:
+            if (const auto size = readSize(); size && *size >= BSON_MIN_DOCUMENT_SIZE) {
+                return static_cast<bool>(stream.ignore(*size - sizeof(std::uint32_t)));
+            }
+            return false;
+        default:
+            return false;
+        }
+    };
+
+    const auto error = [](const std::string& msg) {
+        return util::Unexpected{util::Error{util::ErrorCode::PARSE_FILE_ERROR, msg}};
+    };
+
+    if (!readSize()) {
+        return error("unexpected end of input");
+    }
+
+    char type;
+    std::string name;
+    while (readElement(type, name) && type != BSON_END) {
+        if (type != BSON_ARRAY || name != JSON_FIRST_LEVEL_NAME) {
+            if (!skip(type)) {
+                return error("unexpected element " + name);
+            }
+            continue;
+        }
+
+        if (!readSize()) {
+            return error("unexpected end of input");
+        }
+
+        // every element of historical_info is a document which is decoded on its own
+        while (readElement(type, name) && type != BSON_END) {
+            const auto size = readSize();
+            if (type != BSON_DOCUMENT || !size || *size < BSON_MIN_DOCUMENT_SIZE) {
+                return error("unexpected element " + name + " in " + JSON_FIRST_LEVEL_NAME);
+            }
+
+            std::string bytes(*size, '\0');
+            for (size_t i = 0; i < sizeof(std::uint32_t); i++) {
+                bytes[i] = static_cast<char>(*size >> (8 * i));
+            }
 
-    return nlohmann::json::from_bson(binary);
+            if (!stream.read(bytes.data() + sizeof(std::uint32_t), *size - sizeof(std::uint32_t))) {
+                return error("unexpected end of input");
+            }
+
+            if (!onYear(std::move(bytes))) {
+                return util::SUCCESS;
+            }
+        }
+
+        if (!stream) {
+            return error("unexpected end of input");
+        }
+    }
+
+    if (!stream) {
+        return error("unexpected end of input");
+    }
+
+    return util::SUCCESS;
+}
+
+nlohmann::json BsonImporter::decode(const std::string& bytes)
+{
+    return nlohmann::json::from_bson(bytes);
+}
 }
-}
\ No newline at end of file
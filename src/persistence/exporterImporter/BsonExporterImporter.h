@@ -17,8 +17,9 @@ private:
 
 class BsonImporter: public JsonImporter {
 private:
-    virtual nlohmann::json parse(std::fstream stream) override;
     virtual util::Expected<std::fstream> openFile(const std::string& file) override;
+    virtual util::Expected<void> split(std::fstream& stream, const std::function<bool(std::string&&)>& onYear) override;
+    virtual nlohmann::json decode(const std::string& bytes) override;
 };
 }
 
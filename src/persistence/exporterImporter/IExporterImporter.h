@@ -24,8 +24,9 @@ public:
     virtual ~IImporter() = default;
 
     // It must taken a copy of the path since it returns a coroutine generator, 
-    // if passing a temperatory object, it might be destroyed before using
-    virtual util::Generator<util::Expected<Data>> loadFromFile(const std::string file) = 0;
+    // if passing a temperatory object, it might be destroyed before using.
+    // The years are yielded in the order of the file if ordered, otherwise as soon as they are loaded
+    virtual util::Generator<util::Expected<Data>> loadFromFile(const std::string file, bool ordered) = 0;
 };
 }
 
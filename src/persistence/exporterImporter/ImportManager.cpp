@@ -19,7 +19,7 @@ ImportManager::doImport(const std::string& file)
                 const auto format = std::filesystem::u8path(file).extension().string().substr(PERIOD_INDEX);
                 if (auto ret = ExporterImporterFactory::getInstance().createImporter(format); ret) {
                     auto importer = std::move(ret.value());
-                    auto loader = importer->loadFromFile(file);
+                    auto loader = importer->loadFromFile(file, false);
 
                     while (loader.next()) {
                         if (const auto& ret = loader.getValue(); ret) {
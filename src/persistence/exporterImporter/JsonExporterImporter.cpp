@@ -2,11 +2,20 @@
 #define SRC_PERSISTENCE_EXPORTER_IMPORTER_JSON_EXPORTER_IMPORTER_CPP
 #include "src/persistence/exporterImporter/JsonExporterImporter.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace persistence {
 constexpr auto PRETTIFY_JSON = 4;
-constexpr auto JSON_FIRST_LEVEL_NAME = "historical_info";
+constexpr size_t SPLIT_CHUNK_SIZE = 1 << 16;
 
 void to_json(nlohmann::json& j, const Coordinate& c) {
     j = nlohmann::json{{"latitude", c.latitude}, {"longitude", c.longitude}};
@@ -17,6 +26,14 @@ void from_json(const nlohmann::json& j, Coordinate& c) {
     j.at("longitude").get_to(c.longitude);
 }
 
+void to_json(nlohmann::json& j, const Contour& c) {
+    j = c.getPoints();
+}
+
+void from_json(const nlohmann::json& j, Contour& c) {
+    c = Contour{j.get<Contour::Points>()};
+}
+
 void to_json(nlohmann::json& j, const Country& c) {
     j = nlohmann::json{{"name", c.name}, {"contour", c.borderContour}};
 }
@@ -99,26 +116,347 @@ util::Expected<std::fstream> JsonExporter::openFile(const std::string& file, boo
     return std::fstream{file, std::ios::out | std::ios::trunc};
 }
 
-util::Generator<util::Expected<Data>> JsonImporter::loadFromFile(const std::string file)
-{
-    if (auto&& ret = openFile(file); ret) {
-        std::optional<util::Error> error;
-        try {
-            const auto json = parse(std::move(ret).value());
+namespace {
+// Decodes the years split out of the file on a pool of workers. The splitter waits once the years
+// not yet delivered fill the window, so only that many years are in memory at any time.
+class DecodePipeline {
+public:
+    using Split = std::function<void(DecodePipeline&)>;
+    using Decode = std::function<util::Expected<Data>(const std::string&)>;
+
+    DecodePipeline(Split split, Decode decode, bool ordered):
+        decode{std::move(decode)},
+        ordered{ordered},
+        window{WINDOW_PER_WORKER * NUM_OF_WORKERS}
+    {
+        for (auto i = 0u; i < NUM_OF_WORKERS; i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+
+        splitter = std::thread{[this, split = std::move(split)]() {
+            split(*this);
+
+            std::scoped_lock lk{lock};
+            finished = true;
+            changed.notify_all();
+        }};
+    }
+
+    ~DecodePipeline()
+    {
+        {
+            std::scoped_lock lk{lock};
+            stopped = true;
+            changed.notify_all();
+        }
+
+        splitter.join();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // returns false once the pipeline is stopped
+    bool push(std::string&& bytes)
+    {
+        std::unique_lock lk{lock};
+        changed.wait(lk, [this]() { return pushed - delivered < window || stopped; });
+
+        if (stopped) {
+            return false;
+        }
+
+        jobs.emplace_back(pushed++, std::move(bytes));
+        changed.notify_all();
+        return true;
+    }
+
+    // delivered after all the years split before it, in both modes
+    void fail(const util::Error& error)
+    {
+        std::scoped_lock lk{lock};
+        failure = error;
+        changed.notify_all();
+    }
+
+    std::optional<util::Expected<Data>> pop()
+    {
+        std::unique_lock lk{lock};
+        changed.wait(lk, [this]() { 
+            return (ordered ? results.contains(delivered) : !results.empty()) || (finished && delivered == pushed);
+        });
+
+        if (results.empty()) {
+            if (failure) {
+                return util::Unexpected{*std::exchange(failure, std::nullopt)};
+            }
+
+            return std::nullopt;
+        }
 
-            for (const auto& info : json[JSON_FIRST_LEVEL_NAME]) {
-                co_yield info.template get<Data>();
+        auto node = results.extract(ordered ? results.find(delivered) : results.begin());
+        delivered++;
+        changed.notify_all();
+        return std::move(node.mapped());
+    }
+
+private:
+    static constexpr size_t WINDOW_PER_WORKER = 2;
+    static inline const unsigned NUM_OF_WORKERS = std::max(1u, std::thread::hardware_concurrency());
+
+    Decode decode;
+    const bool ordered;
+    const size_t window;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::pair<size_t, std::string>> jobs;
+    std::map<size_t, util::Expected<Data>> results;
+    std::optional<util::Error> failure;
+    size_t pushed = 0;
+    size_t delivered = 0;
+    bool finished = false;
+    bool stopped = false;
+
+    std::thread splitter;
+    std::vector<std::thread> workers;
+
+    void work()
+    {
+        std::unique_lock lk{lock};
+
+        while (true) {
+            changed.wait(lk, [this]() { return !jobs.empty() || finished || stopped; });
+
+            if (stopped || jobs.empty()) {
+                return;
             }
+
+            auto [index, bytes] = std::move(jobs.front());
+            jobs.pop_front();
+
+            lk.unlock();
+            auto info = decode(bytes);
+            lk.lock();
+
+            results.emplace(index, std::move(info));
+            changed.notify_all();
         }
-        catch (const nlohmann::json::exception& e) {
-            error = {util::ErrorCode::PARSE_FILE_ERROR, e.what()};
+    }
+};
+
+// Reads the file in chunks for the parser, the bytes consumed while a year is captured are copied
+// out as they are.
+class FileReader {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        Iterator() = default;
+        explicit Iterator(FileReader* reader): reader{reader} {}
+
+        reference operator*() const { return reader->current(); }
+        Iterator& operator++() { reader->advance(); return *this; }
+        Iterator operator++(int) { auto it = *this; reader->advance(); return it; }
+        bool operator==(const Iterator& other) const noexcept { return atEnd() == other.atEnd(); }
+
+    private:
+        FileReader* reader = nullptr;
+
+        bool atEnd() const noexcept { return reader == nullptr || reader->atEnd(); }
+    };
+
+    explicit FileReader(std::istream& stream):
+        stream{stream},
+        buffer(SPLIT_CHUNK_SIZE)
+    {
+        fill();
+    }
+
+    // the first byte is already consumed when the parser reports the start of a year
+    void startCapture(char first) { capture.emplace(1, first); }
+
+    std::string stopCapture()
+    {
+        auto bytes = std::move(capture).value();
+        capture.reset();
+        return bytes;
+    }
+
+private:
+    std::istream& stream;
+    std::vector<char> buffer;
+    size_t size = 0;
+    size_t position = 0;
+    std::optional<std::string> capture;
+
+    bool atEnd() const noexcept { return position == size; }
+    const char& current() const noexcept { return buffer[position]; }
+
+    void advance()
+    {
+        if (capture) {
+            capture->push_back(buffer[position]);
         }
 
-        if (error) {
-            co_yield util::Unexpected{*error};
+        if (++position == size) {
+            fill();
         }
-    } else {
+    }
+
+    void fill()
+    {
+        stream.read(buffer.data(), buffer.size());
+        size = static_cast<size_t>(stream.gcount());
+        position = 0;
+    }
+};
+
+// Follows the structure of the file outside of historical_info and captures the bytes of each of
+// its elements, which are handed to onYear once the parser reaches the end of the element.
+class YearSplitter: public nlohmann::json_sax<nlohmann::json> {
+public:
+    YearSplitter(FileReader& reader, const std::function<bool(std::string&&)>& onYear):
+        reader{reader},
+        onYear{onYear}
+    {
+    }
+
+    bool null() override { return value(nullptr); }
+    bool boolean(bool val) override { return value(val); }
+    bool number_integer(number_integer_t val) override { return value(val); }
+    bool number_unsigned(number_unsigned_t val) override { return value(val); }
+    bool number_float(number_float_t val, const string_t&) override { return value(val); }
+    bool string(string_t& val) override { return value(val); }
+    bool binary(binary_t& val) override { return value(nlohmann::json::binary(val)); }
+
+    bool start_object(std::size_t) override { return open('{'); }
+    bool end_object() override { return close(); }
+
+    bool start_array(std::size_t) override
+    {
+        if (yearDepth == 0 && depth == 1 && infoKey) {
+            inInfo = true;
+        }
+
+        return open('[');
+    }
+
+    bool end_array() override { return close(); }
+
+    bool key(string_t& val) override
+    {
+        if (yearDepth == 0 && depth == 1) {
+            infoKey = val == JSON_FIRST_LEVEL_NAME;
+        }
+
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override
+    {
+        error = e.what();
+        return false;
+    }
+
+    bool isStopped() const noexcept { return stopped; }
+    const std::string& getError() const noexcept { return error; }
+
+private:
+    FileReader& reader;
+    const std::function<bool(std::string&&)>& onYear;
+
+    // containers of the file outside of the year being captured
+    int depth = 0;
+    bool infoKey = false;
+    bool inInfo = false;
+    // containers of the year being captured
+    int yearDepth = 0;
+    bool stopped = false;
+    std::string error;
+
+    bool atYear() const noexcept { return yearDepth == 0 && inInfo && depth == 2; }
+
+    bool emit(std::string&& bytes)
+    {
+        stopped = !onYear(std::move(bytes));
+        return !stopped;
+    }
+
+    // a year which is not a container is left to the decoder to reject
+    bool value(const nlohmann::json& val)
+    {
+        return atYear() ? emit(val.dump()) : true;
+    }
+
+    bool open(char bracket)
+    {
+        if (yearDepth > 0) {
+            yearDepth++;
+        } else if (atYear()) {
+            reader.startCapture(bracket);
+            yearDepth++;
+        } else {
+            depth++;
+        }
+
+        return true;
+    }
+
+    bool close()
+    {
+        if (yearDepth > 0) {
+            return --yearDepth > 0 || emit(reader.stopCapture());
+        }
+
+        if (--depth == 1) {
+            inInfo = false;
+        }
+
+        return true;
+    }
+};
+}
+
+util::Generator<util::Expected<Data>> JsonImporter::loadFromFile(const std::string file, bool ordered)
+{
+    auto&& ret = openFile(file);
+    if (!ret) {
         co_yield util::Unexpected{ret.error()};
+        co_return;
+    }
+
+    // one thread splits the file into years, the workers parse them and the years are yielded here
+    DecodePipeline pipeline{
+        [this, stream = std::make_shared<std::fstream>(std::move(ret).value())](DecodePipeline& pipeline) {
+            if (auto ret = split(*stream, [&pipeline](std::string&& bytes) { return pipeline.push(std::move(bytes)); }); !ret) {
+                pipeline.fail(ret.error());
+            }
+        },
+        [this](const std::string& bytes) -> util::Expected<Data> {
+            try {
+                return decode(bytes).template get<Data>();
+            }
+            catch (const std::exception& e) {
+                return util::Unexpected{util::Error{util::ErrorCode::PARSE_FILE_ERROR, e.what()}};
+            }
+        },
+        ordered
+    };
+
+    while (auto info = pipeline.pop()) {
+        const auto failed = !info->has_value();
+
+        co_yield std::move(info).value();
+
+        if (failed) {
+            co_return;
+        }
     }
 }
 
@@ -131,9 +469,22 @@ util::Expected<std::fstream> JsonImporter::openFile(const std::string& file)
     return std::fstream{file, std::ios::in};
 }
 
-nlohmann::json JsonImporter::parse(std::fstream stream)
+util::Expected<void> JsonImporter::split(std::fstream& stream, const std::function<bool(std::string&&)>& onYear)
+{
+    FileReader reader{stream};
+    YearSplitter splitter{reader, onYear};
+
+    // the whole file is checked by the parser, but only the bytes of the year being split are kept
+    if (!nlohmann::json::sax_parse(FileReader::Iterator{&reader}, FileReader::Iterator{}, &splitter) && !splitter.isStopped()) {
+        return util::Unexpected{util::Error{util::ErrorCode::PARSE_FILE_ERROR, splitter.getError()}};
+    }
+
+    return util::SUCCESS;
+}
+
+nlohmann::json JsonImporter::decode(const std::string& bytes)
 {
-    return nlohmann::json::parse(stream);
+    return nlohmann::json::parse(bytes);
 }
 }
 
@@ -6,9 +6,13 @@
 #include "nlohmann/json.hpp"
 
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace persistence {
+constexpr auto JSON_FIRST_LEVEL_NAME = "historical_info";
+
 class JsonExporter: public IExporter {
 public:
     JsonExporter();
@@ -29,12 +33,15 @@ private:
 
 class JsonImporter: public IImporter {
 public:
-    virtual util::Generator<util::Expected<Data>> loadFromFile(const std::string file) override final;
+    virtual util::Generator<util::Expected<Data>> loadFromFile(const std::string file, bool ordered) override final;
 
 private:
     virtual util::Expected<std::fstream> openFile(const std::string& file);
 
-    virtual nlohmann::json parse(std::fstream stream);
+    // Hands the raw bytes of each element of historical_info to onYear until it returns false,
+    // it is called on the splitter thread while decode is called by the workers concurrently.
+    virtual util::Expected<void> split(std::fstream& stream, const std::function<bool(std::string&&)>& onYear);
+    virtual nlohmann::json decode(const std::string& bytes);
 };
 }
 
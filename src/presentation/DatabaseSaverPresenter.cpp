@@ -26,24 +26,52 @@ bool DatabaseSaverPresenter::handleSaveSameForRange(int startYear, int endYear)
     progress = 0;
     total = endYear - startYear + 1;
     saveComplete = false;
+    clearFailedYears();
 
     if (!taskQueue.enqueue([this, 
                             startYear, 
                             endYear] () mutable {
             const auto year = this->databaseModel.getYear();
+
+            if (startYear == year && endYear == year) {
+                // only the displayed year, write the changed entities and keep the cache as it is
+                if (const auto changes = getChanges(year)) {
+                    util::Expected<void> saved = util::SUCCESS;
+                    const auto ret = this->databaseModel.writeBatch([&changes, &saved](auto& batch){
+                        saved = batch.saveHistoricalInfo(changes->modified, changes->removed);
+                    });
+
+                    if (ret && saved) {
+                        markSaved(year, changes->revision);
+                    } else {
+                        reportFailure(year, ret ? saved.error().msg : ret.error().msg);
+                    }
+                }
+
+                progress = total;
+                saveComplete = true;
+                return;
+            }
+
             auto data = this->cacheModel.getData(this->source, year);
             auto removed = this->cacheModel.getRemoved(this->source, year);
             if (data && removed) {
-                for (int year = startYear; year <= endYear; year++) {
-                    data->year = year;
-                    removed->year = year;
-                    this->databaseModel.updateHistoricalInfo(*data);
-                    this->databaseModel.removeHistoricalInfo(*removed);
-                    this->cacheModel.upsert(model::PERMENANT_SOURCE, this->databaseModel.loadHistoricalInfo(year));
-                    this->progress++;
+                const auto ret = this->databaseModel.writeBatch([&data, &removed, startYear, endYear](auto& batch){
+                    batch.saveHistoricalInfoForRange(*data, *removed, startYear, endYear);
+                });
+
+                if (ret) {
+                    refreshResidentYears(startYear, endYear, year);
+                } else {
+                    logger.error("Failed to save historical info for range [{}, {}], error: {}", startYear, endYear, ret.error().msg);
+                    std::scoped_lock lk{failedYearsLock};
+                    for (auto failed = startYear; failed <= endYear; failed++) {
+                        failedYears.emplace_back(failed);
+                    }
                 }
             }
 
+            progress = total;
             saveComplete = true;
         })) {
         saveComplete = true;
@@ -56,21 +84,51 @@ bool DatabaseSaverPresenter::handleSaveSameForRange(int startYear, int endYear)
 void DatabaseSaverPresenter::handleSaveAll()
 {
     const auto years = this->cacheModel.getYearList(this->source);
+    progress = 0;
     total = years.size();
+    saveComplete = false;
+    clearFailedYears();
 
     if (!taskQueue.enqueue([this, years] () mutable {
-            for (const auto year : years) {
-                auto data = this->cacheModel.getData(this->source, year);
-                auto removed = this->cacheModel.getRemoved(this->source, year);
-
-                if (data && removed) {
-                    this->databaseModel.updateHistoricalInfo(*data);
-                    this->databaseModel.removeHistoricalInfo(*removed);
-                    this->cacheModel.upsert(model::PERMENANT_SOURCE, this->databaseModel.loadHistoricalInfo(year));
+            // all the years are written in one transaction, each year has its own savepoint
+            // so a failed year doesn't discard the others
+            std::vector<std::pair<int, uint64_t>> saved;
+            std::vector<std::pair<int, std::string>> failed;
+            const auto ret = this->databaseModel.writeBatch([this, &years, &saved, &failed](auto& batch){
+                for (const auto year : years) {
+                    if (const auto changes = getChanges(year); changes) {
+                        if (auto result = batch.saveHistoricalInfo(changes->modified, changes->removed); result) {
+                            saved.emplace_back(year, changes->revision);
+                        } else {
+                            failed.emplace_back(year, result.error().msg);
+                        }
+                    }
+
+                    this->progress++;
+                }
+            });
+
+            if (ret) {
+                for (const auto [year, revision] : saved) {
+                    markSaved(year, revision);
+                }
+
+                for (const auto& [year, msg] : failed) {
+                    reportFailure(year, msg);
+                }
+            } else {
+                // the whole transaction is rolled back, none of the years is saved
+                logger.error("Failed to save all historical info, error: {}", ret.error().msg);
+                for (const auto& [year, revision] : saved) {
+                    reportFailure(year, ret.error().msg);
+                }
+
+                for (const auto& [year, msg] : failed) {
+                    reportFailure(year, msg);
                 }
-                this->progress++;
             }
 
+            progress = total;
             saveComplete = true;
         })) {
         saveComplete = true;
@@ -78,6 +136,78 @@ void DatabaseSaverPresenter::handleSaveAll()
     }
 }
 
+std::vector<int> DatabaseSaverPresenter::getFailedYears() const
+{
+    std::scoped_lock lk{failedYearsLock};
+    return failedYears;
+}
+
+void DatabaseSaverPresenter::reportFailure(int year, const std::string& msg)
+{
+    logger.error("Failed to save historical info at year {}, error: {}", year, msg);
+
+    std::scoped_lock lk{failedYearsLock};
+    failedYears.emplace_back(year);
+}
+
+void DatabaseSaverPresenter::clearFailedYears()
+{
+    std::scoped_lock lk{failedYearsLock};
+    failedYears.clear();
+}
+
+// The cache of the database tracks what is changed since the year is loaded, only those need to be
+// written. The other sources are imported as a whole, everything is written.
+std::optional<persistence::HistoricalCache::Changes> DatabaseSaverPresenter::getChanges(int year) const
+{
+    if (source == model::PERMENANT_SOURCE) {
+        return cacheModel.getChanges(source, year);
+    }
+
+    auto data = cacheModel.getData(source, year);
+    auto removed = cacheModel.getRemoved(source, year);
+    if (data && removed) {
+        return persistence::HistoricalCache::Changes{std::move(*data), std::move(*removed)};
+    }
+
+    return std::nullopt;
+}
+
+// The cache of the database is what has been written, it isn't reloaded. A year changed while
+// it is being saved stays modified and its changes are written by the next save.
+void DatabaseSaverPresenter::markSaved(int year, uint64_t revision)
+{
+    if (source == model::PERMENANT_SOURCE) {
+        cacheModel.markSaved(source, year, revision);
+    } else {
+        cacheModel.upsert(model::PERMENANT_SOURCE, databaseModel.loadHistoricalInfo(year));
+    }
+}
+
+// Only the years already in the cache are affected by a range save. The displayed year is reloaded 
+// at once, the others are dropped and reloaded when they are visited again.
+void DatabaseSaverPresenter::refreshResidentYears(int startYear, int endYear, int currentYear)
+{
+    std::vector<int> residentYears;
+    for (const auto year : cacheModel.getYearList(model::PERMENANT_SOURCE)) {
+        if (year >= startYear && year <= endYear) {
+            residentYears.emplace_back(year);
+        }
+    }
+
+    progress = total - static_cast<int>(residentYears.size());
+
+    for (const auto year : residentYears) {
+        if (year == currentYear) {
+            cacheModel.upsert(model::PERMENANT_SOURCE, databaseModel.loadHistoricalInfo(year));
+        } else {
+            cacheModel.removeHistoricalInfoFromSource(model::PERMENANT_SOURCE, year);
+        }
+
+        progress++;
+    }
+}
+
 float DatabaseSaverPresenter::getProgress() const noexcept
 {
     return progress / static_cast<float>(total);
@@ -8,8 +8,12 @@
 #include "blockingconcurrentqueue.h"
 
 #include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace presentation {
 class DatabaseSaverPresenter {
@@ -21,6 +25,8 @@ public:
     void handleSaveAll();
     bool isSaveComplete() const noexcept { return saveComplete; }
     float getProgress() const noexcept;
+    // the years not saved by the last save, they are still modified in the cache
+    std::vector<int> getFailedYears() const;
 
 private:
     logger::ModuleLogger logger;
@@ -33,8 +39,15 @@ private:
     std::atomic_bool runWorkerThread;
     std::thread workerThread;
     std::atomic_bool saveComplete;
+    mutable std::mutex failedYearsLock;
+    std::vector<int> failedYears;
 
     void worker();
+    std::optional<persistence::HistoricalCache::Changes> getChanges(int year) const;
+    void markSaved(int year, uint64_t revision);
+    void reportFailure(int year, const std::string& msg);
+    void clearFailedYears();
+    void refreshResidentYears(int startYear, int endYear, int currentYear);
     void startWorkerThread();
     void stopWorkerThread();
 };
@@ -111,7 +111,7 @@ std::vector<std::string> HistoricalInfoPresenter::handleRequestCountryList() con
     return cacheModel.getCountryList(source, databaseModel.getYear());
 }
 
-std::list<persistence::Coordinate> HistoricalInfoPresenter::handleRequestContour(const std::string& name) const
+persistence::Contour HistoricalInfoPresenter::handleRequestContour(const std::string& name) const
 {
     return cacheModel.getContour(source, databaseModel.getYear(), name);
 }
@@ -26,7 +26,7 @@ public:
     void setHoveredCoord(const persistence::Coordinate& coordinate);
     void clearHoveredCoord();
     std::vector<std::string> handleRequestCountryList() const;
-    std::list<persistence::Coordinate> handleRequestContour(const std::string& name) const;
+    persistence::Contour handleRequestContour(const std::string& name) const;
     void handleUpdateContour(const std::string& name, int idx, const persistence::Coordinate& coordinate);
     void handleDeleteFromContour(const std::string& name, int idx);
     std::vector<std::string> handleRequestCityList() const;
@@ -30,7 +30,8 @@ void ImportPresenter::handleDoImport(const std::string& file)
     task = std::async(std::launch::async, [this, file]() -> util::Expected<void> {
         const auto format = std::filesystem::u8path(file).extension().string().substr(PERIOD_INDEX);
         if (auto ret = this->importModel.setFormat(format); ret) {
-            auto loader = this->importModel.loadFromFile(file);
+            // the years are upserted by year, the order they are loaded doesn't matter
+            auto loader = this->importModel.loadFromFile(file, false);
             int count = 0;
 
             while (loader.next()) {
@@ -182,16 +182,19 @@ void InfoSelectorPresenter::handleSelectAllForMultipleYears(int startYear, int e
     total = endYear - startYear + 1;
     stopTask = false;
     task = std::async(std::launch::async, [this, startYear, endYear](){
-        for (int year = startYear; year <= endYear; year++) {
+        // the years are loaded from the database in chunks instead of one query per year
+        auto loader = this->databaseModel.loadHistoricalInfo(startYear, endYear);
+        while (loader.next()) {
             if (stopTask) {
                 return;
             }
 
+            auto info = loader.getValue();
+            const auto year = info.year;
             this->databaseModel.setYear(year);
             
             if (!this->cacheModel.containsHistoricalInfo(this->fromSource, year)) {
-                this->cacheModel.upsert(this->fromSource, 
-                                              this->databaseModel.loadHistoricalInfo(year));
+                this->cacheModel.upsert(this->fromSource, std::move(info));
             }
 
             this->handleSelectAll();
@@ -0,0 +1,90 @@
+#include "src/presentation/IngestPresenter.h"
+#include "src/logger/LoggerManager.h"
+
+#include <chrono>
+#include <filesystem>
+
+namespace presentation {
+using namespace std::chrono_literals;
+
+constexpr int PERIOD_INDEX = 1;
+constexpr auto LOGGER_NAME = "IngestPresenter";
+
+IngestPresenter::IngestPresenter():
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)}, 
+    cacheModel{model::CacheModel::getInstance()},
+    databaseModel{model::DatabaseModel::getInstance()}
+{
+}
+
+IngestPresenter::~IngestPresenter()
+{
+    stopIngest = true;
+
+    if (task.valid()) {
+        task.wait();
+    }
+}
+
+void IngestPresenter::handleDoIngest(const std::string& file)
+{
+    ingested = 0;
+    stopIngest = false;
+
+    task = std::async(std::launch::async, [this, file]() -> util::Expected<void> {
+        const auto format = std::filesystem::u8path(file).extension().string().substr(PERIOD_INDEX);
+        if (auto ret = this->importModel.setFormat(format); !ret) {
+            return util::Unexpected{ret.error()};
+        }
+
+        const auto ret = this->databaseModel.ingest(this->importModel.loadFromFile(file, true), [this](size_t written){
+            this->ingested = written;
+            return !this->stopIngest;
+        });
+
+        // the database is changed even if the ingestion is not finished
+        refreshResidentYears();
+
+        if (!ret) {
+            return util::Unexpected{ret.error()};
+        }
+
+        if (*ret == 0 && !stopIngest) {
+            return util::Unexpected{util::Error{util::ErrorCode::FILE_EMPTY}};
+        }
+
+        return util::SUCCESS;
+    });
+}
+
+util::Expected<bool> IngestPresenter::handleCheckIngestComplete()
+{
+    if (task.valid() && task.wait_for(0s) == std::future_status::ready) {
+        if (auto ret = task.get(); ret) {
+            return true;
+        } else {
+            return util::Unexpected{ret.error()};
+        }
+    } else {
+        return false;
+    }
+}
+
+// The years in the cache may be overwritten by the ingestion, they are dropped and reloaded
+// when they are visited again. The displayed year is reloaded at once. The modified ones are
+// kept so the modification is not lost.
+void IngestPresenter::refreshResidentYears()
+{
+    for (const auto year : cacheModel.getYearList(model::PERMENANT_SOURCE)) {
+        if (!cacheModel.isModified(model::PERMENANT_SOURCE, year)) {
+            cacheModel.removeHistoricalInfoFromSource(model::PERMENANT_SOURCE, year);
+        }
+    }
+
+    if (cacheModel.containsHistoricalInfo(model::PERMENANT_SOURCE, databaseModel.getYear())) {
+        return;
+    }
+
+    cacheModel.upsert(model::PERMENANT_SOURCE, databaseModel.loadHistoricalInfo(databaseModel.getYear()));
+}
+}
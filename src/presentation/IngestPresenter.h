@@ -0,0 +1,42 @@
+#ifndef SRC_PRESENTATION_INGEST_PRESENTER_H
+#define SRC_PRESENTATION_INGEST_PRESENTER_H
+
+#include "src/model/CacheModel.h"
+#include "src/model/DatabaseModel.h"
+#include "src/model/ImportModel.h"
+#include "src/util/Error.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <string>
+#include <vector>
+#include <future>
+#include <atomic>
+
+namespace presentation {
+// Imports a file into the database directly, the years are not kept in the CacheModel
+// and can't be selected, see DatabaseModel::ingest.
+class IngestPresenter {
+public:
+    IngestPresenter();
+    ~IngestPresenter();
+
+    void handleDoIngest(const std::string& file);
+    util::Expected<bool> handleCheckIngestComplete();
+    size_t handleGetIngestedYears() const noexcept { return ingested; }
+    std::vector<std::string> handleGetSupportedFormat() const { return importModel.getSupportedFormat(); }
+    void handleCancelIngest() { stopIngest = true; }
+
+private:
+    logger::ModuleLogger logger;
+    model::CacheModel& cacheModel;
+    model::DatabaseModel& databaseModel;
+    model::ImportModel importModel;
+    std::future<util::Expected<void>> task;
+    std::atomic_size_t ingested = 0;
+    std::atomic_bool stopIngest = false;
+
+    void refreshResidentYears();
+};
+}
+
+#endif
@@ -65,6 +65,14 @@ void MainViewPresenter::handleClickExport()
     view.addNoninteractiveMapWidget(handleGetDefaultMapWidgetSouceName());
 }
 
+// the years are written to the database directly, the map is only editable after it is finished
+void MainViewPresenter::handleClickIngest()
+{
+    clearCache();
+    view.clearMapWidgets();
+    view.addNoninteractiveMapWidget(handleGetDefaultMapWidgetSouceName());
+}
+
 void MainViewPresenter::handleImportExportComplete()
 {
     view.clearMapWidgets();
@@ -97,4 +105,14 @@ std::vector<std::string> MainViewPresenter::handleGetLanguages() const
 {
     return {CHINESE, ENGLISH};
 }
+
+void MainViewPresenter::handleEnableSnapshot(bool enable)
+{
+    databaseModel.enableSnapshot(enable);
+}
+
+bool MainViewPresenter::handleIsSnapshotEnabled() const noexcept
+{
+    return databaseModel.isSnapshotEnabled();
+}
 }
\ No newline at end of file
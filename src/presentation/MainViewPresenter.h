@@ -17,9 +17,12 @@ public:
     std::string handleGetDefaultMapWidgetSouceName() const noexcept;
     void handleClickImport();
     void handleClickExport();
+    void handleClickIngest();
     void handleImportExportComplete();
     void handleSetLanguage(const std::string& language);
     std::vector<std::string> handleGetLanguages() const;
+    void handleEnableSnapshot(bool enable);
+    bool handleIsSnapshotEnabled() const noexcept;
 
 private:
     MainViewInterface& view;
@@ -67,6 +67,7 @@ MapWidgetPresenter::~MapWidgetPresenter()
     util::signal::disconnectAll(&databaseModel,
                                 &model::DatabaseModel::onYearChange,
                                 this);
+    tileModel.removeViewport(this);
 }
 
 void MapWidgetPresenter::handleRenderTiles()
@@ -74,7 +75,7 @@ void MapWidgetPresenter::handleRenderTiles()
     const auto xAxis = view.getAxisRangeX();
     const auto yAxis = view.getAxisRangeY();
     const auto plotSize = view.getPlotSize();
-    const auto tiles = tileModel.getTiles(xAxis, yAxis, plotSize);
+    const auto tiles = tileModel.getTiles(this, xAxis, yAxis, plotSize);
     std::vector<Tile> newTile;
     bool allLoaded = true;
 
@@ -0,0 +1,32 @@
+#include "src/presentation/TileSeedPresenter.h"
+
+#include <algorithm>
+
+namespace presentation {
+constexpr int MIN_CONCURRENCY = 1;
+
+TileSeedPresenter::TileSeedPresenter():
+    tileModel{model::TileModel::getInstance()}
+{
+}
+
+util::Expected<void> TileSeedPresenter::handleStartSeed(const std::string& url,
+                                                        const std::string& path,
+                                                        const model::BoundingBox& bbox,
+                                                        int minZoom,
+                                                        int maxZoom,
+                                                        int concurrency,
+                                                        float requestsPerSecond)
+{
+    if (path.empty()) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "No file to save the tiles"}};
+    }
+
+    const tile::TileSeeder::Options options{
+        static_cast<size_t>(std::max(concurrency, MIN_CONCURRENCY)),
+        requestsPerSecond
+    };
+
+    return seedModel.start(url, path, bbox, minZoom, maxZoom, options);
+}
+}
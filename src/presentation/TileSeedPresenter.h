@@ -0,0 +1,34 @@
+#ifndef SRC_PRESENTATION_TILE_SEED_PRESENTER_H
+#define SRC_PRESENTATION_TILE_SEED_PRESENTER_H
+
+#include "src/model/SeedModel.h"
+#include "src/model/TileModel.h"
+#include "src/util/Error.h"
+
+#include <string>
+
+namespace presentation {
+class TileSeedPresenter {
+public:
+    TileSeedPresenter();
+
+    // the region currently shown on the map
+    model::BoundingBox handleGetBoundingBox() const noexcept { return tileModel.getBoundingBox(); }
+    util::Expected<void> handleStartSeed(const std::string& url,
+                                         const std::string& path,
+                                         const model::BoundingBox& bbox,
+                                         int minZoom,
+                                         int maxZoom,
+                                         int concurrency,
+                                         float requestsPerSecond);
+    void handleStopSeed() { seedModel.stop(); }
+    bool handleIsSeeding() const noexcept { return seedModel.isRunning(); }
+    tile::TileSeeder::Progress handleGetSeedProgress() const noexcept { return seedModel.getProgress(); }
+
+private:
+    model::TileModel& tileModel;
+    model::SeedModel seedModel;
+};
+}
+
+#endif
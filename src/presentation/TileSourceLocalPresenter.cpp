@@ -0,0 +1,36 @@
+#include "src/presentation/TileSourceLocalPresenter.h"
+#include "src/tile/TileSourceMBTiles.h"
+#include "src/tile/TileSourceDirectory.h"
+
+namespace presentation {
+TileSourceLocalPresenter::TileSourceLocalPresenter(Type type):
+    model{model::TileModel::getInstance()},
+    type{type}
+{}
+
+bool TileSourceLocalPresenter::handleSetPath(const std::string& path)
+{
+    std::shared_ptr<tile::TileSource> source;
+
+    if (type == Type::MBTILES) {
+        if (auto mbtiles = std::make_shared<tile::TileSourceMBTiles>(path); mbtiles->isOpen()) {
+            source = std::move(mbtiles);
+        }
+    } else {
+        if (auto directory = std::make_shared<tile::TileSourceDirectory>(path); directory->isOpen()) {
+            source = std::move(directory);
+        }
+    }
+
+    if (!source) {
+        return false;
+    }
+
+    this->source = std::move(source);
+    this->path = path;
+    model.setTileSource(this->source);
+    model.clearCache();
+
+    return true;
+}
+}
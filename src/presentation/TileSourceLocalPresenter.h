@@ -0,0 +1,33 @@
+#ifndef SRC_PRESENTATION_TILE_SOURCE_LOCAL_PRESENTER_H
+#define SRC_PRESENTATION_TILE_SOURCE_LOCAL_PRESENTER_H
+
+#include "src/tile/TileSource.h"
+#include "src/model/TileModel.h"
+
+#include <string>
+#include <memory>
+
+namespace presentation {
+// The tiles are read from the disk, either a MBTiles file or a {z}/{x}/{y}.png directory tree
+class TileSourceLocalPresenter {
+public:
+    enum class Type {
+        MBTILES,
+        DIRECTORY
+    };
+
+    explicit TileSourceLocalPresenter(Type type);
+
+    Type handleGetType() const noexcept { return type; }
+    std::string handleGetPath() const noexcept { return path; }
+    bool handleSetPath(const std::string& path);
+
+private:
+    model::TileModel& model;
+    Type type;
+    std::string path;
+    std::shared_ptr<tile::TileSource> source;
+};
+}
+
+#endif
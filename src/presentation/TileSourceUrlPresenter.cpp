@@ -3,7 +3,7 @@
 namespace presentation {
 TileSourceUrlPresenter::TileSourceUrlPresenter():
     model{model::TileModel::getInstance()},
-    source{std::make_shared<tile::TileSourceUrl>(url)}
+    source{std::make_shared<tile::TileSourceUrl>(url, model.getDiskCache())}
 {
     model.setTileSource(source); 
 }
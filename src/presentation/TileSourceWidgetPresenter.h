@@ -15,6 +15,12 @@ public:
     auto handleGetTileEngineList() const noexcept { return model.getTileEngineTypes(); }
     auto handleGetTileSourceList() const noexcept { return model.getTileSourceTypes(); }
     auto handleSetTileEngine(const std::string& engine) { return model.setTileEngine(engine); }
+    size_t handleGetFetchWorkers() const noexcept { return model.getFetchWorkers(); }
+    size_t handleGetDecodeWorkers() const noexcept { return model.getDecodeWorkers(); }
+    void handleSetConcurrency(int fetchWorkers, int decodeWorkers)
+    {
+        model.setConcurrency(static_cast<size_t>(fetchWorkers), static_cast<size_t>(decodeWorkers));
+    }
 
 private:
     model::TileModel& model;
@@ -0,0 +1,266 @@
+#include "src/tile/TileDiskCache.h"
+#include "src/persistence/SqliteStatement.h"
+#include "src/logger/LoggerManager.h"
+
+#include <sqlite3.h>
+
+#include <span>
+
+namespace tile {
+constexpr auto LOGGER_NAME = "TileDiskCache";
+// evicts down to the ratio of the limit, so it doesn't run again for every new tile
+constexpr auto EVICT_TO = 0.9;
+constexpr int EVICT_BATCH = 64;
+
+// named after MBTiles, but tile_row is the y of the XYZ scheme used by the tile servers
+constexpr auto CREATE_TABLE = R"(CREATE TABLE IF NOT EXISTS tiles(
+    id INTEGER PRIMARY KEY,
+    source TEXT NOT NULL,
+    zoom_level INTEGER NOT NULL,
+    tile_column INTEGER NOT NULL,
+    tile_row INTEGER NOT NULL,
+    tile_data BLOB NOT NULL,
+    etag TEXT NOT NULL,
+    last_modified TEXT NOT NULL,
+    validated INTEGER NOT NULL,
+    accessed INTEGER NOT NULL,
+    UNIQUE(source, zoom_level, tile_column, tile_row)
+))";
+constexpr auto CREATE_ACCESSED_INDEX = "CREATE INDEX IF NOT EXISTS tilesAccessed ON tiles(accessed)";
+constexpr auto TILE_KEY = "source = ?1 AND zoom_level = ?2 AND tile_column = ?3 AND tile_row = ?4";
+
+namespace {
+void bindKey(persistence::SqliteStatement& statement, const std::string& source, const Coordinate& coord)
+{
+    statement.bindText(1, source).bindInt(2, coord.z).bindInt(3, coord.x).bindInt(4, coord.y);
+}
+}
+
+TileDiskCache::TileDiskCache(const std::string& path, uint64_t maxSize):
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
+    maxSize{maxSize}
+{
+    if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, nullptr) != SQLITE_OK) {
+        logger.error("Failed to open the tile cache {}, error: {}", path, sqlite3_errmsg(db));
+        sqlite3_close_v2(db);
+        db = nullptr;
+        return;
+    }
+
+    try {
+        // only takes effect on a new file, the pages freed by the eviction are given back to the file system
+        persistence::SqliteStatement{db, "PRAGMA auto_vacuum = INCREMENTAL"}.execute();
+        // losing the last tiles on a power cut is fine, they are downloaded again
+        persistence::SqliteStatement{db, "PRAGMA journal_mode = WAL"}.execute();
+        persistence::SqliteStatement{db, "PRAGMA synchronous = NORMAL"}.execute();
+        persistence::SqliteStatement{db, CREATE_TABLE}.execute();
+        persistence::SqliteStatement{db, CREATE_ACCESSED_INDEX}.execute();
+
+        persistence::SqliteStatement total{db, "SELECT COALESCE(SUM(length(tile_data)), 0), COALESCE(MAX(accessed), 0) FROM tiles"};
+        if (total.step()) {
+            size = static_cast<uint64_t>(total.getInt(0));
+            clock = total.getInt(1);
+        }
+
+        const std::string key{TILE_KEY};
+        findStatement = std::make_unique<persistence::SqliteStatement>(db, "SELECT id, tile_data, etag, last_modified, validated FROM tiles WHERE " + key);
+        containsStatement = std::make_unique<persistence::SqliteStatement>(db, "SELECT 1 FROM tiles WHERE " + key);
+        touchStatement = std::make_unique<persistence::SqliteStatement>(db, "UPDATE tiles SET accessed = ?1 WHERE id = ?2");
+        sizeStatement = std::make_unique<persistence::SqliteStatement>(db, "SELECT length(tile_data) FROM tiles WHERE " + key);
+        storeStatement = std::make_unique<persistence::SqliteStatement>(db, "INSERT INTO tiles(source, zoom_level, tile_column, tile_row, tile_data, etag, last_modified, validated, accessed) "
+                                   "VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9) "
+                                   "ON CONFLICT(source, zoom_level, tile_column, tile_row) DO UPDATE SET "
+                                   "tile_data = excluded.tile_data, etag = excluded.etag, last_modified = excluded.last_modified, "
+                                   "validated = excluded.validated, accessed = excluded.accessed");
+        revalidateStatement = std::make_unique<persistence::SqliteStatement>(db, "UPDATE tiles SET validated = ?5, accessed = ?6 WHERE " + key);
+        oldestStatement = std::make_unique<persistence::SqliteStatement>(db, "SELECT id, length(tile_data) FROM tiles ORDER BY accessed LIMIT ?1");
+        evictStatement = std::make_unique<persistence::SqliteStatement>(db, "DELETE FROM tiles WHERE id = ?1");
+
+        logger.info("Open tile cache {}, {} bytes of tiles", path, size.load());
+    } catch (const std::exception& e) {
+        logger.error("Failed to initialize the tile cache {}, error: {}", path, e.what());
+        close();
+    }
+}
+
+TileDiskCache::~TileDiskCache()
+{
+    close();
+}
+
+void TileDiskCache::close()
+{
+    findStatement.reset();
+    containsStatement.reset();
+    touchStatement.reset();
+    sizeStatement.reset();
+    storeStatement.reset();
+    revalidateStatement.reset();
+    oldestStatement.reset();
+    evictStatement.reset();
+
+    if (db) {
+        sqlite3_close_v2(db);
+        db = nullptr;
+    }
+}
+
+std::optional<TileDiskCache::Entry> TileDiskCache::find(const std::string& source, const Coordinate& coord)
+{
+    std::scoped_lock lk{lock};
+    if (!db) {
+        return std::nullopt;
+    }
+
+    try {
+        bindKey(*findStatement, source, coord);
+        if (!findStatement->step()) {
+            findStatement->reset();
+            return std::nullopt;
+        }
+
+        const auto id = findStatement->getInt(0);
+        const auto blob = findStatement->getBlob(1);
+        const auto bytes = reinterpret_cast<const std::byte*>(blob.data());
+        Entry entry{
+            std::vector<std::byte>{bytes, bytes + blob.size()},
+            findStatement->getText(2),
+            findStatement->getText(3),
+            findStatement->getInt(4)
+        };
+        findStatement->reset();
+
+        touchStatement->bindInt(1, ++clock).bindInt(2, id).execute();
+
+        return entry;
+    } catch (const std::exception& e) {
+        logger.error("Failed to find tile x={}, y={}, z={} of {}, error: {}", coord.x, coord.y, coord.z, source, e.what());
+        findStatement->reset();
+        return std::nullopt;
+    }
+}
+
+bool TileDiskCache::contains(const std::string& source, const Coordinate& coord)
+{
+    std::scoped_lock lk{lock};
+    if (!db) {
+        return false;
+    }
+
+    try {
+        bindKey(*containsStatement, source, coord);
+        const auto found = containsStatement->step();
+        containsStatement->reset();
+
+        return found;
+    } catch (const std::exception& e) {
+        logger.error("Failed to find tile x={}, y={}, z={} of {}, error: {}", coord.x, coord.y, coord.z, source, e.what());
+        containsStatement->reset();
+        return false;
+    }
+}
+
+void TileDiskCache::store(const std::string& source, const Coordinate& coord, const Entry& entry)
+{
+    std::scoped_lock lk{lock};
+    if (!db) {
+        return;
+    }
+
+    try {
+        bindKey(*sizeStatement, source, coord);
+        const auto replaced = sizeStatement->step() ? static_cast<uint64_t>(sizeStatement->getInt(0)) : 0;
+        sizeStatement->reset();
+
+        bindKey(*storeStatement, source, coord);
+        storeStatement->bindBlob(5, std::span{reinterpret_cast<const uint8_t*>(entry.data.data()), entry.data.size()})
+                       .bindText(6, entry.etag)
+                       .bindText(7, entry.lastModified)
+                       .bindInt(8, entry.validated)
+                       .bindInt(9, ++clock)
+                       .execute();
+
+        size = size - replaced + entry.data.size();
+
+        if (size > maxSize) {
+            evict();
+        }
+    } catch (const std::exception& e) {
+        logger.error("Failed to store tile x={}, y={}, z={} of {}, error: {}", coord.x, coord.y, coord.z, source, e.what());
+        sizeStatement->reset();
+        storeStatement->reset();
+    }
+}
+
+void TileDiskCache::revalidate(const std::string& source, const Coordinate& coord, int64_t validated)
+{
+    std::scoped_lock lk{lock};
+    if (!db) {
+        return;
+    }
+
+    try {
+        bindKey(*revalidateStatement, source, coord);
+        revalidateStatement->bindInt(5, validated).bindInt(6, ++clock).execute();
+    } catch (const std::exception& e) {
+        logger.error("Failed to revalidate tile x={}, y={}, z={} of {}, error: {}", coord.x, coord.y, coord.z, source, e.what());
+        revalidateStatement->reset();
+    }
+}
+
+void TileDiskCache::setMaxSize(uint64_t maxSize)
+{
+    std::scoped_lock lk{lock};
+    this->maxSize = maxSize;
+
+    if (db && size > maxSize) {
+        try {
+            evict();
+        } catch (const std::exception& e) {
+            logger.error("Failed to evict tiles, error: {}", e.what());
+        }
+    }
+}
+
+void TileDiskCache::evict()
+{
+    const auto target = static_cast<uint64_t>(maxSize * EVICT_TO);
+    // only applied to size once committed, a rollback keeps the tiles
+    uint64_t remaining = size;
+    persistence::SqliteStatement{db, "BEGIN"}.execute();
+
+    try {
+        while (remaining > target) {
+            std::vector<std::pair<int64_t, uint64_t>> oldest;
+            oldestStatement->bindInt(1, EVICT_BATCH);
+            while (oldestStatement->step()) {
+                oldest.emplace_back(oldestStatement->getInt(0), static_cast<uint64_t>(oldestStatement->getInt(1)));
+            }
+            oldestStatement->reset();
+
+            if (oldest.empty()) {
+                break;
+            }
+
+            for (const auto& [id, tileSize] : oldest) {
+                if (remaining <= target) {
+                    break;
+                }
+
+                evictStatement->bindInt(1, id).execute();
+                remaining -= tileSize;
+            }
+        }
+
+        persistence::SqliteStatement{db, "COMMIT"}.execute();
+        size = remaining;
+    } catch (...) {
+        oldestStatement->reset();
+        evictStatement->reset();
+        persistence::SqliteStatement{db, "ROLLBACK"}.execute();
+        throw;
+    }
+
+    persistence::SqliteStatement{db, "PRAGMA incremental_vacuum"}.execute();
+}
+}
@@ -0,0 +1,74 @@
+#ifndef SRC_TILE_TILE_DISK_CACHE_H
+#define SRC_TILE_TILE_DISK_CACHE_H
+
+#include "src/tile/Util.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace persistence {
+class SqliteStatement;
+}
+
+namespace tile {
+// Keeps the downloaded tiles in a single SQLite file so they survive restarts. The tiles are keyed
+// by the source they are downloaded from, e.g. the url template, and the least recently used ones
+// are evicted once the tile data grows over the size limit. The limit counts the bytes of the tiles
+// only, the file is somewhat larger because of the keys, the index and the SQLite pages. Errors are
+// logged and the tile is treated as not cached, the map still works without the cache.
+class TileDiskCache {
+public:
+    struct Entry {
+        std::vector<std::byte> data;
+        std::string etag;
+        std::string lastModified;
+        int64_t validated = 0;      // seconds since epoch when the data is known to be up to date
+    };
+
+    TileDiskCache(const std::string& path, uint64_t maxSize);
+    ~TileDiskCache();
+
+    TileDiskCache(const TileDiskCache&) = delete;
+    TileDiskCache& operator=(const TileDiskCache&) = delete;
+
+    std::optional<Entry> find(const std::string& source, const Coordinate& coord);
+    bool contains(const std::string& source, const Coordinate& coord);
+    void store(const std::string& source, const Coordinate& coord, const Entry& entry);
+    // the server confirmed the cached data is still up to date
+    void revalidate(const std::string& source, const Coordinate& coord, int64_t validated);
+
+    void setMaxSize(uint64_t maxSize);
+    uint64_t getMaxSize() const noexcept { return maxSize; }
+    uint64_t getSize() const noexcept { return size; }
+
+private:
+    logger::ModuleLogger logger;
+    std::mutex lock;
+    sqlite3* db = nullptr;
+    std::unique_ptr<persistence::SqliteStatement> findStatement;
+    std::unique_ptr<persistence::SqliteStatement> containsStatement;
+    std::unique_ptr<persistence::SqliteStatement> touchStatement;
+    std::unique_ptr<persistence::SqliteStatement> sizeStatement;
+    std::unique_ptr<persistence::SqliteStatement> storeStatement;
+    std::unique_ptr<persistence::SqliteStatement> revalidateStatement;
+    std::unique_ptr<persistence::SqliteStatement> oldestStatement;
+    std::unique_ptr<persistence::SqliteStatement> evictStatement;
+    std::atomic<uint64_t> maxSize;
+    std::atomic<uint64_t> size = 0;      // of the tile data
+    int64_t clock = 0;          // the order the tiles are used in
+
+    void close();
+    void evict();
+};
+}
+
+#endif
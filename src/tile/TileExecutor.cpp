@@ -0,0 +1,310 @@
+#include "src/tile/TileExecutor.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+namespace tile {
+constexpr size_t MIN_WORKERS = 1;
+constexpr int PREFETCH_MARGIN = 1;
+constexpr double DEMOTED = 1e9;
+
+namespace {
+bool later(const auto& a, const auto& b)
+{
+    return a.priority > b.priority || (a.priority == b.priority && a.order > b.order);
+}
+}
+
+TileExecutor::TileExecutor(size_t fetchWorkers, size_t decodeWorkers)
+{
+    start(fetchWorkers, decodeWorkers);
+}
+
+TileExecutor::~TileExecutor()
+{
+    stop();
+    clear();
+}
+
+std::future<std::optional<TileExecutor::Image>> TileExecutor::submit(const Coordinate& coord,
+                                                                     std::shared_ptr<TileSource> source,
+                                                                     std::shared_ptr<TileEngine> engine)
+{
+    std::promise<std::optional<Image>> promise;
+    auto future = promise.get_future();
+
+    {
+        std::scoped_lock lk{lock};
+        if (const auto priority = priorityOf(coord); priority) {
+            fetchQueue.push_back(FetchJob{coord, std::move(source), std::move(engine), std::move(promise), *priority, submitted++});
+            std::push_heap(fetchQueue.begin(), fetchQueue.end(), later<FetchJob, FetchJob>);
+        } else {
+            dropped++;
+            promise.set_value(std::nullopt);
+            return future;
+        }
+    }
+    fetchQueued.notify_one();
+
+    return future;
+}
+
+void TileExecutor::setConcurrency(size_t fetchWorkers, size_t decodeWorkers)
+{
+    joinExited();
+
+    {
+        std::scoped_lock lk{lock};
+        generation++;
+    }
+    fetchQueued.notify_all();
+    decodeQueued.notify_all();
+
+    std::move(this->fetchWorkers.begin(), this->fetchWorkers.end(), std::back_inserter(retiredWorkers));
+    std::move(this->decodeWorkers.begin(), this->decodeWorkers.end(), std::back_inserter(retiredWorkers));
+    this->fetchWorkers.clear();
+    this->decodeWorkers.clear();
+
+    start(fetchWorkers, decodeWorkers);
+}
+
+void TileExecutor::clear()
+{
+    std::vector<FetchJob> fetches;
+    std::deque<DecodeJob> decodes;
+
+    {
+        std::scoped_lock lk{lock};
+        fetches.swap(fetchQueue);
+        decodes.swap(decodeQueue);
+    }
+
+    for (auto& job : fetches) {
+        job.promise.set_value(std::nullopt);
+    }
+
+    for (auto& job : decodes) {
+        job.promise.set_value(std::nullopt);
+    }
+}
+
+void TileExecutor::setViewport(ViewportKey key, const Viewport& viewport)
+{
+    std::vector<FetchJob> stale;
+
+    {
+        std::scoped_lock lk{lock};
+        if (const auto it = viewports.find(key); it != viewports.end() && it->second == viewport) {
+            return;
+        }
+
+        viewports[key] = viewport;
+        stale = reprioritize();
+    }
+
+    drop(stale);
+}
+
+void TileExecutor::removeViewport(ViewportKey key)
+{
+    std::vector<FetchJob> stale;
+
+    {
+        std::scoped_lock lk{lock};
+        if (viewports.erase(key) == 0) {
+            return;
+        }
+
+        stale = reprioritize();
+    }
+
+    drop(stale);
+}
+
+TileExecutor::Metrics TileExecutor::getMetrics() const
+{
+    std::scoped_lock lk{lock};
+    return {fetchQueue.size(), fetching.size(), decodeQueue.size(), decoding, dropped};
+}
+
+std::optional<double> TileExecutor::priorityOf(const Coordinate& coord) const noexcept
+{
+    if (viewports.empty()) {
+        return 0.0;
+    }
+
+    // the best priority among the viewports
+    std::optional<double> priority;
+    for (const auto& [key, viewport] : viewports) {
+        if (!viewport.contains(coord, PREFETCH_MARGIN)) {
+            continue;
+        }
+
+        const auto dx = coord.x + 0.5 - (viewport.xMin + viewport.xMax + 1) / 2.0;
+        const auto dy = coord.y + 0.5 - (viewport.yMin + viewport.yMax + 1) / 2.0;
+        const auto distance = dx * dx + dy * dy;
+        const auto current = viewport.contains(coord) ? distance : DEMOTED + distance;
+
+        if (!priority || current < *priority) {
+            priority = current;
+        }
+    }
+
+    return priority;
+}
+
+// called with the lock held after the viewports change, returns the jobs to drop
+std::vector<TileExecutor::FetchJob> TileExecutor::reprioritize()
+{
+    std::vector<FetchJob> stale;
+
+    auto kept = std::partition(fetchQueue.begin(), fetchQueue.end(), [this](FetchJob& job) {
+        if (const auto priority = priorityOf(job.coord); priority) {
+            job.priority = *priority;
+            return true;
+        }
+
+        return false;
+    });
+
+    std::move(kept, fetchQueue.end(), std::back_inserter(stale));
+    fetchQueue.erase(kept, fetchQueue.end());
+    std::make_heap(fetchQueue.begin(), fetchQueue.end(), later<FetchJob, FetchJob>);
+
+    for (auto& [order, tile] : fetching) {
+        if (!priorityOf(tile.coord)) {
+            tile.canceled->store(true);
+        }
+    }
+
+    dropped += stale.size();
+
+    return stale;
+}
+
+void TileExecutor::drop(std::vector<FetchJob>& jobs)
+{
+    for (auto& job : jobs) {
+        job.promise.set_value(std::nullopt);
+    }
+}
+
+void TileExecutor::start(size_t fetchWorkers, size_t decodeWorkers)
+{
+    size_t current;
+    {
+        std::scoped_lock lk{lock};
+        current = generation;
+    }
+
+    const auto launch = [this](auto work) {
+        auto exited = std::make_shared<std::atomic_bool>(false);
+        return Worker{std::thread{[work, exited]() {
+            work();
+            exited->store(true);
+        }}, exited};
+    };
+
+    for (size_t i = 0; i < std::max(fetchWorkers, MIN_WORKERS); i++) {
+        this->fetchWorkers.emplace_back(launch([this, current]() { fetch(current); }));
+    }
+
+    for (size_t i = 0; i < std::max(decodeWorkers, MIN_WORKERS); i++) {
+        this->decodeWorkers.emplace_back(launch([this, current]() { decode(current); }));
+    }
+}
+
+void TileExecutor::stop()
+{
+    {
+        std::scoped_lock lk{lock};
+        stopped = true;
+    }
+    fetchQueued.notify_all();
+    decodeQueued.notify_all();
+
+    for (auto* workers : {&fetchWorkers, &decodeWorkers, &retiredWorkers}) {
+        for (auto& worker : *workers) {
+            worker.thread.join();
+        }
+        workers->clear();
+    }
+}
+
+void TileExecutor::joinExited()
+{
+    std::erase_if(retiredWorkers, [](Worker& worker) {
+        if (!worker.exited->load()) {
+            return false;
+        }
+
+        worker.thread.join();
+        return true;
+    });
+}
+
+void TileExecutor::fetch(size_t generation)
+{
+    std::unique_lock lk{lock};
+    const auto retired = [this, generation]() { return stopped || generation != this->generation; };
+
+    while (true) {
+        fetchQueued.wait(lk, [this, &retired]() { return retired() || !fetchQueue.empty(); });
+        if (retired()) {
+            return;
+        }
+
+        std::pop_heap(fetchQueue.begin(), fetchQueue.end(), later<FetchJob, FetchJob>);
+        auto job = std::move(fetchQueue.back());
+        fetchQueue.pop_back();
+
+        const auto canceled = std::make_shared<std::atomic_bool>(false);
+        fetching.emplace(job.order, FetchingTile{job.coord, canceled});
+        lk.unlock();
+
+        std::vector<std::byte> data;
+        try {
+            data = job.source->request(job.coord, *canceled);
+        } catch (const std::exception&) {
+        }
+
+        lk.lock();
+        fetching.erase(job.order);
+
+        if (data.empty() || *canceled) {
+            job.promise.set_value(std::nullopt);
+        } else {
+            decodeQueue.push_back(DecodeJob{std::move(data), std::move(job.engine), std::move(job.promise)});
+            decodeQueued.notify_one();
+        }
+    }
+}
+
+void TileExecutor::decode(size_t generation)
+{
+    std::unique_lock lk{lock};
+    const auto retired = [this, generation]() { return stopped || generation != this->generation; };
+
+    while (true) {
+        decodeQueued.wait(lk, [this, &retired]() { return retired() || !decodeQueue.empty(); });
+        if (retired()) {
+            return;
+        }
+
+        auto job = std::move(decodeQueue.front());
+        decodeQueue.pop_front();
+        decoding++;
+        lk.unlock();
+
+        try {
+            job.promise.set_value(job.engine->toImage(job.data));
+        } catch (const std::exception&) {
+            job.promise.set_value(std::nullopt);
+        }
+
+        lk.lock();
+        decoding--;
+    }
+}
+}
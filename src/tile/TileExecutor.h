@@ -0,0 +1,120 @@
+#ifndef SRC_TILE_TILE_EXECUTOR_H
+#define SRC_TILE_TILE_EXECUTOR_H
+
+#include "src/tile/TileSource.h"
+#include "src/tile/TileEngine.h"
+#include "src/tile/Util.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace tile {
+// Loads tiles on a fixed set of threads. The fetch workers request the raw data from the source and
+// hand it to the decode workers, so the number of transfers and decodes are limited separately
+// and no thread is created per tile.
+// Every map on the screen sets its own viewport under its key. Once any is set, the tiles in a
+// viewport are fetched first starting from its center, the ones just around it after them and the
+// ones out of all the viewports are dropped, including those already being fetched.
+class TileExecutor {
+public:
+    using Image = TileEngine::Image;
+    using ViewportKey = const void*;
+
+    struct Metrics {
+        size_t queuedFetches = 0;
+        size_t fetching = 0;
+        size_t queuedDecodes = 0;
+        size_t decoding = 0;
+        size_t dropped = 0;
+    };
+
+    TileExecutor(size_t fetchWorkers, size_t decodeWorkers);
+    ~TileExecutor();
+
+    TileExecutor(const TileExecutor&) = delete;
+    TileExecutor& operator=(const TileExecutor&) = delete;
+
+    std::future<std::optional<Image>> submit(const Coordinate& coord,
+                                             std::shared_ptr<TileSource> source,
+                                             std::shared_ptr<TileEngine> engine);
+
+    // Returns right away, it doesn't wait for a transfer. The replaced workers exit once they finish
+    // the tile they are on, until then there can be more transfers than the new limit.
+    void setConcurrency(size_t fetchWorkers, size_t decodeWorkers);
+    size_t getFetchWorkers() const noexcept { return fetchWorkers.size(); }
+    size_t getDecodeWorkers() const noexcept { return decodeWorkers.size(); }
+
+    // the tiles not started yet are dropped and resolved without an image
+    void clear();
+
+    void setViewport(ViewportKey key, const Viewport& viewport);
+    void removeViewport(ViewportKey key);
+
+    Metrics getMetrics() const;
+
+private:
+    struct FetchJob {
+        Coordinate coord;
+        std::shared_ptr<TileSource> source;
+        std::shared_ptr<TileEngine> engine;
+        std::promise<std::optional<Image>> promise;
+        double priority;
+        size_t order;
+    };
+
+    struct FetchingTile {
+        Coordinate coord;
+        std::shared_ptr<std::atomic_bool> canceled;
+    };
+
+    struct DecodeJob {
+        std::vector<std::byte> data;
+        std::shared_ptr<TileEngine> engine;
+        std::promise<std::optional<Image>> promise;
+    };
+
+    mutable std::mutex lock;
+    std::condition_variable fetchQueued;
+    std::condition_variable decodeQueued;
+    std::vector<FetchJob> fetchQueue;   // heap, the smallest priority is fetched first
+    std::deque<DecodeJob> decodeQueue;
+    std::map<size_t, FetchingTile> fetching;
+    size_t decoding = 0;
+    size_t dropped = 0;
+    size_t submitted = 0;
+    std::map<ViewportKey, Viewport> viewports;
+    bool stopped = false;
+    // bumped by setConcurrency, the workers started before exit
+    size_t generation = 0;
+
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<std::atomic_bool> exited;
+    };
+
+    std::vector<Worker> fetchWorkers;
+    std::vector<Worker> decodeWorkers;
+    // replaced but may still be on a tile, joined once they exited
+    std::vector<Worker> retiredWorkers;
+
+    std::optional<double> priorityOf(const Coordinate& coord) const noexcept;
+    std::vector<FetchJob> reprioritize();
+    void drop(std::vector<FetchJob>& jobs);
+    void start(size_t fetchWorkers, size_t decodeWorkers);
+    void stop();
+    void joinExited();
+    void fetch(size_t generation);
+    void decode(size_t generation);
+};
+}
+
+#endif
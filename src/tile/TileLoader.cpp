@@ -1,18 +1,24 @@
 #include "src/tile/TileLoader.h"
 #include "src/logger/LoggerManager.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <thread>
 
 namespace tile {
 constexpr int TILE_CACHE_SIZE = 256;
+// the defaults until they are changed in the tile source window,
+// most tile servers limit the connections of a client to 6 to 8
+constexpr size_t FETCH_WORKERS = 6;
 constexpr auto LOGGER_NAME = "TileLoader";
 
 using namespace std::chrono_literals;
 
 TileLoader::TileLoader():
     logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
-    cache{TILE_CACHE_SIZE}
+    cache{TILE_CACHE_SIZE},
+    executor{FETCH_WORKERS, std::max(1u, std::thread::hardware_concurrency() / 2)}
 {
 }
 
@@ -36,18 +42,11 @@ void TileLoader::request(const Coordinate& coord)
 
     if (!(futureData.contains(coord) || cache.contains(coord))) {
         logger.debug("Request tile at x={}, y={}, z={}", coord.x, coord.y, coord.z);
-        futureData.emplace(
-            std::make_pair(coord, std::async(std::launch::async, [coord, 
-                                                                  tileSource = this->tileSource,
-                                                                  tileEngine = this->tileEngine]() -> std::optional<tile::TileEngine::Image>
-                {
-                    if (const auto& data = tileSource->request(coord); data.empty()) {
-                        return std::nullopt;
-                    } else {
-                        return tileEngine->toImage(data);
-                    }
-                }))
-        );
+        futureData.emplace(coord, executor.submit(coord, tileSource, tileEngine));
+
+        const auto metrics = executor.getMetrics();
+        logger.trace("Tile executor queued fetches={}, fetching={}, queued decodes={}, decoding={}",
+                     metrics.queuedFetches, metrics.fetching, metrics.queuedDecodes, metrics.decoding);
     }
 }
 
@@ -65,6 +64,19 @@ void TileLoader::load(const Coordinate& coord)
     }
 }
 
+void TileLoader::setViewport(TileExecutor::ViewportKey key, const Viewport& viewport)
+{
+    executor.setViewport(key, viewport);
+
+    // the tiles out of the view are not polled by loadTile, take the ones finished or dropped
+    for (auto it = futureData.begin(); it != futureData.end();) {
+        const auto coord = (it++)->first;
+        if (!viewport.contains(coord)) {
+            load(coord);
+        }
+    }
+}
+
 std::optional<std::shared_ptr<Tile>> TileLoader::loadTile(const Coordinate& coord)
 {
     request(coord);
@@ -99,6 +111,7 @@ void TileLoader::clearCache()
     }
     
     cache.reset();
+    executor.clear();
     futureData.clear();
 
     if (this->tileSource) {
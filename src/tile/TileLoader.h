@@ -5,6 +5,7 @@
 #include "src/tile/Tile.h"
 #include "src/tile/Util.h"
 #include "src/tile/TileEngine.h"
+#include "src/tile/TileExecutor.h"
 #include "src/util/Cache.h"
 #include "src/logger/ModuleLogger.h"
 
@@ -28,6 +29,16 @@ public:
     std::optional<std::shared_ptr<Tile>> loadTile(const Coordinate& coord);
     void clearCache();
 
+    // called every frame by each map before loading the tiles of it, the key tells the maps apart
+    void setViewport(TileExecutor::ViewportKey key, const Viewport& viewport);
+    void removeViewport(TileExecutor::ViewportKey key) { executor.removeViewport(key); }
+
+    // set from the tile source window, it doesn't wait for the transfers in progress
+    void setConcurrency(size_t fetchWorkers, size_t decodeWorkers) { executor.setConcurrency(fetchWorkers, decodeWorkers); }
+    size_t getFetchWorkers() const noexcept { return executor.getFetchWorkers(); }
+    size_t getDecodeWorkers() const noexcept { return executor.getDecodeWorkers(); }
+    TileExecutor::Metrics getMetrics() const { return executor.getMetrics(); }
+
 private:
     TileLoader();
 
@@ -36,6 +47,7 @@ private:
     std::shared_ptr<TileEngine> tileEngine;
     util::Cache<Coordinate, std::shared_ptr<Tile>> cache;
     std::map<Coordinate, std::future<std::optional<tile::TileEngine::Image>>> futureData;
+    TileExecutor executor;
 
     void request(const Coordinate& coord);
     void load(const Coordinate& coord);
@@ -0,0 +1,302 @@
+#include "src/tile/TileSeeder.h"
+#include "src/persistence/SqliteStatement.h"
+#include "src/logger/LoggerManager.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <span>
+
+namespace tile {
+constexpr auto LOGGER_NAME = "TileSeeder";
+// the tiles are written in transactions of the size, at most a batch is downloaded again on resume
+constexpr size_t COMMIT_BATCH = 64;
+constexpr size_t MIN_WORKERS = 1;
+
+// https://github.com/mapbox/mbtiles-spec/blob/master/1.3/spec.md, the default journal keeps it a single file
+constexpr auto CREATE_METADATA = "CREATE TABLE IF NOT EXISTS metadata (name TEXT, value TEXT)";
+constexpr auto CREATE_TILES = "CREATE TABLE IF NOT EXISTS tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)";
+constexpr auto CREATE_TILE_INDEX = "CREATE UNIQUE INDEX IF NOT EXISTS tile_index ON tiles (zoom_level, tile_column, tile_row)";
+constexpr auto INSERT_NAME = "INSERT INTO metadata (name, value) SELECT 'name', ?1 WHERE NOT EXISTS (SELECT 1 FROM metadata WHERE name = 'name')";
+constexpr auto CONTAINS_TILE = "SELECT 1 FROM tiles WHERE zoom_level = ?1 AND tile_column = ?2 AND tile_row = ?3";
+constexpr auto INSERT_TILE = "INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?1, ?2, ?3, ?4)";
+
+namespace {
+// the rows of MBTiles are in the TMS scheme, which counts from the south
+int tmsRow(const Coordinate& coord)
+{
+    return (1 << coord.z) - 1 - coord.y;
+}
+}
+
+TileSeeder::TileSeeder(const std::string& path, std::shared_ptr<TileSource> source, const Options& options):
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
+    path{path},
+    source{std::move(source)},
+    options{options}
+{
+}
+
+TileSeeder::~TileSeeder()
+{
+    stop();
+}
+
+util::Expected<void> TileSeeder::start(const std::vector<Viewport>& ranges)
+{
+    if (running) {
+        return util::Unexpected{util::Error{util::ErrorCode::INVALID_PARAM, "The seeding is running"}};
+    }
+
+    // the workers of the last seed are finished but not joined yet
+    wait();
+
+    if (auto ret = open(); !ret) {
+        return ret;
+    }
+
+    this->ranges.clear();
+    std::copy_if(ranges.begin(), ranges.end(), std::back_inserter(this->ranges), [](const Viewport& range) {
+        return range.xMin <= range.xMax && range.yMin <= range.yMax;
+    });
+
+    size_t tiles = 0;
+    for (const auto& range : this->ranges) {
+        tiles += static_cast<size_t>(range.xMax - range.xMin + 1) * static_cast<size_t>(range.yMax - range.yMin + 1);
+    }
+
+    rangeIdx = 0;
+    if (!this->ranges.empty()) {
+        next = Coordinate{this->ranges.front().xMin, this->ranges.front().yMin, this->ranges.front().zoom};
+    }
+
+    total = tiles;
+    stored = 0;
+    skipped = 0;
+    failed = 0;
+    canceled = false;
+    nextRequest = std::chrono::steady_clock::now();
+
+    const auto concurrency = std::max(options.concurrency, MIN_WORKERS);
+    logger.info("Seed {} tiles into {} with {} workers at {} requests per second", tiles, path, concurrency, options.requestsPerSecond);
+
+    running = true;
+    remainingWorkers = concurrency;
+    for (size_t i = 0; i < concurrency; i++) {
+        workers.emplace_back([this]() { work(); });
+    }
+
+    return util::SUCCESS;
+}
+
+void TileSeeder::stop()
+{
+    {
+        // the waiting worker checks the flag under the lock, so it can't miss the notification
+        std::scoped_lock lk{rateLock};
+        canceled = true;
+    }
+    stopped.notify_all();
+
+    wait();
+}
+
+void TileSeeder::wait()
+{
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    workers.clear();
+}
+
+TileSeeder::Progress TileSeeder::getProgress() const noexcept
+{
+    return {total, stored, skipped, failed};
+}
+
+util::Expected<void> TileSeeder::open()
+{
+    if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        const std::string error = sqlite3_errmsg(db);
+        logger.error("Failed to open {}, error: {}", path, error);
+        sqlite3_close_v2(db);
+        db = nullptr;
+        return util::Unexpected{util::Error{util::ErrorCode::DATABASE_ERROR, error}};
+    }
+
+    try {
+        persistence::SqliteStatement{db, CREATE_METADATA}.execute();
+        persistence::SqliteStatement{db, CREATE_TILES}.execute();
+        persistence::SqliteStatement{db, CREATE_TILE_INDEX}.execute();
+        persistence::SqliteStatement{db, INSERT_NAME}.bindText(1, std::filesystem::u8path(path).stem().string()).execute();
+
+        containsStatement = std::make_unique<persistence::SqliteStatement>(db, CONTAINS_TILE);
+        insertStatement = std::make_unique<persistence::SqliteStatement>(db, INSERT_TILE);
+    } catch (const std::exception& e) {
+        logger.error("Failed to initialize {}, error: {}", path, e.what());
+        close();
+        return util::Unexpected{util::Error{util::ErrorCode::DATABASE_ERROR, e.what()}};
+    }
+
+    uncommitted = 0;
+
+    return util::SUCCESS;
+}
+
+void TileSeeder::close()
+{
+    containsStatement.reset();
+    insertStatement.reset();
+
+    if (db) {
+        sqlite3_close_v2(db);
+        db = nullptr;
+    }
+}
+
+bool TileSeeder::nextTile(Coordinate& coord)
+{
+    std::scoped_lock lk{rangeLock};
+
+    while (rangeIdx < ranges.size()) {
+        const auto& range = ranges[rangeIdx];
+        if (next.y > range.yMax) {
+            next.y = range.yMin;
+            next.x++;
+        }
+
+        if (next.x > range.xMax) {
+            if (++rangeIdx < ranges.size()) {
+                next = Coordinate{ranges[rangeIdx].xMin, ranges[rangeIdx].yMin, ranges[rangeIdx].zoom};
+            }
+            continue;
+        }
+
+        coord = next;
+        next.y++;
+        return true;
+    }
+
+    return false;
+}
+
+// the requests are given evenly spaced time slots, returns false if stopped while waiting for one
+bool TileSeeder::waitForRate()
+{
+    std::unique_lock lk{rateLock};
+    if (options.requestsPerSecond <= 0) {
+        return !canceled;
+    }
+
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>{1.0 / options.requestsPerSecond});
+    const auto slot = std::max(std::chrono::steady_clock::now(), nextRequest);
+    nextRequest = slot + interval;
+
+    return !stopped.wait_until(lk, slot, [this]() { return canceled.load(); });
+}
+
+bool TileSeeder::contains(const Coordinate& coord)
+{
+    std::scoped_lock lk{dbLock};
+
+    try {
+        const bool found = containsStatement->bindInt(1, coord.z).bindInt(2, coord.x).bindInt(3, tmsRow(coord)).step();
+        containsStatement->reset();
+        return found;
+    } catch (const std::exception& e) {
+        logger.error("Failed to look up tile x={}, y={}, z={} in {}, error: {}", coord.x, coord.y, coord.z, path, e.what());
+        containsStatement->reset();
+        return false;
+    }
+}
+
+bool TileSeeder::store(const Coordinate& coord, const std::vector<std::byte>& data)
+{
+    std::scoped_lock lk{dbLock};
+
+    try {
+        if (uncommitted == 0) {
+            persistence::SqliteStatement{db, "BEGIN"}.execute();
+        }
+
+        const std::span bytes{reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+        insertStatement->bindInt(1, coord.z).bindInt(2, coord.x).bindInt(3, tmsRow(coord)).bindBlob(4, bytes).execute();
+
+        if (++uncommitted >= COMMIT_BATCH) {
+            commit();
+        }
+
+        return true;
+    } catch (const std::exception& e) {
+        logger.error("Failed to store tile x={}, y={}, z={} in {}, error: {}", coord.x, coord.y, coord.z, path, e.what());
+        insertStatement->reset();
+        return false;
+    }
+}
+
+// called with the dbLock held
+void TileSeeder::commit()
+{
+    if (uncommitted == 0) {
+        return;
+    }
+
+    persistence::SqliteStatement{db, "COMMIT"}.execute();
+    uncommitted = 0;
+}
+
+void TileSeeder::work()
+{
+    Coordinate coord;
+
+    while (!canceled && nextTile(coord)) {
+        if (contains(coord)) {
+            skipped++;
+            continue;
+        }
+
+        if (!waitForRate()) {
+            break;
+        }
+
+        std::vector<std::byte> data;
+        try {
+            data = source->request(coord, canceled);
+        } catch (const std::exception& e) {
+            logger.error("Failed to request tile x={}, y={}, z={}, error: {}", coord.x, coord.y, coord.z, e.what());
+        }
+
+        if (canceled) {
+            break;
+        }
+
+        if (data.empty() || !store(coord, data)) {
+            logger.debug("Failed to seed tile x={}, y={}, z={}", coord.x, coord.y, coord.z);
+            failed++;
+        } else {
+            stored++;
+        }
+    }
+
+    // the last worker writes the rest and closes the file
+    if (--remainingWorkers == 0) {
+        {
+            std::scoped_lock lk{dbLock};
+            try {
+                commit();
+            } catch (const std::exception& e) {
+                logger.error("Failed to commit the tiles to {}, error: {}", path, e.what());
+            }
+            close();
+        }
+
+        logger.info("Seeding {} {}, stored {}, skipped {}, failed {} of {} tiles",
+                    path, canceled ? "stopped" : "finished", stored.load(), skipped.load(), failed.load(), total.load());
+        running = false;
+    }
+}
+}
@@ -0,0 +1,101 @@
+#ifndef SRC_TILE_TILE_SEEDER_H
+#define SRC_TILE_TILE_SEEDER_H
+
+#include "src/tile/TileSource.h"
+#include "src/tile/Util.h"
+#include "src/util/Error.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct sqlite3;
+
+namespace persistence {
+class SqliteStatement;
+}
+
+namespace tile {
+// Downloads every tile of the given ranges into a MBTiles file, which is read back by
+// TileSourceMBTiles. The tiles already in the file are skipped, so a stopped or failed seed is
+// resumed by starting it again on the same file.
+class TileSeeder {
+public:
+    struct Options {
+        size_t concurrency = 2;
+        double requestsPerSecond = 2.0;     // not limited if not positive
+    };
+
+    struct Progress {
+        size_t total = 0;
+        size_t stored = 0;
+        size_t skipped = 0;     // already in the file
+        size_t failed = 0;
+
+        size_t finished() const noexcept { return stored + skipped + failed; }
+    };
+
+    TileSeeder(const std::string& path, std::shared_ptr<TileSource> source, const Options& options);
+    ~TileSeeder();
+
+    TileSeeder(const TileSeeder&) = delete;
+    TileSeeder& operator=(const TileSeeder&) = delete;
+
+    util::Expected<void> start(const std::vector<Viewport>& ranges);
+    // the tiles stored so far are kept
+    void stop();
+    void wait();
+    bool isRunning() const noexcept { return running; }
+
+    Progress getProgress() const noexcept;
+
+private:
+    logger::ModuleLogger logger;
+    std::string path;
+    std::shared_ptr<TileSource> source;
+    Options options;
+
+    sqlite3* db = nullptr;
+    std::unique_ptr<persistence::SqliteStatement> containsStatement;
+    std::unique_ptr<persistence::SqliteStatement> insertStatement;
+    std::mutex dbLock;
+    size_t uncommitted = 0;
+
+    // the tiles are handed out range by range, column by column
+    std::mutex rangeLock;
+    std::vector<Viewport> ranges;
+    size_t rangeIdx = 0;
+    Coordinate next;
+
+    std::mutex rateLock;
+    std::condition_variable stopped;
+    std::chrono::steady_clock::time_point nextRequest;
+
+    std::atomic_bool canceled = false;
+    std::atomic_bool running = false;
+    std::atomic<size_t> remainingWorkers = 0;
+    std::atomic<size_t> total = 0;
+    std::atomic<size_t> stored = 0;
+    std::atomic<size_t> skipped = 0;
+    std::atomic<size_t> failed = 0;
+    std::vector<std::thread> workers;
+
+    util::Expected<void> open();
+    void close();
+    bool nextTile(Coordinate& coord);
+    bool waitForRate();
+    bool contains(const Coordinate& coord);
+    bool store(const Coordinate& coord, const std::vector<std::byte>& data);
+    void commit();
+    void work();
+};
+}
+
+#endif
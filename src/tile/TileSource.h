@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 
 namespace tile {
 
@@ -13,7 +14,8 @@ class TileSource {
 public:
     virtual ~TileSource() = default;
 
-    virtual std::vector<std::byte> request(const Coordinate& coord) = 0;
+    // canceled is set once the tile is not needed anymore, the request should give up as soon as it can
+    virtual std::vector<std::byte> request(const Coordinate& coord, const std::atomic_bool& canceled) = 0;
     virtual void stop() = 0;
     virtual void restart() = 0;
 };
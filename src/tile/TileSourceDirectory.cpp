@@ -0,0 +1,72 @@
+#include "TileSourceDirectory.h"
+#include "src/logger/LoggerManager.h"
+
+#include <array>
+#include <fstream>
+#include <optional>
+
+namespace tile {
+constexpr auto LOGGER_NAME = "TileSourceDirectory";
+constexpr std::array TILE_EXTENSIONS{".png", ".jpg", ".jpeg"};
+
+namespace {
+// A tile is a few KB, a plain read costs less than mapping and unmapping the file.
+std::optional<std::vector<std::byte>> readFile(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+        return std::nullopt;
+    }
+
+    return data;
+}
+}
+
+TileSourceDirectory::TileSourceDirectory(const std::string& root):
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
+    root{std::filesystem::u8path(root)}
+{
+    std::error_code error;
+    open = std::filesystem::is_directory(this->root, error);
+
+    if (open) {
+        logger.info("Open tile directory {}", root);
+    } else {
+        logger.error("{} is not a directory", root);
+    }
+}
+
+std::vector<std::byte> TileSourceDirectory::request(const Coordinate& coord, const std::atomic_bool& canceled)
+{
+    if (!run || canceled || !open) {
+        return {};
+    }
+
+    const auto directory = root / std::to_string(coord.z) / std::to_string(coord.x);
+    for (const auto extension : TILE_EXTENSIONS) {
+        if (auto data = readFile(directory / (std::to_string(coord.y) + extension)); data) {
+            return std::move(*data);
+        }
+    }
+
+    logger.debug("Tile x={}, y={}, z={} not found in {}", coord.x, coord.y, coord.z, root.string());
+
+    return {};
+}
+
+void TileSourceDirectory::stop()
+{
+    run = false;
+}
+
+void TileSourceDirectory::restart()
+{
+    run = true;
+}
+}
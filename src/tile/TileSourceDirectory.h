@@ -0,0 +1,32 @@
+#ifndef SRC_TILE_TILE_SOURCE_DIRECTORY_H
+#define SRC_TILE_TILE_SOURCE_DIRECTORY_H
+
+#include "TileSource.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace tile {
+// Reads the tiles from a {z}/{x}/{y}.png directory tree, e.g. the one exported by the tile tools.
+class TileSourceDirectory: public TileSource {
+public:
+    explicit TileSourceDirectory(const std::string& root);
+
+    std::vector<std::byte> request(const Coordinate& coord, const std::atomic_bool& canceled) override;
+    void stop() override;
+    void restart() override;
+
+    bool isOpen() const noexcept { return open; }
+
+private:
+    logger::ModuleLogger logger;
+    std::filesystem::path root;
+    bool open = false;
+    std::atomic_bool run = true;
+};
+}
+
+#endif
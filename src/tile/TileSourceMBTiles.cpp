@@ -0,0 +1,113 @@
+#include "TileSourceMBTiles.h"
+#include "src/persistence/SqliteStatement.h"
+#include "src/logger/LoggerManager.h"
+
+#include <sqlite3.h>
+
+namespace tile {
+constexpr auto LOGGER_NAME = "TileSourceMBTiles";
+constexpr auto MMAP_SIZE = "PRAGMA mmap_size = 1073741824";
+constexpr auto SELECT_TILE = "SELECT tile_data FROM tiles WHERE zoom_level = ?1 AND tile_column = ?2 AND tile_row = ?3";
+
+struct TileSourceMBTiles::Connection {
+    sqlite3* db = nullptr;
+    std::unique_ptr<persistence::SqliteStatement> select;
+
+    ~Connection()
+    {
+        select.reset();
+        sqlite3_close_v2(db);
+    }
+};
+
+TileSourceMBTiles::TileSourceMBTiles(const std::string& path):
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
+    path{path}
+{
+    // opened once to tell if it is a MBTiles file
+    if (auto connection = acquire(); connection) {
+        open = true;
+        release(std::move(connection));
+        logger.info("Open MBTiles {}", path);
+    }
+}
+
+TileSourceMBTiles::~TileSourceMBTiles() = default;
+
+std::vector<std::byte> TileSourceMBTiles::request(const Coordinate& coord, const std::atomic_bool& canceled)
+{
+    if (!run || canceled) {
+        return {};
+    }
+
+    auto connection = acquire();
+    if (!connection) {
+        return {};
+    }
+
+    std::vector<std::byte> data;
+    try {
+        // the rows of MBTiles are in the TMS scheme, which counts from the south
+        connection->select->bindInt(1, coord.z).bindInt(2, coord.x).bindInt(3, (1 << coord.z) - 1 - coord.y);
+        if (connection->select->step()) {
+            const auto blob = connection->select->getBlob(0);
+            const auto bytes = reinterpret_cast<const std::byte*>(blob.data());
+            data.assign(bytes, bytes + blob.size());
+        } else {
+            logger.debug("Tile x={}, y={}, z={} not found in {}", coord.x, coord.y, coord.z, path);
+        }
+        connection->select->reset();
+    } catch (const std::exception& e) {
+        logger.error("Failed to read tile x={}, y={}, z={} from {}, error: {}", coord.x, coord.y, coord.z, path, e.what());
+        connection->select->reset();
+    }
+
+    release(std::move(connection));
+
+    return data;
+}
+
+void TileSourceMBTiles::stop()
+{
+    run = false;
+}
+
+void TileSourceMBTiles::restart()
+{
+    run = true;
+}
+
+std::unique_ptr<TileSourceMBTiles::Connection> TileSourceMBTiles::acquire()
+{
+    {
+        std::scoped_lock lk{lock};
+        if (!idle.empty()) {
+            auto connection = std::move(idle.back());
+            idle.pop_back();
+            return connection;
+        }
+    }
+
+    auto connection = std::make_unique<Connection>();
+    if (sqlite3_open_v2(path.c_str(), &connection->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        logger.error("Failed to open MBTiles {}, error: {}", path, sqlite3_errmsg(connection->db));
+        return nullptr;
+    }
+
+    try {
+        persistence::SqliteStatement{connection->db, MMAP_SIZE}.execute();
+        connection->select = std::make_unique<persistence::SqliteStatement>(connection->db, SELECT_TILE);
+    } catch (const std::exception& e) {
+        logger.error("{} is not a MBTiles file, error: {}", path, e.what());
+        return nullptr;
+    }
+
+    return connection;
+}
+
+void TileSourceMBTiles::release(std::unique_ptr<Connection> connection)
+{
+    std::scoped_lock lk{lock};
+    idle.emplace_back(std::move(connection));
+}
+}
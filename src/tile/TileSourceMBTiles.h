@@ -0,0 +1,49 @@
+#ifndef SRC_TILE_TILE_SOURCE_MBTILES_H
+#define SRC_TILE_TILE_SOURCE_MBTILES_H
+
+#include "TileSource.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace persistence {
+class SqliteStatement;
+}
+
+namespace tile {
+// Reads the tiles from an MBTiles file, https://github.com/mapbox/mbtiles-spec. Every fetch worker
+// gets its own read-only connection. SQLite maps the file so the pages are not copied into its page
+// cache, the blob of a tile is still copied once as the tile engines take an owned vector.
+class TileSourceMBTiles: public TileSource {
+public:
+    explicit TileSourceMBTiles(const std::string& path);
+    ~TileSourceMBTiles() override;
+
+    std::vector<std::byte> request(const Coordinate& coord, const std::atomic_bool& canceled) override;
+    void stop() override;
+    void restart() override;
+
+    bool isOpen() const noexcept { return open; }
+
+private:
+    struct Connection;
+
+    logger::ModuleLogger logger;
+    std::string path;
+    bool open = false;
+    std::atomic_bool run = true;
+    std::mutex lock;
+    std::vector<std::unique_ptr<Connection>> idle;
+
+    std::unique_ptr<Connection> acquire();
+    void release(std::unique_ptr<Connection> connection);
+};
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include <string_view>
 #include <string>
 #include <regex>
+#include <algorithm>
 
 // proxy
 #ifdef __APPLE__
@@ -32,6 +33,14 @@ constexpr std::string_view X_MATCHER = "{x}";
 constexpr std::string_view Y_MATCHER = "{y}";
 constexpr auto MATCHER_LEN = 3;
 constexpr auto LOGGER_NAME = "TileSourceUrl";
+constexpr auto ETAG_HEADER = "ETag:";
+constexpr auto LAST_MODIFIED_HEADER = "Last-Modified:";
+constexpr auto IF_NONE_MATCH_HEADER = "If-None-Match:";
+constexpr auto IF_MODIFIED_SINCE_HEADER = "If-Modified-Since:";
+constexpr long HTTP_NOT_MODIFIED = 304;
+constexpr long HTTP_BAD_REQUEST = 400;
+// the cached tiles are used without asking the server within it
+constexpr auto CACHE_FRESHNESS = std::chrono::seconds{7 * 24 * 60 * 60};
 
 namespace {
 constexpr int MAX_IP_TEXTUAL_REPRESENTATION = 40;   // ipv6 with a NULL terminator
@@ -132,25 +141,71 @@ size_t curlCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
     return nmemb;
 }
 
+// the source is stopped or the tile is not needed anymore
+struct Cancellation {
+    const std::atomic_bool& run;
+    const std::atomic_bool& canceled;
+
+    bool isCanceled() const noexcept { return !run || canceled; }
+};
+
 size_t progressCallback(void *clientp,
                         curl_off_t dltotal,
                         curl_off_t dlnow,
                         curl_off_t ultotal,
                         curl_off_t ulnow)
 {
-    auto run = reinterpret_cast<std::atomic_bool*>(clientp);
-    if (!run->load()) { 
+    auto cancellation = reinterpret_cast<const Cancellation*>(clientp);
+    if (cancellation->isCanceled()) { 
         return STOP;
     }
 
     return CURL_PROGRESSFUNC_CONTINUE; /* all is good */
 }
 
-util::Expected<std::vector<std::byte>> requestData(const std::string& url, 
-                                                   const std::string& proxy, 
-                                                   std::atomic_bool& stop)
-{
+struct Response {
+    long status = 0;
     std::vector<std::byte> data;
+    std::string etag;
+    std::string lastModified;
+};
+
+size_t headerCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    auto response = reinterpret_cast<Response*>(userdata);
+    std::string_view header{buffer, nitems};
+    const auto value = [header](std::string_view name) -> std::optional<std::string> {
+        if (header.size() <= name.size() || 
+            !std::equal(name.cbegin(), name.cend(), header.cbegin(), [](char a, char b) { return ::tolower(a) == ::tolower(b); })) {
+            return std::nullopt;
+        }
+
+        auto value = header.substr(name.size());
+        value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+        value.remove_suffix(value.size() - std::min(value.find_last_not_of(" \r\n") + 1, value.size()));
+        return std::string{value};
+    };
+
+    if (header.starts_with("HTTP/")) {
+        // a new response after a redirection
+        response->etag.clear();
+        response->lastModified.clear();
+    } else if (auto etag = value(ETAG_HEADER); etag) {
+        response->etag = std::move(*etag);
+    } else if (auto lastModified = value(LAST_MODIFIED_HEADER); lastModified) {
+        response->lastModified = std::move(*lastModified);
+    }
+
+    return nitems;
+}
+
+// the cached etag and last modified are sent to only get the data if it is changed
+util::Expected<Response> requestData(const std::string& url, 
+                                     const std::string& proxy, 
+                                     const Cancellation& cancellation,
+                                     const std::optional<TileDiskCache::Entry>& cached)
+{
+    Response response;
 
     std::string certificatePath = util::getExecutablePath().remove_filename().string() + CERTIFICATE_NAME;
 
@@ -158,11 +213,13 @@ util::Expected<std::vector<std::byte>> requestData(const std::string& url,
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, SHUT_OFF_THE_PROGRESS_METER);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "curl/8.8.0");
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, reinterpret_cast<void*>(&data));
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, reinterpret_cast<void*>(&response.data));
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, reinterpret_cast<void*>(&response));
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, ENABLE);
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, DISABLE); // enable progress callback getting called
-    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &stop);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &cancellation);
     curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
 
 #ifdef _WIN32
@@ -175,11 +232,30 @@ util::Expected<std::vector<std::byte>> requestData(const std::string& url,
         curl_easy_setopt(curl, CURLOPT_PROXY, proxy.c_str());
     }
 
+    curl_slist* headers = nullptr;
+    if (cached) {
+        if (!cached->etag.empty()) {
+            headers = curl_slist_append(headers, (std::string{IF_NONE_MATCH_HEADER} + " " + cached->etag).c_str());
+        }
+
+        if (!cached->lastModified.empty()) {
+            headers = curl_slist_append(headers, (std::string{IF_MODIFIED_SINCE_HEADER} + " " + cached->lastModified).c_str());
+        }
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
     const auto res = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
     curl_easy_cleanup(curl);
+    curl_slist_free_all(headers);
 
     if (res == CURLE_OK) {
-        return data;
+        // the file scheme has no status
+        if (response.status >= HTTP_BAD_REQUEST) {
+            return util::Unexpected{util::ErrorCode::NETWORK_ERROR, "HTTP status " + std::to_string(response.status)};
+        }
+
+        return response;
     } else {
         if (res == CURLE_ABORTED_BY_CALLBACK) {
             return util::Unexpected{util::ErrorCode::OPERATION_CANCELED, curl_easy_strerror(res)};
@@ -188,30 +264,55 @@ util::Expected<std::vector<std::byte>> requestData(const std::string& url,
         return util::Unexpected{util::ErrorCode::NETWORK_ERROR, curl_easy_strerror(res)};
     }
 }
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
 }
 
-TileSourceUrl::TileSourceUrl(const std::string& url):
+TileSourceUrl::TileSourceUrl(const std::string& url, std::shared_ptr<TileDiskCache> cache):
+    cache{std::move(cache)},
     logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)}
 {
     curl_global_init(CURL_GLOBAL_DEFAULT);
     setUrl(url);
 }
 
-std::vector<std::byte> TileSourceUrl::request(const Coordinate& coord)
+std::vector<std::byte> TileSourceUrl::request(const Coordinate& coord, const std::atomic_bool& canceled)
 {
-    const auto proxys = getProxySettings(logger);
     const auto url = makeUrl(coord);
+    const auto source = this->url;
+
+    auto cached = cache ? cache->find(source, coord) : std::nullopt;
+    if (cached && now() - cached->validated < CACHE_FRESHNESS.count()) {
+        logger.debug("Tile {} found in cache", url);
+        return std::move(cached->data);
+    }
+
+    const auto proxys = getProxySettings(logger);
+    const Cancellation cancellation{run, canceled};
 
     for (const auto& proxy : proxys) {
-        if (!run) {
-            logger.debug("Current TileSourceUrl object is stopped, stop request.");
+        if (cancellation.isCanceled()) {
+            logger.debug("Current TileSourceUrl object is stopped or the tile is canceled, stop request.");
             return {};
         }
 
         logger.debug("Request {} using proxy: {}", url, proxy.empty()? "no proxy": proxy);
-        if (const auto& ret = requestData(url, proxy, run); ret) {
+        if (auto&& ret = requestData(url, proxy, cancellation, cached); ret) {
+            if (cached && ret->status == HTTP_NOT_MODIFIED) {
+                logger.debug("Tile {} in cache is not modified", url);
+                cache->revalidate(source, coord, now());
+                return std::move(cached->data);
+            }
+
             logger.debug("CURL get success for url {}", url);
-            return ret.value();
+            if (cache && !ret->data.empty()) {
+                cache->store(source, coord, TileDiskCache::Entry{ret->data, ret->etag, ret->lastModified, now()});
+            }
+
+            return std::move(ret->data);
         } else {
             if (ret.error().code == util::ErrorCode::OPERATION_CANCELED) {
                 logger.debug("Request {} canceled", url);
@@ -221,6 +322,12 @@ std::vector<std::byte> TileSourceUrl::request(const Coordinate& coord)
         }
     }
 
+    // better an outdated tile than none when offline
+    if (cached && !cancellation.isCanceled()) {
+        logger.debug("Use the outdated tile {} in cache", url);
+        return std::move(cached->data);
+    }
+
     return {};
 }
 
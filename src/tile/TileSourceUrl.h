@@ -2,21 +2,24 @@
 #define SRC_TILE_TILE_SOURCE_URL_H
 
 #include "TileSource.h"
+#include "src/tile/TileDiskCache.h"
 #include "src/logger/ModuleLogger.h"
 
 #include <string>
 #include <future>
 #include <cstddef>
 #include <atomic>
+#include <memory>
 
 namespace tile {
 
 class TileSourceUrl: public TileSource {
 public:
-    TileSourceUrl(const std::string& url);
+    // the tiles are kept in the cache and only requested again once they are outdated
+    TileSourceUrl(const std::string& url, std::shared_ptr<TileDiskCache> cache = nullptr);
     ~TileSourceUrl() override = default;
 
-    std::vector<std::byte> request(const Coordinate& coord) override;
+    std::vector<std::byte> request(const Coordinate& coord, const std::atomic_bool& canceled) override;
     void stop() override;
     void restart() override;
 
@@ -25,6 +28,7 @@ public:
 private:
     std::string url;
     std::atomic_bool run = true;
+    std::shared_ptr<TileDiskCache> cache;
 
     logger::ModuleLogger logger;
     const std::string makeUrl(const Coordinate& coord);
@@ -11,6 +11,24 @@ struct Coordinate {
 
     auto operator<=>(const Coordinate& other) const noexcept = default;
 };
+
+// The tiles covered by the map at the zoom level being shown
+struct Viewport {
+    int zoom = 0;
+    int xMin = 0;
+    int xMax = 0;
+    int yMin = 0;
+    int yMax = 0;
+
+    bool contains(const Coordinate& coord, int margin = 0) const noexcept
+    {
+        return coord.z == zoom &&
+               coord.x >= xMin - margin && coord.x <= xMax + margin &&
+               coord.y >= yMin - margin && coord.y <= yMax + margin;
+    }
+
+    bool operator==(const Viewport& other) const noexcept = default;
+};
 }
 
 #endif
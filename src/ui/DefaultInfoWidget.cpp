@@ -163,7 +163,7 @@ void DefaultInfoWidget::displayCountryInfos()
     }
 }
 
-void DefaultInfoWidget::displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour)
+void DefaultInfoWidget::displayCountry(const std::string& name, const persistence::Contour& contour)
 {
     if (ImGui::TreeNode((name + "##country").c_str())) {
         int idx = 0;
@@ -336,6 +336,9 @@ void DefaultInfoWidget::savePopupWindow()
 void DefaultInfoWidget::saveProgressPopUp()
 {
     if (ImGui::BeginPopupModal(PROGRESS_POPUP_WINDOW_NAME)) {
+        if (databaseSaverPresenter.isSaveComplete()) {
+            textFailedYears(databaseSaverPresenter.getFailedYears());
+        }
         simpleProgressDisplayer(databaseSaverPresenter.getProgress(),
                                 gettext("Done"),
                                 databaseSaverPresenter.isSaveComplete(),
@@ -350,10 +353,7 @@ void DefaultInfoWidget::updateCountryResources()
         countryResourceUpdated = false;
         countries.clear();
         for (const auto& country : infoPresenter.handleRequestCountryList()) {
-            countries.emplace(std::make_pair(country, std::vector<persistence::Coordinate>{}));
-            for (const auto& coord : infoPresenter.handleRequestContour(country)) {
-                countries[country].emplace_back(coord);
-            }
+            countries.emplace(country, infoPresenter.handleRequestContour(country));
         }
     }
 }
@@ -40,7 +40,7 @@ private:
     std::map<std::string, std::pair<std::string, std::string>> countryNewCoordinateCache;
     std::string newCityName, newCityLatitude, newCityLongitude;
     std::atomic_bool countryResourceUpdated = false;
-    std::map<std::string, std::vector<persistence::Coordinate>> countries;
+    std::map<std::string, persistence::Contour> countries;
     std::atomic_bool cityResourceUpdated = false;
     std::map<std::string, persistence::Coordinate> cities;
     std::atomic_bool noteResourceUpdated = false;
@@ -55,7 +55,7 @@ private:
     void saveInfoRange(int startYear, int endYear);
     void savePopupWindow();
     void saveProgressPopUp();
-    void displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour);
+    void displayCountry(const std::string& name, const persistence::Contour& contour);
     void displayCity(const std::string& name, const persistence::Coordinate& coord);
     persistence::Coordinate displayCoordinate(const std::string& uniqueId, const persistence::Coordinate& coord);
 
@@ -124,7 +124,7 @@ void ExportInfoWidget::displayCoordinate(const std::string& uniqueId, const pers
     ImGui::PopID();
 }
 
-void ExportInfoWidget::displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour)
+void ExportInfoWidget::displayCountry(const std::string& name, const persistence::Contour& contour)
 {
     bool select = selectAll || infoSelectorPresenter.handkeCheckIsCountrySelected(name);
     if (ImGui::Checkbox(("##country" + name).c_str(), &select)) {
@@ -351,10 +351,7 @@ void ExportInfoWidget::updateCountryResources()
         countryResourceUpdated = false;
         countries.clear();
         for (const auto& country : infoPresenter.handleRequestCountryList()) {
-            countries.emplace(std::make_pair(country, std::vector<persistence::Coordinate>{}));
-            for (const auto& coord : infoPresenter.handleRequestContour(country)) {
-                countries[country].emplace_back(coord);
-            }
+            countries.emplace(country, infoPresenter.handleRequestContour(country));
         }
     }
 }
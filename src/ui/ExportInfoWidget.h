@@ -43,7 +43,7 @@ private:
     bool processMultiYearSelection = false;
     bool processMultiYearSelectionComplete = false;
     std::atomic_bool countryResourceUpdated = false;
-    std::map<std::string, std::vector<persistence::Coordinate>> countries;
+    std::map<std::string, persistence::Contour> countries;
     std::atomic_bool cityResourceUpdated = false;
     std::map<std::string, persistence::Coordinate> cities;
     std::atomic_bool noteResourceUpdated = false;
@@ -51,7 +51,7 @@ private:
     std::atomic_bool needUpdateSelectAll = false;
 
     void displayYearControlSection();
-    void displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour);
+    void displayCountry(const std::string& name, const persistence::Contour& contour);
     void displayCity(const std::string& name, const persistence::Coordinate& coord);
     void displayNote();
     void displayCoordinate(const std::string& uniqueId, const persistence::Coordinate& coord);
@@ -4,6 +4,7 @@
 #include "src/ui/DefaultInfoWidget.h"
 #include "src/ui/ExportInfoWidget.h"
 #include "src/ui/ImportInfoWidget.h"
+#include "src/ui/IngestInfoWidget.h"
 #include "src/ui/MapWidgetNoninteractive.h"
 #include "src/util/ExecuteablePath.h"
 
@@ -211,6 +212,13 @@ void HistoricalMap::start()
                     }
                 }
 
+                if (ImGui::MenuItem(gettext("Import to database"))) {
+                    if (dynamic_cast<DefaultInfoWidget*>(infoWidget.get()) != nullptr) {
+                        presenter.handleClickIngest();
+                        infoWidget = std::make_unique<IngestInfoWidget>();
+                    }
+                }
+
                 if (ImGui::MenuItem(gettext("Export"))) {
                     if (dynamic_cast<DefaultInfoWidget*>(infoWidget.get()) != nullptr) {
                         presenter.handleClickExport();
@@ -218,6 +226,13 @@ void HistoricalMap::start()
                     }
                 }
 
+                ImGui::Separator();
+
+                if (bool enabled = presenter.handleIsSnapshotEnabled();
+                    ImGui::MenuItem(gettext("Load years from a snapshot file"), nullptr, &enabled)) {
+                    presenter.handleEnableSnapshot(enabled);
+                }
+
                 ImGui::EndMenu();
             }
 
@@ -300,7 +300,7 @@ void ImportInfoWidget::selectCountry(const std::string& name)
     }
 }
 
-void ImportInfoWidget::displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour)
+void ImportInfoWidget::displayCountry(const std::string& name, const persistence::Contour& contour)
 {
     if (ImGui::TreeNode((name + "##country").c_str())) {
         int idx = 0;
@@ -382,6 +382,9 @@ void ImportInfoWidget::displayCoordinate(const std::string& uniqueId,
 void ImportInfoWidget::displaySaveToDatabasePopup()
 {
     if (ImGui::BeginPopupModal(gettext(WRITE_TO_DATABASE_PROGRESS_POPUP))) {
+        if (databaseSaverPresenter.isSaveComplete()) {
+            textFailedYears(databaseSaverPresenter.getFailedYears());
+        }
         simpleProgressDisplayer(databaseSaverPresenter.getProgress(),
                                 gettext(DONE_BUTTON),
                                 databaseSaverPresenter.isSaveComplete(),
@@ -393,14 +396,11 @@ void ImportInfoWidget::displaySaveToDatabasePopup()
 }
 
 void ImportInfoWidget::updateCountryResources(const presentation::HistoricalInfoPresenter& presenter,
-                                              std::map<std::string, std::vector<persistence::Coordinate>>& cache)
+                                              std::map<std::string, persistence::Contour>& cache)
 {
     cache.clear();
     for (const auto& country : presenter.handleRequestCountryList()) {
-        cache.emplace(std::make_pair(country, std::vector<persistence::Coordinate>{}));
-        for (const auto& coord : presenter.handleRequestContour(country)) {
-            cache[country].emplace_back(coord);
-        }
+        cache.emplace(country, presenter.handleRequestContour(country));
     }
 }
 
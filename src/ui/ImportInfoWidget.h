@@ -45,13 +45,13 @@ private:
     bool openErrorPopup;
     bool isComplete = false;
     std::atomic_bool databaseCountryResourceUpdated = false;
-    std::map<std::string, std::vector<persistence::Coordinate>> databaseCountries;
+    std::map<std::string, persistence::Contour> databaseCountries;
     std::atomic_bool databaseCityResourceUpdated = false;
     std::map<std::string, persistence::Coordinate> databaseCities;
     std::atomic_bool databaseNoteResourceUpdated = false;
     std::string databaseNote;
     std::atomic_bool importedCountryResourceUpdated = false;
-    std::map<std::string, std::vector<persistence::Coordinate>> importedCountries;
+    std::map<std::string, persistence::Contour> importedCountries;
     std::atomic_bool importedCityResourceUpdated = false;
     std::map<std::string, persistence::Coordinate> importedCities;
     std::atomic_bool importedNoteResourceUpdated = false;
@@ -63,7 +63,7 @@ private:
     std::string fileExtensionFormat() const;
     void doImport();
     void selectCountry(const std::string& name);
-    void displayCountry(const std::string& name, const std::vector<persistence::Coordinate>& contour);
+    void displayCountry(const std::string& name, const persistence::Contour& contour);
     void selectCity(const std::string& name);
     void displayCity(const std::string& name, const persistence::Coordinate& coord);
     void selectNote(const std::string& note);
@@ -78,7 +78,7 @@ private:
     void updateNoteResources();
 
     void updateCountryResources(const presentation::HistoricalInfoPresenter& presenter,
-                                std::map<std::string, std::vector<persistence::Coordinate>>& cache);
+                                std::map<std::string, persistence::Contour>& cache);
     void updateCityResources(const presentation::HistoricalInfoPresenter& presenter, 
                              std::map<std::string, persistence::Coordinate>& cache);
     void updateNoteResources(const presentation::HistoricalInfoPresenter& presenter, std::string& cache);
@@ -0,0 +1,106 @@
+#include "src/ui/IngestInfoWidget.h"
+#include "src/ui/Util.h"
+#include "src/logger/LoggerManager.h"
+#include "src/util/ExecuteablePath.h"
+
+#include "imgui.h"
+#include "ImFileDialog.h"
+
+#include <libintl.h>
+
+namespace ui {
+#define __(x) x     // gettext translation registration for constexpr
+
+constexpr auto FILE_SELECT_POPUP_NAME = __("Select file");
+constexpr auto INGEST_PROGRESS_POPUP_NAME = __("Writing to database");
+constexpr auto INGEST_FAIL_POPUP_NAME = __("Import fail");
+constexpr auto CANCEL_BUTTON = __("Cancel");
+constexpr auto DONE_BUTTON = __("Done");
+constexpr auto LOGGER_NAME = "IngestInfoWidget";
+
+IngestInfoWidget::IngestInfoWidget():
+    logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)}
+{
+    ifd::FileDialog::getInstance().open(gettext(FILE_SELECT_POPUP_NAME), gettext(FILE_SELECT_POPUP_NAME), fileExtensionFormat(), false, util::getAppBundlePath().parent_path().string());
+}
+
+std::string IngestInfoWidget::fileExtensionFormat() const
+{
+    const auto formats = ingestPresenter.handleGetSupportedFormat();
+    std::string extensions = "(";
+    for (const auto& format: formats) {
+        extensions += "*." + format + ";";
+    }
+    extensions.back() = ')';
+    extensions += "{";
+    for (const auto& format: formats) {
+        extensions += "." + format + ",";
+    }
+    extensions.back() = '}';
+
+    return extensions;
+}
+
+void IngestInfoWidget::paint()
+{
+    if (ifd::FileDialog::getInstance().isDone(gettext(FILE_SELECT_POPUP_NAME))) {
+        if (ifd::FileDialog::getInstance().hasResult()) {
+            const std::string file = ifd::FileDialog::getInstance().getResult().u8string();
+            logger.debug("Write file {} to database", file);
+            ingestPresenter.handleDoIngest(file);
+            ImGui::OpenPopup(gettext(INGEST_PROGRESS_POPUP_NAME));
+        } else {
+            isComplete = true;
+        }
+        ifd::FileDialog::getInstance().close();
+    }
+
+    if (ImGui::BeginPopupModal(gettext(INGEST_PROGRESS_POPUP_NAME), nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text(gettext("Written: %zu years"), ingestPresenter.handleGetIngestedYears());
+
+        if (!ingestComplete) {
+            if (auto ret = ingestPresenter.handleCheckIngestComplete(); ret) {
+                ingestComplete = ret.value();
+            } else {
+                ImGui::CloseCurrentPopup();
+                errorMsg = ret.error().msg;
+                openErrorPopup = true;
+            }
+        }
+
+        if (!ingestComplete && !canceled) {
+            alignForWidth(ImGui::CalcTextSize(gettext(CANCEL_BUTTON)).x);
+            if (ImGui::Button(gettext(CANCEL_BUTTON))) {
+                ingestPresenter.handleCancelIngest();
+                canceled = true;
+            }
+        }
+
+        centeredEnableableButton(gettext(DONE_BUTTON),
+                                 ingestComplete,
+                                 [this](){
+                                     this->isComplete = true;
+                                 });
+
+        ImGui::EndPopup();
+
+        if (openErrorPopup) {
+            ImGui::OpenPopup(gettext(INGEST_FAIL_POPUP_NAME));
+            openErrorPopup = false;
+        }
+    }
+
+    if (ImGui::BeginPopupModal(gettext(INGEST_FAIL_POPUP_NAME), nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        alignForWidth(ImGui::CalcTextSize(errorMsg.c_str()).x);
+        ImGui::Text("%s", errorMsg.c_str());
+
+        alignForWidth(ImGui::CalcTextSize(gettext(DONE_BUTTON)).x);
+        if (ImGui::Button(gettext(DONE_BUTTON))) {
+            ImGui::CloseCurrentPopup();
+            isComplete = true;
+        }
+
+        ImGui::EndPopup();
+    }
+}
+}
@@ -0,0 +1,31 @@
+#ifndef SRC_UI_INGEST_INFO_WIDGET_H
+#define SRC_UI_INGEST_INFO_WIDGET_H
+
+#include "src/ui/IInfoWidget.h"
+#include "src/presentation/IngestPresenter.h"
+#include "src/logger/ModuleLogger.h"
+
+#include <string>
+
+namespace ui {
+class IngestInfoWidget: public IInfoWidget {
+public:
+    IngestInfoWidget();
+
+    virtual void paint() override;
+    virtual bool complete() const noexcept override { return isComplete; }
+
+private:
+    logger::ModuleLogger logger;
+    presentation::IngestPresenter ingestPresenter;
+    bool ingestComplete = false;
+    bool canceled = false;
+    std::string errorMsg;
+    bool openErrorPopup = false;
+    bool isComplete = false;
+
+    std::string fileExtensionFormat() const;
+};
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "src/ui/TileSeedWidget.h"
+#include "src/ui/Util.h"
+#include "src/util/ExecuteablePath.h"
+
+#include "external/imgui/imgui.h"
+#include "external/imgui/misc/cpp/imgui_stdlib.h"
+#include "ImFileDialog.h"
+
+#include <libintl.h>
+
+namespace ui {
+#define __(x) x     // gettext translation registration for constexpr
+
+constexpr auto SAVE_DIALOG_KEY = "SaveSeedDialog";
+constexpr auto MBTILES_FILTER = "*.mbtiles {.mbtiles}";
+const auto SEED_HELP = __("Tiles already in the file are skipped, start again on the same file to resume. "
+                          "Please respect the usage policy of the tile server when choosing the rate.");
+
+TileSeedWidget::TileSeedWidget():
+    bbox{presenter.handleGetBoundingBox()}
+{
+}
+
+void TileSeedWidget::paint(const std::string& url)
+{
+    const bool seeding = presenter.handleIsSeeding();
+
+    if (seeding) {
+        ImGui::BeginDisabled();
+    }
+
+    inputFloatWithLabelOnLeft(gettext("west"), bbox.west);
+    inputFloatWithLabelOnLeft(gettext("south"), bbox.south);
+    inputFloatWithLabelOnLeft(gettext("east"), bbox.east);
+    inputFloatWithLabelOnLeft(gettext("north"), bbox.north);
+    if (ImGui::Button(gettext("Use current view"))) {
+        bbox = presenter.handleGetBoundingBox();
+    }
+
+    ImGui::InputInt(gettext("Min zoom"), &minZoom);
+    ImGui::InputInt(gettext("Max zoom"), &maxZoom);
+    ImGui::InputInt(gettext("Concurrent requests"), &concurrency);
+    ImGui::InputFloat(gettext("Requests per second"), &requestsPerSecond);
+    ImGui::SameLine();
+    helpMarker(gettext(SEED_HELP));
+
+    ImGui::InputText("##seedPath", &path);
+    ImGui::SameLine();
+    if (ImGui::Button(gettext("Browse"))) {
+        ifd::FileDialog::getInstance().save(SAVE_DIALOG_KEY, gettext("Save tiles"), MBTILES_FILTER, util::getAppBundlePath().parent_path().string());
+    }
+
+    if (ImGui::Button(gettext("Download"))) {
+        if (auto ret = presenter.handleStartSeed(url, path, bbox, minZoom, maxZoom, concurrency, requestsPerSecond); ret) {
+            errorMsg.clear();
+        } else {
+            errorMsg = ret.error().msg;
+        }
+    }
+
+    if (seeding) {
+        ImGui::EndDisabled();
+    }
+
+    if (ifd::FileDialog::getInstance().isDone(SAVE_DIALOG_KEY)) {
+        if (ifd::FileDialog::getInstance().hasResult()) {
+            path = ifd::FileDialog::getInstance().getResult().u8string();
+        }
+        ifd::FileDialog::getInstance().close();
+    }
+
+    if (!errorMsg.empty()) {
+        ImGui::Text(gettext("Failed to download: %s"), errorMsg.c_str());
+    }
+
+    const auto progress = presenter.handleGetSeedProgress();
+    if (progress.total > 0) {
+        ImGui::ProgressBar(static_cast<float>(progress.finished()) / progress.total, PROGRESS_BAR_SIZES);
+        ImGui::Text(gettext("Downloaded %zu, skipped %zu, failed %zu of %zu tiles"),
+                    progress.stored, progress.skipped, progress.failed, progress.total);
+    }
+
+    if (seeding && ImGui::Button(gettext("Stop"))) {
+        presenter.handleStopSeed();
+    }
+}
+}
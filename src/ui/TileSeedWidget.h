@@ -0,0 +1,30 @@
+#ifndef SRC_UI_TILE_SEED_WIDGET_H
+#define SRC_UI_TILE_SEED_WIDGET_H
+
+#include "src/presentation/TileSeedPresenter.h"
+#include "src/model/Util.h"
+
+#include <string>
+
+namespace ui {
+// Downloads a region from the tile server into a MBTiles file, which is then opened as the
+// "MBTiles" tile source for offline use
+class TileSeedWidget {
+public:
+    TileSeedWidget();
+
+    void paint(const std::string& url);
+
+private:
+    presentation::TileSeedPresenter presenter;
+    model::BoundingBox bbox;
+    int minZoom = 0;
+    int maxZoom = 12;
+    int concurrency = 2;
+    float requestsPerSecond = 2.0f;
+    std::string path;
+    std::string errorMsg;
+};
+}
+
+#endif /* SRC_UI_TILE_SEED_WIDGET_H */
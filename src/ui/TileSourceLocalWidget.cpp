@@ -0,0 +1,58 @@
+#include "src/ui/TileSourceLocalWidget.h"
+#include "src/util/ExecuteablePath.h"
+
+#include "external/imgui/imgui.h"
+#include "external/imgui/misc/cpp/imgui_stdlib.h"
+#include "ImFileDialog.h"
+
+#include <libintl.h>
+
+namespace ui {
+#define __(x) x     // gettext translation registration for constexpr
+
+constexpr auto SELECT_POPUP_NAME = __("Select tiles");
+constexpr auto MBTILES_FILTER = "MBTiles (*.mbtiles){.mbtiles}";
+constexpr auto DIRECTORY_FILTER = "";     // selects a directory
+
+TileSourceLocalWidget::TileSourceLocalWidget(presentation::TileSourceLocalPresenter::Type type):
+    presenter{type}
+{}
+
+void TileSourceLocalWidget::paint()
+{
+    const bool isMBTiles = presenter.handleGetType() == presentation::TileSourceLocalPresenter::Type::MBTILES;
+
+    ImGui::InputText("##path", &path);
+    ImGui::SameLine();
+    if (ImGui::Button(gettext("Browse"))) {
+        ifd::FileDialog::getInstance().open(gettext(SELECT_POPUP_NAME),
+                                            gettext(SELECT_POPUP_NAME),
+                                            isMBTiles ? MBTILES_FILTER : DIRECTORY_FILTER,
+                                            false,
+                                            util::getAppBundlePath().parent_path().string());
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(gettext("Set"))) {
+        setPath();
+    }
+
+    if (ifd::FileDialog::getInstance().isDone(gettext(SELECT_POPUP_NAME))) {
+        if (ifd::FileDialog::getInstance().hasResult()) {
+            path = ifd::FileDialog::getInstance().getResult().u8string();
+            setPath();
+        }
+        ifd::FileDialog::getInstance().close();
+    }
+
+    if (failed) {
+        ImGui::TextColored(ImVec4{1, 0, 0, 1}, "%s", isMBTiles ? gettext("Not a MBTiles file") : gettext("Not a directory"));
+    } else if (const auto current = presenter.handleGetPath(); !current.empty()) {
+        ImGui::TextUnformatted(current.c_str());
+    }
+}
+
+void TileSourceLocalWidget::setPath()
+{
+    failed = !presenter.handleSetPath(path);
+}
+}
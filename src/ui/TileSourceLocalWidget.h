@@ -0,0 +1,26 @@
+#ifndef SRC_UI_TILE_SOURCE_LOCAL_WIDGET_H
+#define SRC_UI_TILE_SOURCE_LOCAL_WIDGET_H
+
+#include "src/ui/ITileSourceWidgetDetail.h"
+#include "src/presentation/TileSourceLocalPresenter.h"
+
+#include <string>
+
+namespace ui {
+class TileSourceLocalWidget: public ITileSourceWidgetDetail {
+public:
+    explicit TileSourceLocalWidget(presentation::TileSourceLocalPresenter::Type type);
+    ~TileSourceLocalWidget() override = default;
+
+    void paint() override;
+
+private:
+    std::string path;
+    bool failed = false;
+    presentation::TileSourceLocalPresenter presenter;
+
+    void setPath();
+};
+}
+
+#endif /* SRC_UI_TILE_SOURCE_LOCAL_WIDGET_H */
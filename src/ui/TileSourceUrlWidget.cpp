@@ -35,5 +35,9 @@ void TileSourceUrlWidget::paint()
     ImGui::PushStyleColor(ImGuiCol_FrameBg, TRANSPARENT);  // Transparent background
     ImGui::InputText("##text", gettext(TILE_SERVER_LOOKUP), strlen(gettext(TILE_SERVER_LOOKUP)) + 1, ImGuiInputTextFlags_ReadOnly);
     ImGui::PopStyleColor(1);
+
+    if (ImGui::CollapsingHeader(gettext("Download region"))) {
+        seedWidget.paint(url);
+    }
 }
 }
\ No newline at end of file
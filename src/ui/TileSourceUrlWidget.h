@@ -3,6 +3,7 @@
 
 #include "src/ui/ITileSourceWidgetDetail.h"
 #include "src/presentation/TileSourceUrlPresenter.h"
+#include "src/ui/TileSeedWidget.h"
 
 #include <string>
 
@@ -17,6 +18,7 @@ public:
 private:
     std::string url;
     presentation::TileSourceUrlPresenter presenter;
+    TileSeedWidget seedWidget;
 };
 }
 
@@ -1,26 +1,42 @@
 #include "src/ui/TileSourceWidget.h"
 #include "src/ui/TileSourceUrlWidget.h"
+#include "src/ui/TileSourceLocalWidget.h"
 #include "src/presentation/TileSourceUrlPresenter.h"
 #include "src/logger/LoggerManager.h"
 
 #include "external/imgui/imgui.h"
 
 #include <libintl.h>
+#include <map>
 
 namespace ui {
 constexpr auto LOGGER_NAME = "TileSourceWidget";
+constexpr int MIN_WORKERS = 1;
+constexpr int MAX_FETCH_WORKERS = 16;
+constexpr int MAX_DECODE_WORKERS = 16;
 
 TileSourceWidget::TileSourceWidget():
     logger{logger::LoggerManager::getInstance().getLogger(LOGGER_NAME)},
-    getDetailWidget{[](){ return std::make_unique<TileSourceUrlWidget>(); }}
+    fetchWorkers{static_cast<int>(widgetPresenter.handleGetFetchWorkers())},
+    decodeWorkers{static_cast<int>(widgetPresenter.handleGetDecodeWorkers())}
 {
+    const std::map<std::string, std::function<std::unique_ptr<ITileSourceWidgetDetail>()>> detailWidgets{
+        {"URL", [](){ return std::make_unique<TileSourceUrlWidget>(); }},
+        {"MBTiles", [](){ return std::make_unique<TileSourceLocalWidget>(presentation::TileSourceLocalPresenter::Type::MBTILES); }},
+        {"Directory", [](){ return std::make_unique<TileSourceLocalWidget>(presentation::TileSourceLocalPresenter::Type::DIRECTORY); }},
+    };
+
+    // the combo items are separated by '\0'
     for (const auto& source : widgetPresenter.handleGetTileSourceList()) {
-        sourceList += source + "\0";
+        sourceList += source;
+        sourceList.push_back('\0');
+        getDetailWidget.push_back(detailWidgets.at(source));
     }
 
     engineList = widgetPresenter.handleGetTileEngineList();
     for (const auto& engine : engineList) {
-        engineListString += engine + "\0";
+        engineListString += engine;
+        engineListString.push_back('\0');
     }
 
     widgetPresenter.handleSetTileEngine(engineList.front());
@@ -41,6 +57,15 @@ void TileSourceWidget::paint()
         }
     }
 
+    // the workers are replaced once the slider is released instead of at every step of a drag
+    ImGui::SliderInt(gettext("Concurrent requests"), &fetchWorkers, MIN_WORKERS, MAX_FETCH_WORKERS);
+    bool concurrencyChanged = ImGui::IsItemDeactivatedAfterEdit();
+    ImGui::SliderInt(gettext("Decoding threads"), &decodeWorkers, MIN_WORKERS, MAX_DECODE_WORKERS);
+    concurrencyChanged |= ImGui::IsItemDeactivatedAfterEdit();
+    if (concurrencyChanged) {
+        widgetPresenter.handleSetConcurrency(fetchWorkers, decodeWorkers);
+    }
+
     ImGui::SeparatorText(gettext("Configuration"));
 
     detail->paint();
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <functional>
+#include <vector>
 
 namespace ui {
 #define __(x) x     // gettext translation registration for constexpr
@@ -24,6 +25,8 @@ private:
     presentation::TileSourceWidgetPresenter widgetPresenter;
     int sourceIdx = 0;
     int tileEngineIdx = 0;
+    int fetchWorkers;
+    int decodeWorkers;
     std::string sourceList;
     std::string engineListString;
     std::vector<std::string> engineList;
@@ -2,10 +2,13 @@
 
 #include "external/imgui/imgui.h"
 
+#include <libintl.h>
+
 namespace ui {
 constexpr float STEP = 0;
 constexpr float STEP_FAST = 0;
 constexpr auto DECIMAL_PRECISION = "%.2f";
+constexpr size_t MAX_FAILED_YEARS_SHOWN = 10;
 
 void helpMarker(const char* message)
 {
@@ -38,4 +41,21 @@ void inputFloatWithLabelOnLeft(const std::string& label, float& value)
     ImGui::SameLine();
     ImGui::InputFloat(("##" + label).c_str(), &value, STEP, STEP_FAST, DECIMAL_PRECISION);
 }
-}
\ No newline at end of file
+
+void textFailedYears(const std::vector<int>& years)
+{
+    if (years.empty()) {
+        return;
+    }
+
+    std::string text;
+    for (size_t i = 0; i < years.size() && i < MAX_FAILED_YEARS_SHOWN; i++) {
+        text += (i == 0 ? "" : ", ") + std::to_string(years[i]);
+    }
+    if (years.size() > MAX_FAILED_YEARS_SHOWN) {
+        text += ", ...";
+    }
+
+    ImGui::TextWrapped(gettext("Failed to save years: %s"), text.c_str());
+}
+}
@@ -11,6 +11,7 @@
 #include <type_traits>
 #include <string_view>
 #include <functional>
+#include <vector>
 
 namespace ui {
 constexpr int COORDINATE_INPUT_WIDTH = 50;
@@ -57,6 +58,7 @@ bool inBound(T v, T min, T max)
 
 void textFloatWithLabelOnLeft(const std::string& label, float value);
 void inputFloatWithLabelOnLeft(const std::string& label, float& value);
+void textFailedYears(const std::vector<int>& years);
 }
 
 #endif
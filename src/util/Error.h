@@ -15,6 +15,8 @@ enum class ErrorCode {
     INVALID_PARAM,
     OPERATION_CANCELED,
     NETWORK_ERROR,
+    DATABASE_ERROR,
+    FILE_WRITE_ERROR,
 };
 
 struct Error {
@@ -0,0 +1,144 @@
+#ifndef SRC_UTIL_HASH_H
+#define SRC_UTIL_HASH_H
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace util {
+// 128 bits content hash, unlike std::hash it is the same for all the platforms and
+// standard libraries so it can be persisted.
+struct Hash128 {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    static constexpr size_t SIZE = 16;
+
+    auto operator<=>(const Hash128&) const = default;
+
+    // little endian byte representation which is stored in the database
+    std::array<uint8_t, SIZE> bytes() const noexcept
+    {
+        std::array<uint8_t, SIZE> ret;
+        for (size_t i = 0; i < sizeof(uint64_t); i++) {
+            ret[i] = static_cast<uint8_t>(low >> (i * 8));
+            ret[i + sizeof(uint64_t)] = static_cast<uint8_t>(high >> (i * 8));
+        }
+
+        return ret;
+    }
+
+    static std::optional<Hash128> fromBytes(const uint8_t* data, size_t len) noexcept
+    {
+        if (data == nullptr || len != SIZE) {
+            return std::nullopt;
+        }
+
+        Hash128 hash;
+        for (size_t i = 0; i < sizeof(uint64_t); i++) {
+            hash.low |= static_cast<uint64_t>(data[i]) << (i * 8);
+            hash.high |= static_cast<uint64_t>(data[i + sizeof(uint64_t)]) << (i * 8);
+        }
+
+        return hash;
+    }
+};
+
+namespace detail {
+inline uint64_t rotl64(uint64_t x, int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) noexcept
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+
+    return k;
+}
+
+inline uint64_t load64(const uint8_t* data) noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        value |= static_cast<uint64_t>(data[i]) << (i * 8);
+    }
+
+    return value;
+}
+}
+
+// MurmurHash3 x64 128, two 64 bits lanes per 16 bytes block.
+// The bytes are read as little endian, so the result doesn't depend on the platform.
+inline Hash128 hash128(std::span<const uint8_t> data, uint64_t seed = 0) noexcept
+{
+    constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    const auto len = data.size();
+    const auto blocks = len / Hash128::SIZE;
+    const auto* bytes = data.data();
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < blocks; i++) {
+        auto k1 = detail::load64(bytes + i * Hash128::SIZE);
+        auto k2 = detail::load64(bytes + i * Hash128::SIZE + sizeof(uint64_t));
+
+        k1 *= c1; k1 = detail::rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = detail::rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2; k2 = detail::rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = detail::rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const auto* tail = bytes + blocks * Hash128::SIZE;
+    const auto remain = len & (Hash128::SIZE - 1);
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    for (size_t i = remain; i > sizeof(uint64_t); i--) {
+        k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1 - sizeof(uint64_t)) * 8);
+    }
+    if (remain > sizeof(uint64_t)) {
+        k2 *= c2; k2 = detail::rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+
+    for (size_t i = std::min(remain, sizeof(uint64_t)); i > 0; i--) {
+        k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+    }
+    if (remain > 0) {
+        k1 *= c1; k1 = detail::rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = detail::fmix64(h1);
+    h2 = detail::fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    return Hash128{h1, h2};
+}
+
+inline Hash128 hash128(std::string_view data, uint64_t seed = 0) noexcept
+{
+    return hash128(std::span<const uint8_t>{reinterpret_cast<const uint8_t*>(data.data()), data.size()}, seed);
+}
+}
+
+#endif
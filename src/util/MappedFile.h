@@ -0,0 +1,139 @@
+#ifndef SRC_UTIL_MAPPED_FILE_H
+#define SRC_UTIL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#ifdef _WIN32
+#include "src/util/Windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+// A file mapped read-only into the memory, the pages are read by the OS when they are touched
+// and shared with the page cache. An empty or missing file is not mapped.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return;
+        }
+
+        mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            close();
+            return;
+        }
+
+        address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (address == NULL) {
+            close();
+            return;
+        }
+
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+
+        struct stat status;
+        if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+            if (auto mapped = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                mapped != MAP_FAILED) {
+                address = mapped;
+                size = static_cast<size_t>(status.st_size);
+            }
+        }
+
+        // the mapping keeps the file alive
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        MappedFile{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isMapped() const noexcept { return address != nullptr; }
+
+    std::span<const std::byte> getBytes() const noexcept
+    {
+        return {static_cast<const std::byte*>(address), size};
+    }
+
+private:
+    void* address = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+    void swap(MappedFile& other) noexcept
+    {
+        std::swap(address, other.address);
+        std::swap(size, other.size);
+#ifdef _WIN32
+        std::swap(file, other.file);
+        std::swap(mapping, other.mapping);
+#endif
+    }
+
+    void close() noexcept
+    {
+#ifdef _WIN32
+        if (address != nullptr) {
+            UnmapViewOfFile(address);
+        }
+
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+
+        file = INVALID_HANDLE_VALUE;
+        mapping = NULL;
+#else
+        if (address != nullptr) {
+            ::munmap(address, size);
+        }
+#endif
+        address = nullptr;
+        size = 0;
+    }
+};
+}
+
+#endif
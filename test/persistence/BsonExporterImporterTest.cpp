@@ -32,7 +32,7 @@ TEST_F(BsonExporterImporterTest, ExportAndImport)
             std::list<persistence::Country>{
                 persistence::Country{
                     "A",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             1.1f, 
                             2.1f
@@ -45,7 +45,7 @@ TEST_F(BsonExporterImporterTest, ExportAndImport)
                 },
                 persistence::Country{
                     "B",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             2.1f, 
                             3.1f
@@ -80,7 +80,7 @@ TEST_F(BsonExporterImporterTest, ExportAndImport)
             std::list<persistence::Country>{
                 persistence::Country{
                     "A",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             11.1f, 
                             21.1f
@@ -93,7 +93,7 @@ TEST_F(BsonExporterImporterTest, ExportAndImport)
                 },
                 persistence::Country{
                     "B",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             21.1f, 
                             31.1f
@@ -138,7 +138,7 @@ TEST_F(BsonExporterImporterTest, ExportAndImport)
     std::vector<persistence::Data> readback;
 
     if (auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT); importer) {
-        auto loader = importer.value()->loadFromFile(FILE_NAME);
+        auto loader = importer.value()->loadFromFile(FILE_NAME, true);
 
         while (loader.next()) {
             if (const auto& ret = loader.getValue(); ret) {
@@ -188,7 +188,7 @@ TEST_F(BsonExporterImporterTest, ReadFileNotExists)
 {
     auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
 
-    auto loader = importer.value()->loadFromFile(FILE_NAME);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, true);
     
     loader.next();
 
@@ -198,7 +198,7 @@ TEST_F(BsonExporterImporterTest, ReadFileNotExists)
 TEST_F(BsonExporterImporterTest, IncorrectJsonFormat)
 {
     if (auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT); importer) {
-        auto loader = importer.value()->loadFromFile("incorrectJson.json");
+        auto loader = importer.value()->loadFromFile("incorrectJson.json", true);
         std::optional<util::Error> error;
 
         while (loader.next()) {
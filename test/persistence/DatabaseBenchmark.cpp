@@ -0,0 +1,150 @@
+#include "sqlpp11/sqlite3/sqlite3.h"
+#include "sqlpp11/sqlite3/connection_config.h"
+
+#include "src/persistence/Database.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace sqlpp::sqlite3;
+
+constexpr auto DATABASE_NAME = ":memory:";
+constexpr int YEAR = 1900;
+constexpr int POINTS_PER_CONTOUR = 200;
+constexpr int REPEAT = 20;
+const std::vector<int> COUNTRIES_PER_YEAR{1, 10, 50, 150, 300, 600};
+constexpr int COUNTRIES_OF_FILLING_YEAR = 50;
+const std::vector<int> TOTAL_YEARS{1, 50, 200, 800};
+
+persistence::Data makeYear(int year, int numOfCountries)
+{
+    persistence::Data data{year};
+
+    for (int i = 0; i < numOfCountries; i++) {
+        persistence::Country country{"Country" + std::to_string(i)};
+        for (int point = 0; point < POINTS_PER_CONTOUR; point++) {
+            // the year is part of the contour so every year owns its borders
+            country.borderContour.emplace_back(persistence::Coordinate{static_cast<float>(i), static_cast<float>(point + year)});
+        }
+
+        data.countries.emplace_back(std::move(country));
+        data.cities.emplace_back("City" + std::to_string(i), persistence::Coordinate{static_cast<float>(i), static_cast<float>(i)});
+    }
+
+    data.note = persistence::Note{"Note of year " + std::to_string(year)};
+
+    return data;
+}
+
+template<typename Func>
+double measureMicroseconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEAT; i++) {
+        func();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / REPEAT;
+}
+
+// Not a correctness test, it prints how the latency changes when the data grows.
+// The numbers are only meaningful when comparing runs on the same machine.
+class DatabaseBenchmark : public ::testing::Test {
+public:
+    std::shared_ptr<connection_config> config = std::make_shared<connection_config>(DATABASE_NAME, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+};
+
+TEST_F(DatabaseBenchmark, LoadLatencyByCountriesPerYear)
+{
+    std::cout << std::setw(12) << "countries" 
+              << std::setw(16) << "load (us)" 
+              << std::setw(12) << "prepared"
+              << std::setw(12) << "executed" << std::endl;
+
+    for (const auto numOfCountries : COUNTRIES_PER_YEAR) {
+        persistence::Database<connection, connection_config> database{config};
+        const auto data = makeYear(YEAR, numOfCountries);
+        database.upsert(data);
+
+        ASSERT_EQ(database.load(YEAR), data);
+
+        const auto latency = measureMicroseconds([&database](){ database.load(YEAR); });
+
+        const auto statistics = database.getStatementStatistics();
+
+        std::cout << std::setw(12) << numOfCountries 
+                  << std::setw(16) << std::fixed << std::setprecision(1) << latency 
+                  << std::setw(12) << statistics.prepared
+                  << std::setw(12) << statistics.executed << std::endl;
+    }
+}
+
+// With the indexes of the relationship tables, neither loading a year nor removing it
+// should depend on how many other years are stored.
+TEST_F(DatabaseBenchmark, LatencyByTotalYears)
+{
+    std::cout << std::setw(12) << "years" 
+              << std::setw(16) << "load (us)" 
+              << std::setw(24) << "remove+upsert (us)" << std::endl;
+
+    for (const auto totalYears : TOTAL_YEARS) {
+        persistence::Database<connection, connection_config> database{config};
+        database.transaction([&database, totalYears](){
+            for (int year = YEAR - totalYears + 1; year <= YEAR; year++) {
+                database.upsert(makeYear(year, COUNTRIES_OF_FILLING_YEAR));
+            }
+        });
+
+        const auto data = database.load(YEAR);
+        ASSERT_EQ(data, makeYear(YEAR, COUNTRIES_OF_FILLING_YEAR));
+
+        const auto loadLatency = measureMicroseconds([&database](){ database.load(YEAR); });
+        // put the year back after each removal so every round removes the same amount of data
+        const auto removeLatency = measureMicroseconds([&database, &data](){
+            database.transaction([&database, &data](){
+                database.remove(data);
+                database.upsert(data);
+            });
+        });
+
+        std::cout << std::setw(12) << totalYears 
+                  << std::setw(16) << std::fixed << std::setprecision(1) << loadLatency 
+                  << std::setw(24) << std::fixed << std::setprecision(1) << removeLatency << std::endl;
+    }
+}
+
+// The years are stamped by a trigger per written row while the revisions are tracked for a snapshot,
+// it shows what the tracking adds to writing a year.
+TEST_F(DatabaseBenchmark, WriteLatencyByRevisionTracking)
+{
+    std::cout << std::setw(12) << "countries"
+              << std::setw(12) << "tracking"
+              << std::setw(24) << "remove+upsert (us)" << std::endl;
+
+    for (const auto numOfCountries : {COUNTRIES_OF_FILLING_YEAR, COUNTRIES_PER_YEAR.back()}) {
+        for (const auto tracking : {false, true}) {
+            persistence::Database<connection, connection_config> database{config};
+            database.setRevisionTracking(tracking);
+            const auto data = makeYear(YEAR, numOfCountries);
+            database.upsert(data);
+
+            const auto latency = measureMicroseconds([&database, &data](){
+                database.transaction([&database, &data](){
+                    database.remove(data);
+                    database.upsert(data);
+                });
+            });
+
+            std::cout << std::setw(12) << numOfCountries
+                      << std::setw(12) << (tracking ? "on" : "off")
+                      << std::setw(24) << std::fixed << std::setprecision(1) << latency << std::endl;
+        }
+    }
+}
+}
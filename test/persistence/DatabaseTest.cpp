@@ -3,8 +3,11 @@
 
 #include "src/persistence/Database.h"
 
+#include <cereal/types/list.hpp>
+
 #include <gtest/gtest.h>
 #include <cstdio>
+#include <list>
 
 namespace {
 using namespace sqlpp::sqlite3;
@@ -32,6 +35,9 @@ public:
         monitor.execute("DELETE FROM years");
         monitor.execute("DELETE FROM countries");
         monitor.execute("DELETE FROM borders");
+        monitor.execute("DELETE FROM borderBounds");
+        monitor.execute("DELETE FROM cityBounds");
+        monitor.execute("DELETE FROM yearRevisions");
     }
 
     std::shared_ptr<connection_config> config = std::make_shared<connection_config>(DATABASE_NAME, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,  "", true);
@@ -152,6 +158,9 @@ TEST_F(DatabaseTest, UpdateOneOfTheCountry)
 
     EXPECT_EQ(database.load(year), expect);
 
+    // the replaced border is left to the garbage collection
+    EXPECT_TRUE(database.collectGarbage(100));
+
     int count = 0;
     for (const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
         count++;
@@ -195,6 +204,7 @@ TEST_F(DatabaseTest, RemoveOneCountryDifferentBorder)
     database.remove(remove);
 
     EXPECT_EQ(database.load(year), expect);
+    EXPECT_TRUE(database.collectGarbage(100));
 
     int count = 0;
     for (const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
@@ -270,6 +280,7 @@ TEST_F(DatabaseTest, RemoveAllCountries)
     database.remove(remove);
 
     EXPECT_EQ(database.load(year), expect);
+    EXPECT_TRUE(database.collectGarbage(100));
 
     int count = 0;
     for (const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
@@ -733,4 +744,755 @@ TEST_F(DatabaseTest, LoadAllCities)
 
     EXPECT_EQ(database.loadCityList(), names);
 }
-}
\ No newline at end of file
+
+TEST_F(DatabaseTest, TransactionCommit)
+{
+    const persistence::Data data1{1900, {}, {persistence::City{"One", {1,2}}}};
+    const persistence::Data data2{1901, {}, {persistence::City{"Two", {3,4}}}};
+
+    database.transaction([this, &data1, &data2](){
+        database.upsert(data1);
+        database.upsert(data2);
+    });
+
+    EXPECT_EQ(database.load(1900), data1);
+    EXPECT_EQ(database.load(1901), data2);
+}
+
+TEST_F(DatabaseTest, TransactionRollbackOnFailure)
+{
+    const persistence::Data data{1900, {}, {persistence::City{"One", {1,2}}}};
+
+    EXPECT_THROW(database.transaction([this, &data](){
+        database.upsert(data);
+        throw std::runtime_error{"failure"};
+    }), std::runtime_error);
+
+    EXPECT_EQ(database.load(1900), persistence::Data{1900});
+}
+
+TEST_F(DatabaseTest, SavepointRollbackKeepsOthers)
+{
+    const persistence::Data data1{1900, {}, {persistence::City{"One", {1,2}}}};
+    const persistence::Data data2{1901, {}, {persistence::City{"Two", {3,4}}}};
+
+    database.transaction([this, &data1, &data2](){
+        database.savepoint("first", [this, &data1](){
+            database.upsert(data1);
+        });
+
+        EXPECT_THROW(database.savepoint("second", [this, &data2](){
+            database.upsert(data2);
+            throw std::runtime_error{"failure"};
+        }), std::runtime_error);
+    });
+
+    EXPECT_EQ(database.load(1900), data1);
+    EXPECT_EQ(database.load(1901), persistence::Data{1901});
+}
+
+TEST_F(DatabaseTest, PreparedStatementsAreReused)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    database.upsert(persistence::Data{1900, {country}});
+    database.load(1900);
+
+    const auto before = database.getStatementStatistics();
+
+    database.upsert(persistence::Data{1901, {country}});
+    database.load(1901);
+
+    const auto after = database.getStatementStatistics();
+
+    EXPECT_EQ(after.prepared, before.prepared);
+    EXPECT_GT(after.executed, before.executed);
+}
+
+TEST_F(DatabaseTest, DeserializeLegacyListContour)
+{
+    const std::list<persistence::Coordinate> legacy{persistence::Coordinate{1,2}, persistence::Coordinate{3,4}};
+    persistence::Stream stream;
+    {
+        cereal::BinaryOutputArchive oarchive(stream);
+        oarchive(legacy);
+    }
+
+    const auto contour = persistence::deserializeContour(std::move(stream));
+
+    EXPECT_EQ(contour, (persistence::Contour{legacy.cbegin(), legacy.cend()}));
+}
+
+TEST_F(DatabaseTest, SerializeContourRoundTrip)
+{
+    const persistence::Contour contour{persistence::Coordinate{-89.999,179.999}, persistence::Coordinate{0.001,-0.001}, persistence::Coordinate{45.5,-120.25}};
+    const auto stream = persistence::serializeContour<persistence::Stream>(contour);
+    const auto legacy = persistence::serializeLegacyContour<persistence::Stream>(contour);
+
+    EXPECT_LT(stream.view().size(), legacy.view().size());
+    EXPECT_EQ(persistence::deserializeContour(persistence::Stream{stream.str()}), contour);
+}
+
+class DatabaseLegacyBorderTest : public DatabaseTest {
+public:
+    // store the borders in the format written before the compact contour format
+    void downgradeBorders(const persistence::Data& data)
+    {
+        for (const auto& country : data.countries) {
+            const auto stream = persistence::serializeContour<persistence::Stream>(country.borderContour);
+            const auto legacy = persistence::serializeLegacyContour<persistence::Stream>(country.borderContour);
+
+            persistence::SqliteStatement downgrade{monitor.native_handle(), "UPDATE borders SET hash = ?1, contour = ?2 WHERE hash = ?3;"};
+            downgrade.bindInt(1, static_cast<int64_t>(std::hash<std::string>{}(legacy)))
+                     .bindBlob(2, std::vector<uint8_t>{legacy})
+                     .bindBlob(3, util::hash128(stream.view()).bytes())
+                     .execute();
+        }
+    }
+
+    // keep the current contour format but store the std::hash written before util::hash128
+    void downgradeBorderHashes(const persistence::Data& data)
+    {
+        for (const auto& country : data.countries) {
+            const auto stream = persistence::serializeContour<persistence::Stream>(country.borderContour);
+
+            persistence::SqliteStatement downgrade{monitor.native_handle(), "UPDATE borders SET hash = ?1 WHERE hash = ?2;"};
+            downgrade.bindInt(1, static_cast<int64_t>(std::hash<std::string>{}(stream)))
+                     .bindBlob(2, util::hash128(stream.view()).bytes())
+                     .execute();
+        }
+    }
+};
+
+TEST_F(DatabaseLegacyBorderTest, LoadLegacyBorder)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Data data{1900, {country}};
+
+    database.upsert(data);
+    downgradeBorders(data);
+
+    EXPECT_EQ(database.load(1900), data);
+}
+
+TEST_F(DatabaseLegacyBorderTest, RemoveLegacyBorder)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Data data{1900, {country}};
+
+    database.upsert(data);
+    downgradeBorders(data);
+    database.remove(data);
+
+    EXPECT_EQ(database.load(1900), persistence::Data{1900});
+}
+
+TEST_F(DatabaseLegacyBorderTest, MigrateLegacyBorders)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::Country country3{"Three", {persistence::Coordinate{9,10}, persistence::Coordinate{11,12}}};
+    const persistence::Data data{1900, {country1, country2, country3}};
+
+    database.upsert(data);
+    downgradeBorders(data);
+
+    EXPECT_EQ(database.migrateBorders(2), 2);
+    EXPECT_EQ(database.migrateBorders(2), 1);
+    EXPECT_EQ(database.migrateBorders(2), 0);
+
+    EXPECT_EQ(database.load(1900), data);
+
+    for (const auto& row : monitor(sqlpp::select(persistence::BORDERS.contour).from(persistence::BORDERS).unconditionally())) {
+        EXPECT_FALSE(persistence::isLegacyContour(row.contour.blob, row.contour.len));
+    }
+}
+
+TEST_F(DatabaseLegacyBorderTest, MigrateLegacyBorderAlreadyStoredInCurrentFormat)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    database.upsert(persistence::Data{1900, {country1}});
+    downgradeBorders(persistence::Data{1900, {country1}});
+    // the same contour is inserted again in the current format
+    database.upsert(persistence::Data{1901, {country2}});
+
+    EXPECT_EQ(database.migrateBorders(10), 1);
+
+    EXPECT_EQ(database.load(1900), (persistence::Data{1900, {country1}}));
+    EXPECT_EQ(database.load(1901), (persistence::Data{1901, {country2}}));
+
+    int count = 0;
+    for (const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
+        count++;
+    }
+    EXPECT_EQ(count, 1);
+}
+
+TEST_F(DatabaseLegacyBorderTest, MigrateLegacyBorderHashes)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::Data data{1900, {country1, country2}};
+
+    database.upsert(data);
+    downgradeBorderHashes(data);
+
+    EXPECT_EQ(database.migrateBorders(10), 2);
+    EXPECT_EQ(database.migrateBorders(10), 0);
+
+    for (const auto& country : database.load(1900).countries) {
+        EXPECT_EQ(country.borderContour.getHash(), util::hash128(persistence::serializeContour<persistence::Stream>(country.borderContour).view()));
+    }
+}
+
+TEST_F(DatabaseLegacyBorderTest, RemoveBorderWithLegacyHash)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Data data{1900, {country}};
+
+    database.upsert(data);
+    downgradeBorderHashes(data);
+    database.remove(data);
+
+    EXPECT_EQ(database.load(1900), persistence::Data{1900});
+}
+
+TEST_F(DatabaseTest, LoadBorderHash)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const auto expected = util::hash128(persistence::serializeContour<persistence::Stream>(country.borderContour).view());
+
+    // nothing to migrate in a new database, the stored hashes are trusted afterwards
+    EXPECT_EQ(database.migrateBorders(10), 0);
+    database.upsert(persistence::Data{1900, {country}});
+
+    EXPECT_EQ(database.load(1900).countries.front().borderContour.getHash(), expected);
+    EXPECT_EQ(database.loadCountry(1900, "One")->borderContour.getHash(), expected);
+}
+
+TEST_F(DatabaseTest, UpsertLoadedDataReusesBorder)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    EXPECT_EQ(database.migrateBorders(10), 0);
+    database.upsert(persistence::Data{1900, {country}});
+
+    auto data = database.load(1900);
+    data.year = 1901;
+    database.upsert(data);
+
+    EXPECT_EQ(database.load(1901), (persistence::Data{1901, {country}}));
+
+    int count = 0;
+    for (const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
+        EXPECT_EQ(row.hash.len, util::Hash128::SIZE);
+        count++;
+    }
+    EXPECT_EQ(count, 1);
+}
+
+TEST_F(DatabaseTest, RehashLegacyNotes)
+{
+    const persistence::Data data{1900, {}, {}, persistence::Note{"Note"}};
+
+    database.upsert(data);
+    monitor.execute("UPDATE notes SET hash = 1234;");
+
+    // the notes are rehashed when the database is opened
+    persistence::Database<connection, connection_config> reopened{config};
+    reopened.remove(data);
+
+    EXPECT_EQ(reopened.load(1900), persistence::Data{1900});
+}
+
+TEST_F(DatabaseTest, LoadSameBorderFromContourCache)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    database.upsert(persistence::Data{1900, {country}});
+    database.upsert(persistence::Data{1901, {country}});
+
+    const auto data1900 = database.load(1900);
+    const auto data1901 = database.load(1901);
+
+    EXPECT_EQ(data1900, (persistence::Data{1900, {country}}));
+    EXPECT_EQ(data1901, (persistence::Data{1901, {country}}));
+    // the border is decoded once and shared by both years
+    EXPECT_EQ(data1900.countries.front().borderContour.share(), data1901.countries.front().borderContour.share());
+    EXPECT_EQ(database.getContourCacheStatistics().misses, 1);
+    EXPECT_EQ(database.getContourCacheStatistics().hits, 1);
+}
+
+TEST_F(DatabaseTest, ReadOnlyConnectionSharesContourCache)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    auto contourCache = std::make_shared<persistence::ContourCache>();
+    persistence::Database<connection, connection_config> writer{config, contourCache};
+    persistence::Database<connection, connection_config> reader{
+        std::make_shared<connection_config>(DATABASE_NAME, SQLITE_OPEN_READONLY, "", true), 
+        contourCache};
+
+    writer.upsert(persistence::Data{1900, {country}});
+
+    EXPECT_EQ(reader.load(1900), (persistence::Data{1900, {country}}));
+    // the border decoded by the reader is reused by the writer
+    EXPECT_EQ(writer.load(1900), (persistence::Data{1900, {country}}));
+    EXPECT_EQ(writer.getContourCacheStatistics().hits, 1);
+
+    auto data = writer.load(1900);
+    data.countries.front().borderContour.update(0, persistence::Coordinate{5,6});
+    writer.upsert(data);
+
+    // the reader doesn't see the stale contour
+    EXPECT_EQ(reader.load(1900), data);
+}
+
+TEST_F(DatabaseTest, ModifySharedContour)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    database.upsert(persistence::Data{1900, {country}});
+    database.upsert(persistence::Data{1901, {country}});
+
+    auto data = database.load(1900);
+    data.countries.front().borderContour.update(0, persistence::Coordinate{5,6});
+    database.upsert(data);
+
+    EXPECT_EQ(database.load(1900), data);
+    // the other year and the cached contour are not affected
+    EXPECT_EQ(database.load(1901), (persistence::Data{1901, {country}}));
+}
+
+TEST(ContourCacheTest, DropLeastRecentlyUsed)
+{
+    persistence::ContourCache cache{3};
+    const persistence::Contour contour1{persistence::Coordinate{1,2}, persistence::Coordinate{3,4}};
+    const persistence::Contour contour2{persistence::Coordinate{5,6}};
+    const persistence::Contour contour3{persistence::Coordinate{7,8}};
+
+    cache.insert(1, contour1.share());
+    cache.insert(2, contour2.share());
+    EXPECT_EQ(cache.find(1), contour1.share());
+
+    cache.insert(3, contour3.share());
+
+    EXPECT_EQ(cache.find(1), contour1.share());
+    EXPECT_EQ(cache.find(2), nullptr);
+    EXPECT_EQ(cache.find(3), contour3.share());
+    EXPECT_EQ(cache.getSize(), 3);
+}
+
+TEST(ContourCacheTest, CopyOnWrite)
+{
+    const persistence::Contour contour{persistence::Coordinate{1,2}, persistence::Coordinate{3,4}};
+    auto copy = contour;
+
+    EXPECT_EQ(copy.share(), contour.share());
+
+    copy.emplace_back(persistence::Coordinate{5,6});
+
+    EXPECT_NE(copy.share(), contour.share());
+    EXPECT_EQ(contour.size(), 2);
+    EXPECT_EQ(copy.size(), 3);
+}
+
+TEST(ContourCacheTest, ModificationDropsHash)
+{
+    persistence::Contour contour{persistence::Coordinate{1,2}, persistence::Coordinate{3,4}};
+    const auto hash = util::hash128(persistence::serializeContour<persistence::Stream>(contour).view());
+    const auto withHash = [&contour, hash]() -> persistence::Contour& {
+        contour.setHash(hash);
+        return contour;
+    };
+
+    auto copy = withHash();
+    EXPECT_EQ(copy.getHash(), hash);
+
+    withHash().emplace_back(persistence::Coordinate{5,6});
+    EXPECT_FALSE(contour.getHash());
+    withHash().push_back(persistence::Coordinate{7,8});
+    EXPECT_FALSE(contour.getHash());
+    withHash().update(0, persistence::Coordinate{9,10});
+    EXPECT_FALSE(contour.getHash());
+    withHash().erase(contour.begin());
+    EXPECT_FALSE(contour.getHash());
+    withHash().reserve(10);
+    EXPECT_FALSE(contour.getHash());
+
+    // the copy keeps its points and hash
+    EXPECT_EQ(copy.getHash(), hash);
+}
+
+TEST_F(DatabaseTest, LoadRange)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::City city{"City", persistence::Coordinate{1,1}};
+    const persistence::Data data1900{1900, {country1, country2}, {city}, persistence::Note{"Note"}};
+    const persistence::Data data1902{1902, {country2, country1}};
+    const persistence::Data data1903{1903, {}, {city}};
+
+    database.upsert(data1900);
+    database.upsert(data1902);
+    database.upsert(data1903);
+
+    const auto range = database.load(1899, 1904);
+
+    EXPECT_EQ(range, (std::vector<persistence::Data>{persistence::Data{1899}, 
+                                                     data1900, 
+                                                     persistence::Data{1901}, 
+                                                     data1902, 
+                                                     data1903, 
+                                                     persistence::Data{1904}}));
+    // the borders kept by both years are decoded once
+    EXPECT_EQ(database.getContourCacheStatistics().misses, 2);
+}
+
+TEST_F(DatabaseTest, LoadEmptyRange)
+{
+    EXPECT_TRUE(database.load(1901, 1900).empty());
+}
+
+TEST_F(DatabaseTest, SaveRange)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country1Updated{"One", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{9,10}, persistence::Coordinate{11,12}}};
+    const persistence::City city1{"City1", persistence::Coordinate{1,1}};
+    const persistence::City city2{"City2", persistence::Coordinate{2,2}};
+
+    database.upsert(persistence::Data{1900, {country1, country2}, {city1}, persistence::Note{"Old"}});
+    database.upsert(persistence::Data{1903, {country1}, {city1}});
+
+    const persistence::Data data{0, {country1Updated}, {city2}, persistence::Note{"New"}};
+    const persistence::Data removed{0, {country2}, {city1}};
+    database.saveRange(data, removed, 1900, 1902);
+
+    EXPECT_EQ(database.load(1900), (persistence::Data{1900, {country1Updated}, {city2}, persistence::Note{"New"}}));
+    EXPECT_EQ(database.load(1901), (persistence::Data{1901, {country1Updated}, {city2}, persistence::Note{"New"}}));
+    EXPECT_EQ(database.load(1902), (persistence::Data{1902, {country1Updated}, {city2}, persistence::Note{"New"}}));
+    // the years out of the range are not affected
+    EXPECT_EQ(database.load(1903), (persistence::Data{1903, {country1}, {city1}}));
+
+    // the old note and the border of the removed country are not used anymore
+    EXPECT_TRUE(database.collectGarbage(100));
+
+    int notes = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::NOTES)).from(persistence::NOTES).unconditionally())) {
+        notes++;
+    }
+    EXPECT_EQ(notes, 1);
+
+    int borders = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
+        borders++;
+    }
+    EXPECT_EQ(borders, 2);
+}
+
+TEST_F(DatabaseTest, SaveRangeReusesStatements)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::City city{"City", persistence::Coordinate{1,1}};
+    const persistence::Data data{0, {country}, {city}, persistence::Note{"Note"}};
+
+    database.saveRange(data, persistence::Data{}, 1900, 1902);
+    database.saveRange(data, data, 1903, 1905);
+
+    const auto before = database.getStatementStatistics();
+
+    database.saveRange(data, data, 1906, 1908);
+
+    const auto after = database.getStatementStatistics();
+
+    EXPECT_EQ(after.prepared, before.prepared);
+    EXPECT_GT(after.executed, before.executed);
+}
+
+TEST_F(DatabaseTest, CollectGarbageInSlices)
+{
+    const persistence::Country country1{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country country2{"Two", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::City city{"City", persistence::Coordinate{1,1}};
+    const persistence::Data data{1900, {country1, country2}, {city}, persistence::Note{"Note"}};
+
+    database.upsert(data);
+    database.upsert(persistence::Data{1901, {country1}});
+    database.remove(data);
+
+    // the rows stay until they are collected, but no year uses them
+    EXPECT_EQ(database.load(1900), persistence::Data{1900});
+    EXPECT_TRUE(database.loadCityList().empty());
+    EXPECT_FALSE(database.loadCity("City"));
+
+    // 2 borders, 2 countries, 1 city and 1 note, one row examined at a time
+    int slices = 1;
+    while (!database.collectGarbage(1)) {
+        slices++;
+    }
+    EXPECT_GE(slices, 6);
+
+    EXPECT_EQ(database.load(1901), (persistence::Data{1901, {country1}}));
+
+    int borders = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::BORDERS)).from(persistence::BORDERS).unconditionally())) {
+        borders++;
+    }
+    EXPECT_EQ(borders, 1);
+
+    int countries = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::COUNTRIES)).from(persistence::COUNTRIES).unconditionally())) {
+        countries++;
+    }
+    EXPECT_EQ(countries, 1);
+
+    int cities = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::CITIES)).from(persistence::CITIES).unconditionally())) {
+        cities++;
+    }
+    EXPECT_EQ(cities, 0);
+
+    int notes = 0;
+    for ([[maybe_unused]] const auto& row : monitor(sqlpp::select(all_of(persistence::NOTES)).from(persistence::NOTES).unconditionally())) {
+        notes++;
+    }
+    EXPECT_EQ(notes, 0);
+}
+
+TEST_F(DatabaseTest, ReuseRowWaitingForCollection)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::City city{"City", persistence::Coordinate{1,1}};
+    const persistence::Data data{1900, {country}, {city}, persistence::Note{"Note"}};
+
+    database.upsert(data);
+    database.remove(data);
+    database.upsert(data);
+
+    EXPECT_TRUE(database.collectGarbage(100));
+    EXPECT_EQ(database.load(1900), data);
+}
+
+TEST_F(DatabaseTest, LoadInBoundingBox)
+{
+    const persistence::Country west{"West", {persistence::Coordinate{0,0}, persistence::Coordinate{0,10}, persistence::Coordinate{10,10}, persistence::Coordinate{10,0}}};
+    const persistence::Country east{"East", {persistence::Coordinate{0,100}, persistence::Coordinate{0,110}, persistence::Coordinate{10,110}, persistence::Coordinate{10,100}}};
+    const persistence::City westCity{"WestCity", persistence::Coordinate{5,5}};
+    const persistence::City eastCity{"EastCity", persistence::Coordinate{5,105}};
+    const persistence::Note note{"Note"};
+
+    database.upsert(persistence::Data{1900, {west, east}, {westCity, eastCity}, note});
+
+    EXPECT_EQ(database.load(1900, persistence::BoundingBox{-5, -5, 20, 20}), (persistence::Data{1900, {west}, {westCity}, note}));
+    EXPECT_EQ(database.load(1900, persistence::BoundingBox{105, 8, 120, 20}), (persistence::Data{1900, {east}, {}, note}));
+    EXPECT_EQ(database.load(1900, persistence::BoundingBox{-180, -90, 180, 90}), (persistence::Data{1900, {west, east}, {westCity, eastCity}, note}));
+    EXPECT_EQ(database.load(1900, persistence::BoundingBox{50, 50, 60, 60}), (persistence::Data{1900, {}, {}, note}));
+    // the border outside is not read
+    EXPECT_EQ(database.getContourCacheStatistics().misses, 2);
+}
+
+TEST_F(DatabaseTest, LoadCountriesAt)
+{
+    // a triangle whose bounding box covers (8, 2) but not the triangle itself
+    const persistence::Country triangle{"Triangle", {persistence::Coordinate{0,0}, persistence::Coordinate{10,0}, persistence::Coordinate{0,10}}};
+    const persistence::Country square{"Square", {persistence::Coordinate{0,0}, persistence::Coordinate{0,10}, persistence::Coordinate{10,10}, persistence::Coordinate{10,0}}};
+
+    database.upsert(persistence::Data{1900, {triangle, square}});
+
+    EXPECT_EQ(database.loadCountriesAt(1900, persistence::Coordinate{2, 2}), (std::vector<persistence::Country>{triangle, square}));
+    EXPECT_EQ(database.loadCountriesAt(1900, persistence::Coordinate{8, 8}), (std::vector<persistence::Country>{square}));
+    EXPECT_TRUE(database.loadCountriesAt(1900, persistence::Coordinate{20, 20}).empty());
+    EXPECT_TRUE(database.loadCountriesAt(1901, persistence::Coordinate{2, 2}).empty());
+}
+
+TEST_F(DatabaseTest, MaintainSpatialIndex)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{0,0}, persistence::Coordinate{0,10}, persistence::Coordinate{10,10}, persistence::Coordinate{10,0}}};
+    const persistence::Country moved{"One", {persistence::Coordinate{50,50}, persistence::Coordinate{50,60}, persistence::Coordinate{60,60}, persistence::Coordinate{60,50}}};
+    const persistence::City city{"City", persistence::Coordinate{5,5}};
+    const persistence::City movedCity{"City", persistence::Coordinate{55,55}};
+    const persistence::BoundingBox bbox{40, 40, 70, 70};
+
+    database.upsert(persistence::Data{1900, {country}, {city}});
+    EXPECT_EQ(database.load(1900, bbox), persistence::Data{1900});
+
+    database.upsert(persistence::Data{1900, {moved}, {movedCity}});
+    EXPECT_EQ(database.load(1900, bbox), (persistence::Data{1900, {moved}, {movedCity}}));
+
+    database.remove(persistence::Data{1900, {moved}, {movedCity}});
+    EXPECT_TRUE(database.collectGarbage(100));
+    EXPECT_EQ(database.load(1900, bbox), persistence::Data{1900});
+
+    // the bounding boxes of the collected border and city are removed as well
+    for (const auto table : {"borderBounds", "cityBounds"}) {
+        persistence::SqliteStatement count{monitor.native_handle(), std::string{"SELECT count(*) FROM "} + table + ";"};
+        EXPECT_TRUE(count.step());
+        EXPECT_EQ(count.getInt(0), 0);
+    }
+}
+
+TEST_F(DatabaseTest, BuildSpatialIndexOfExistingDatabase)
+{
+    const persistence::Country country{"One", {persistence::Coordinate{0,0}, persistence::Coordinate{0,10}, persistence::Coordinate{10,10}, persistence::Coordinate{10,0}}};
+    const persistence::City city{"City", persistence::Coordinate{5,5}};
+    const persistence::Data data{1900, {country}, {city}};
+
+    database.upsert(data);
+    // a file created before the spatial index
+    monitor.execute("DROP TABLE borderBounds");
+    monitor.execute("DROP TABLE cityBounds");
+
+    persistence::Database<connection, connection_config> reopened{config};
+
+    EXPECT_EQ(reopened.load(1900, persistence::BoundingBox{0, 0, 10, 10}), data);
+}
+
+TEST_F(DatabaseTest, SearchNotesAndNames)
+{
+    const persistence::Country country{"Great Han", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::City city{"Hanzhong", persistence::Coordinate{1,1}};
+
+    database.upsert(persistence::Data{1900, {country}, {}, persistence::Note{"The battle of Gaixia"}});
+    database.upsert(persistence::Data{1901, {}, {city}, persistence::Note{"A battle, another battle and the battle of Julu"}});
+
+    using Kind = persistence::SearchHit::Kind;
+
+    const auto battles = database.search("battle", 10);
+    ASSERT_EQ(battles.size(), 2);
+    // the note mentioning it more often ranks first
+    EXPECT_EQ(battles[0].year, 1901);
+    EXPECT_EQ(battles[0].kind, Kind::NOTE);
+    EXPECT_NE(battles[0].snippet.find("Julu"), std::string::npos);
+    EXPECT_NE(battles[0].snippet.find('['), std::string::npos);
+    EXPECT_EQ(battles[1].year, 1900);
+
+    // all the terms have to be found
+    EXPECT_EQ(database.search("battle Gaixia", 10).size(), 1);
+    EXPECT_EQ(database.search("battle Waterloo", 10).size(), 0);
+
+    const auto han = database.search("Han", 10);
+    ASSERT_EQ(han.size(), 2);
+    EXPECT_TRUE(std::ranges::any_of(han, [](const auto& hit){ return hit.kind == Kind::COUNTRY && hit.name == "Great Han" && hit.year == 1900; }));
+    EXPECT_TRUE(std::ranges::any_of(han, [](const auto& hit){ return hit.kind == Kind::CITY && hit.name == "Hanzhong" && hit.year == 1901; }));
+
+    EXPECT_EQ(database.search("battle", 1).size(), 1);
+    EXPECT_TRUE(database.search("  ", 10).empty());
+}
+
+TEST_F(DatabaseTest, SearchShortTerm)
+{
+    const persistence::Country country{"秦", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    database.upsert(persistence::Data{-221, {country}, {}, persistence::Note{"秦灭六国"}});
+
+    // shorter than a trigram, searched as a substring
+    const auto hits = database.search("秦", 10);
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[0].year, -221);
+    EXPECT_EQ(database.search("灭六国", 10).size(), 1);
+    // the LIKE wildcards are matched literally
+    EXPECT_TRUE(database.search("%", 10).empty());
+}
+
+TEST_F(DatabaseTest, SearchSkipsRemovedEntities)
+{
+    const persistence::Data data{1900, {}, {persistence::City{"Chang'an", persistence::Coordinate{1,1}}}, persistence::Note{"The capital"}};
+
+    database.upsert(data);
+    EXPECT_EQ(database.search("capital", 10).size(), 1);
+    EXPECT_EQ(database.search("Chang'an", 10).size(), 1);
+
+    database.remove(data);
+    EXPECT_TRUE(database.search("capital", 10).empty());
+    EXPECT_TRUE(database.search("Chang'an", 10).empty());
+
+    // the collected rows are dropped from the index by the triggers
+    EXPECT_TRUE(database.collectGarbage(100));
+    persistence::SqliteStatement count{monitor.native_handle(), "SELECT count(*) FROM noteSearch WHERE noteSearch MATCH 'capital';"};
+    EXPECT_TRUE(count.step());
+    EXPECT_EQ(count.getInt(0), 0);
+}
+
+TEST_F(DatabaseTest, BuildSearchIndexOfExistingDatabase)
+{
+    database.upsert(persistence::Data{1900, {}, {}, persistence::Note{"The battle of Gaixia"}});
+    // a file created before the search index
+    for (const auto table : {"noteSearch", "countrySearch", "citySearch"}) {
+        monitor.execute(std::string{"DROP TABLE "} + table);
+    }
+
+    persistence::Database<connection, connection_config> reopened{config};
+
+    EXPECT_EQ(reopened.search("Gaixia", 10).size(), 1);
+}
+
+TEST_F(DatabaseTest, LoadCountryTimeline)
+{
+    const persistence::Country first{"One", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+    const persistence::Country second{"One", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+    const persistence::Country other{"Two", {persistence::Coordinate{5,6}, persistence::Coordinate{7,8}}};
+
+    for (const int year : {-2, -1, 1, 2}) {
+        database.upsert(persistence::Data{year, {first}});
+    }
+    database.upsert(persistence::Data{3, {second}});
+    // the country is missing in 4
+    database.upsert(persistence::Data{4, {other}});
+    for (const int year : {5, 6}) {
+        database.upsert(persistence::Data{year, {first}});
+    }
+    database.upsert(persistence::Data{7, {second}});
+
+    const auto timeline = database.loadCountryTimeline("One");
+
+    EXPECT_EQ(timeline, (std::vector<persistence::BorderPeriod>{
+        {-2, 2, first.borderContour},
+        {3, 3, second.borderContour},
+        {5, 6, first.borderContour},
+        {7, 7, second.borderContour}
+    }));
+    // each border is decoded once and shared by its periods
+    EXPECT_EQ(database.getContourCacheStatistics().misses, 2);
+    EXPECT_EQ(timeline[0].borderContour.share(), timeline[2].borderContour.share());
+
+    EXPECT_TRUE(database.loadCountryTimeline("Three").empty());
+}
+
+TEST_F(DatabaseTest, StampChangedYears)
+{
+    const persistence::City city{"city", persistence::Coordinate{1, 2}};
+    const persistence::Country country{"country", {persistence::Coordinate{1,2}, persistence::Coordinate{3,4}}};
+
+    // nothing is stamped until the revisions are tracked
+    database.upsert(persistence::Data{4, {country}, {city}});
+    EXPECT_EQ(database.getYearRevision(), 0);
+
+    database.setRevisionTracking(true);
+    database.upsert(persistence::Data{1, {country}, {city}});
+    database.upsert(persistence::Data{2, {}, {city}});
+    database.upsert(persistence::Data{3, {}, {}, persistence::Note{"note"}});
+    const auto revision = database.getYearRevision();
+
+    EXPECT_GT(revision, 0);
+    EXPECT_EQ(database.loadYearsChangedAfter(0), (std::vector<int>{1, 2, 3}));
+    EXPECT_TRUE(database.loadYearsChangedAfter(revision).empty());
+
+    // the same data doesn't change anything
+    database.upsert(persistence::Data{1, {country}, {city}});
+    EXPECT_EQ(database.getYearRevision(), revision);
+
+    database.remove(persistence::Data{3, {}, {}, persistence::Note{"note"}});
+    EXPECT_EQ(database.loadYearsChangedAfter(revision), std::vector<int>{3});
+
+    // the coordinate of a city is shared by the years using it
+    const auto removed = database.getYearRevision();
+    database.upsert(persistence::Data{2, {}, {persistence::City{"city", persistence::Coordinate{5, 6}}}});
+    EXPECT_EQ(database.loadYearsChangedAfter(removed), (std::vector<int>{1, 2, 4}));
+
+    const auto tracked = database.getYearRevision();
+    database.setRevisionTracking(false);
+    database.remove(persistence::Data{2, {}, {persistence::City{"city", persistence::Coordinate{5, 6}}}});
+    EXPECT_EQ(database.getYearRevision(), tracked);
+}
+}
@@ -0,0 +1,89 @@
+#include "src/persistence/HistoricalCache.h"
+#include "src/persistence/Data.h"
+
+#include <gtest/gtest.h>
+#include <list>
+
+namespace {
+const persistence::Data INFO{
+    1,
+    std::list<persistence::Country>{
+        persistence::Country{"Han", persistence::Contour{{1, 2}, {3, 4}}},
+        persistence::Country{"Qin", persistence::Contour{{5, 6}, {7, 8}}}
+    },
+    std::list<persistence::City>{
+        persistence::City{"Luoyang", persistence::Coordinate{1, 1}},
+        persistence::City{"Xianyang", persistence::Coordinate{2, 2}}
+    },
+    persistence::Note{"note"}
+};
+
+TEST(HistoricalCacheTest, NoChangesAfterLoad)
+{
+    const persistence::HistoricalCache cache{INFO};
+    const auto changes = cache.getChanges();
+
+    EXPECT_EQ(changes.modified, persistence::Data{INFO.year});
+    EXPECT_EQ(changes.removed, persistence::Data{INFO.year});
+}
+
+TEST(HistoricalCacheTest, TrackChanges)
+{
+    persistence::HistoricalCache cache{INFO};
+
+    cache.getCountry("Han").borderContour.push_back(persistence::Coordinate{9, 10});
+    cache.removeCity("Xianyang");
+    cache.addCity(persistence::City{"Chang'an", persistence::Coordinate{3, 3}});
+
+    const auto changes = cache.getChanges();
+    const auto& han = cache.getData().countries.front();
+
+    EXPECT_EQ(changes.modified, (persistence::Data{
+        INFO.year,
+        std::list<persistence::Country>{han},
+        std::list<persistence::City>{persistence::City{"Chang'an", persistence::Coordinate{3, 3}}},
+    }));
+    EXPECT_EQ(changes.removed, (persistence::Data{
+        INFO.year,
+        std::list<persistence::Country>{},
+        std::list<persistence::City>{persistence::City{"Xianyang", persistence::Coordinate{2, 2}}},
+    }));
+}
+
+TEST(HistoricalCacheTest, AddBackRemovedCountry)
+{
+    persistence::HistoricalCache cache{INFO};
+
+    cache.removeCountry("Qin");
+    cache.addCountry(persistence::Country{"Qin", persistence::Contour{{1, 1}, {2, 2}}});
+
+    const auto changes = cache.getChanges();
+
+    EXPECT_TRUE(changes.removed.countries.empty());
+    EXPECT_EQ(changes.modified.countries, 
+              (std::list<persistence::Country>{persistence::Country{"Qin", persistence::Contour{{1, 1}, {2, 2}}}}));
+}
+
+TEST(HistoricalCacheTest, MarkSaved)
+{
+    persistence::HistoricalCache cache{INFO};
+
+    cache.getNote().text = "changed";
+    cache.removeCountry("Qin");
+    cache.setModificationState(true);
+
+    const auto changes = cache.getChanges();
+    EXPECT_EQ(changes.modified.note, persistence::Note{"changed"});
+
+    // changed after the changes are taken, they are kept for the next save
+    cache.getCity("Luoyang").coordinate = persistence::Coordinate{4, 4};
+    EXPECT_FALSE(cache.markSaved(changes.revision));
+    EXPECT_TRUE(cache.isMidified());
+    EXPECT_EQ(cache.getChanges().removed.countries.size(), 1);
+
+    EXPECT_TRUE(cache.markSaved(cache.getChanges().revision));
+    EXPECT_FALSE(cache.isMidified());
+    EXPECT_EQ(cache.getChanges().modified, persistence::Data{INFO.year});
+    EXPECT_EQ(cache.getChanges().removed, persistence::Data{INFO.year});
+}
+}
@@ -3,6 +3,10 @@
 
 #include <gtest/gtest.h>
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <set>
 #include <string>
 
 namespace {
@@ -30,7 +34,7 @@ TEST_F(JsonExporterImporterTest, ExportAndImport)
             std::list<persistence::Country>{
                 persistence::Country{
                     "A",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             1.1f, 
                             2.1f
@@ -43,7 +47,7 @@ TEST_F(JsonExporterImporterTest, ExportAndImport)
                 },
                 persistence::Country{
                     "B",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             2.1f, 
                             3.1f
@@ -78,7 +82,7 @@ TEST_F(JsonExporterImporterTest, ExportAndImport)
             std::list<persistence::Country>{
                 persistence::Country{
                     "A",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             11.1f, 
                             21.1f
@@ -91,7 +95,7 @@ TEST_F(JsonExporterImporterTest, ExportAndImport)
                 },
                 persistence::Country{
                     "B",
-                    std::list<persistence::Coordinate>{
+                    persistence::Contour{
                         persistence::Coordinate{
                             21.1f, 
                             31.1f
@@ -136,7 +140,7 @@ TEST_F(JsonExporterImporterTest, ExportAndImport)
     std::vector<persistence::Data> readback;
 
     if (auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT); importer) {
-        auto loader = importer.value()->loadFromFile(FILE_NAME);
+        auto loader = importer.value()->loadFromFile(FILE_NAME, true);
 
         while (loader.next()) {
             if (const auto& ret = loader.getValue(); ret) {
@@ -186,7 +190,7 @@ TEST_F(JsonExporterImporterTest, ReadFileNotExists)
 {
     auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
 
-    auto loader = importer.value()->loadFromFile(FILE_NAME);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, true);
     
     loader.next();
 
@@ -196,7 +200,7 @@ TEST_F(JsonExporterImporterTest, ReadFileNotExists)
 TEST_F(JsonExporterImporterTest, IncorrectJsonFormat)
 {
     if (auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT); importer) {
-        auto loader = importer.value()->loadFromFile("incorrectJson.json");
+        auto loader = importer.value()->loadFromFile("incorrectJson.json", true);
         std::optional<util::Error> error;
 
         while (loader.next()) {
@@ -217,4 +221,126 @@ TEST_F(JsonExporterImporterTest, IncorrectJsonFormat)
         EXPECT_TRUE(false); 
     }
 }
-}
\ No newline at end of file
+
+TEST_F(JsonExporterImporterTest, YieldBeforeSyntaxError)
+{
+    {
+        std::ofstream file{FILE_NAME};
+        file << R"({"author": "", "historical_info": [{"year": 1, "countries": [], "cities": [{"name": "A", "coordinate": {"latitude": 1.0, "longitude": 2.0}}]}, {"year": 2, )";
+    }
+
+    auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, true);
+
+    ASSERT_TRUE(loader.next());
+    EXPECT_EQ(loader.getValue(), (persistence::Data{
+        1,
+        std::list<persistence::Country>{},
+        std::list<persistence::City>{persistence::City{"A", persistence::Coordinate{1.0f, 2.0f}}}
+    }));
+
+    ASSERT_TRUE(loader.next());
+    EXPECT_EQ(loader.getValue().error().code, util::ErrorCode::PARSE_FILE_ERROR);
+
+    EXPECT_FALSE(loader.next());
+}
+
+TEST_F(JsonExporterImporterTest, SyntaxErrorOutsideOfYears)
+{
+    {
+        std::ofstream file{FILE_NAME};
+        file << R"({"historical_info": [{"year": 1, "countries": [], "cities": [], "note": {"text": "{\"}"}}] "author": ""})";
+    }
+
+    auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, true);
+
+    ASSERT_TRUE(loader.next());
+    EXPECT_EQ(loader.getValue(), (persistence::Data{1, {}, {}, persistence::Note{"{\"}"}}));
+
+    ASSERT_TRUE(loader.next());
+    EXPECT_EQ(loader.getValue().error().code, util::ErrorCode::PARSE_FILE_ERROR);
+
+    EXPECT_FALSE(loader.next());
+}
+
+TEST_F(JsonExporterImporterTest, StopLoading)
+{
+    if (auto exporter = persistence::ExporterImporterFactory::getInstance().createExporter(FORMAT); exporter) {
+        for (int year = 0; year < 10; year++) {
+            exporter.value()->insert(persistence::Data{year});
+        }
+
+        EXPECT_TRUE(exporter.value()->writeToFile(FILE_NAME, false));
+    }
+
+    auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, true);
+
+    ASSERT_TRUE(loader.next());
+    EXPECT_EQ(loader.getValue().value().year, 0);
+    // the rest of the file is not parsed once the loader is dropped
+}
+
+TEST_F(JsonExporterImporterTest, UnorderedLoading)
+{
+    std::set<int> years;
+    if (auto exporter = persistence::ExporterImporterFactory::getInstance().createExporter(FORMAT); exporter) {
+        for (int year = -500; year < 500; year++) {
+            exporter.value()->insert(persistence::Data{year, std::list<persistence::Country>{persistence::Country{"A", persistence::Contour{{1, 2}}}}});
+            years.emplace(year);
+        }
+
+        EXPECT_TRUE(exporter.value()->writeToFile(FILE_NAME, false));
+    }
+
+    auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, false);
+    std::set<int> readback;
+
+    while (loader.next()) {
+        if (const auto& ret = loader.getValue(); ret) {
+            EXPECT_TRUE(readback.emplace(ret.value().year).second);
+        } else {
+            EXPECT_TRUE(false);
+        }
+    }
+
+    EXPECT_EQ(readback, years);
+}
+
+TEST_F(JsonExporterImporterTest, UnorderedLoadingTruncatedFile)
+{
+    if (auto exporter = persistence::ExporterImporterFactory::getInstance().createExporter(FORMAT); exporter) {
+        for (int year = 0; year < 100; year++) {
+            exporter.value()->insert(persistence::Data{year, std::list<persistence::Country>{persistence::Country{"A", persistence::Contour{{1, 2}}}}});
+        }
+
+        EXPECT_TRUE(exporter.value()->writeToFile(FILE_NAME, false));
+    }
+
+    // cut the file in the middle of the last year
+    const auto size = std::filesystem::file_size(FILE_NAME);
+    std::filesystem::resize_file(FILE_NAME, size - 100);
+
+    auto importer = persistence::ExporterImporterFactory::getInstance().createImporter(FORMAT);
+    auto loader = importer.value()->loadFromFile(FILE_NAME, false);
+    std::set<int> readback;
+    std::optional<util::Error> error;
+
+    while (loader.next()) {
+        if (const auto& ret = loader.getValue(); ret) {
+            EXPECT_FALSE(error);
+            EXPECT_TRUE(readback.emplace(ret.value().year).second);
+        } else {
+            error = ret.error();
+        }
+    }
+
+    // the error comes after all the complete years
+    ASSERT_TRUE(error);
+    EXPECT_EQ(error->code, util::ErrorCode::PARSE_FILE_ERROR);
+    EXPECT_EQ(readback.size(), 99);
+    EXPECT_FALSE(readback.contains(99));
+}
+}
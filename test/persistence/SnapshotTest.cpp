@@ -0,0 +1,169 @@
+#include "src/persistence/Snapshot.h"
+#include "src/persistence/Data.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr auto FILE_NAME = "snapshotTest.snapshot";
+constexpr auto NEXT_FILE_NAME = "snapshotTest.next.snapshot";
+
+persistence::Data makeData(int year, const std::string& country)
+{
+    return persistence::Data{year, std::list<persistence::Country>{persistence::Country{country, persistence::Contour{{1, 2}, {3, 4}}}}};
+}
+
+class SnapshotTest : public ::testing::Test {
+public:
+    SnapshotTest()
+    {
+        std::remove(FILE_NAME);
+        std::remove(NEXT_FILE_NAME);
+    }
+
+    ~SnapshotTest()
+    {
+        std::remove(FILE_NAME);
+        std::remove(NEXT_FILE_NAME);
+    }
+};
+
+TEST_F(SnapshotTest, WriteAndLoad)
+{
+    const persistence::Contour border{{1, 2}, {3, 4}, {5, 6}};
+    const std::vector<persistence::Data> infos{
+        persistence::Data{
+            -200,
+            std::list<persistence::Country>{
+                persistence::Country{"Han", border},
+                persistence::Country{"Xiongnu", persistence::Contour{{7, 8}}}
+            },
+            std::list<persistence::City>{persistence::City{"Chang'an", persistence::Coordinate{34.2, 108.9}}},
+            persistence::Note{"note"}
+        },
+        persistence::Data{-199},
+        persistence::Data{
+            -198,
+            std::list<persistence::Country>{persistence::Country{"Han", border}},
+            std::list<persistence::City>{},
+            persistence::Note{"note"}
+        }
+    };
+
+    persistence::Snapshot::Writer writer{FILE_NAME, 42};
+    for (const auto& info : infos) {
+        writer.add(info);
+    }
+    ASSERT_TRUE(writer.finish());
+
+    const auto snapshot = persistence::Snapshot::open(FILE_NAME);
+    ASSERT_NE(snapshot, nullptr);
+
+    EXPECT_EQ(snapshot->getRevision(), 42);
+    EXPECT_EQ(snapshot->getYearList(), (std::vector<int>{-200, -198}));
+
+    for (const auto& info : infos) {
+        EXPECT_EQ(snapshot->loadData(info.year), info);
+    }
+    EXPECT_EQ(snapshot->loadData(1), persistence::Data{1});
+
+    // the border kept by both years is stored once and viewed in place
+    const auto view = snapshot->load(-200);
+    EXPECT_EQ(view.countries.front().name, "Han");
+    EXPECT_EQ(view.countries.front().border.data(), snapshot->load(-198).countries.front().border.data());
+    EXPECT_EQ(view.note, "note");
+
+    // the copy of its points is shared by the loaded years
+    EXPECT_EQ(snapshot->loadData(-200).countries.front().borderContour.share(),
+              snapshot->loadData(-198).countries.front().borderContour.share());
+    EXPECT_GT(snapshot->getContourCacheStatistics().hits, 0u);
+}
+
+TEST_F(SnapshotTest, Sections)
+{
+    persistence::Snapshot::Writer writer{FILE_NAME, 1};
+    for (const auto year : {-129, -128, -1, 0, 127, 128}) {
+        writer.add(makeData(year, std::to_string(year)));
+    }
+    ASSERT_TRUE(writer.finish());
+
+    const auto snapshot = persistence::Snapshot::open(FILE_NAME);
+    ASSERT_NE(snapshot, nullptr);
+
+    EXPECT_EQ(snapshot->getSectionList(), (std::vector<int>{-2, -1, 0, 1}));
+    EXPECT_EQ(snapshot->getYearList(), (std::vector<int>{-129, -128, -1, 0, 127, 128}));
+    for (const auto year : {-129, -128, -1, 0, 127, 128}) {
+        EXPECT_EQ(snapshot->loadData(year), makeData(year, std::to_string(year)));
+    }
+    EXPECT_EQ(snapshot->loadData(129), persistence::Data{129});
+}
+
+TEST_F(SnapshotTest, CopySection)
+{
+    {
+        persistence::Snapshot::Writer writer{FILE_NAME, 1};
+        writer.add(makeData(1, "Qin"));
+        writer.add(makeData(2, "Qin"));
+        writer.add(makeData(200, "Han"));
+        ASSERT_TRUE(writer.finish());
+    }
+    const auto snapshot = persistence::Snapshot::open(FILE_NAME);
+    ASSERT_NE(snapshot, nullptr);
+
+    // the first section is unchanged, the second one is written again
+    persistence::Snapshot::Writer writer{NEXT_FILE_NAME, 2};
+    writer.copy(*snapshot, 0);
+    writer.add(makeData(201, "Xin"));
+    writer.copy(*snapshot, 5);
+    ASSERT_TRUE(writer.finish());
+
+    const auto next = persistence::Snapshot::open(NEXT_FILE_NAME);
+    ASSERT_NE(next, nullptr);
+    EXPECT_EQ(next->getRevision(), 2);
+    EXPECT_EQ(next->getYearList(), (std::vector<int>{1, 2, 201}));
+    EXPECT_EQ(next->loadData(1), makeData(1, "Qin"));
+    EXPECT_EQ(next->loadData(2), makeData(2, "Qin"));
+    EXPECT_EQ(next->loadData(200), persistence::Data{200});
+    EXPECT_EQ(next->loadData(201), makeData(201, "Xin"));
+}
+
+TEST_F(SnapshotTest, UnfinishedWriter)
+{
+    {
+        persistence::Snapshot::Writer writer{FILE_NAME, 1};
+        writer.add(makeData(1, "Qin"));
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(FILE_NAME));
+    EXPECT_FALSE(std::filesystem::exists(std::string{FILE_NAME} + ".tmp"));
+}
+
+TEST_F(SnapshotTest, OpenMissingFile)
+{
+    EXPECT_EQ(persistence::Snapshot::open(FILE_NAME), nullptr);
+}
+
+TEST_F(SnapshotTest, OpenCorruptedFile)
+{
+    {
+        persistence::Snapshot::Writer writer{FILE_NAME, 1};
+        writer.add(makeData(1, "Qin"));
+        ASSERT_TRUE(writer.finish());
+    }
+
+    // truncated
+    std::filesystem::resize_file(FILE_NAME, std::filesystem::file_size(FILE_NAME) - 1);
+    EXPECT_EQ(persistence::Snapshot::open(FILE_NAME), nullptr);
+
+    {
+        std::ofstream file{FILE_NAME, std::ios::binary | std::ios::trunc};
+        file << "not a snapshot";
+    }
+    EXPECT_EQ(persistence::Snapshot::open(FILE_NAME), nullptr);
+}
+}
@@ -0,0 +1,128 @@
+#include "src/tile/TileDiskCache.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr auto FILE_NAME = "tileDiskCacheTest.db";
+constexpr auto SOURCE = "https://tile.example.com/{z}/{x}/{y}.png";
+constexpr uint64_t MAX_SIZE = 1000;
+
+tile::TileDiskCache::Entry makeEntry(size_t size, std::byte value = std::byte{1})
+{
+    return {std::vector<std::byte>(size, value), "\"etag\"", "Wed, 21 Oct 2015 07:28:00 GMT", 100};
+}
+
+class TileDiskCacheTest : public ::testing::Test {
+public:
+    TileDiskCacheTest()
+    {
+        remove();
+    }
+
+    ~TileDiskCacheTest()
+    {
+        remove();
+    }
+
+private:
+    void remove()
+    {
+        std::remove(FILE_NAME);
+        std::remove((std::string{FILE_NAME} + "-wal").c_str());
+        std::remove((std::string{FILE_NAME} + "-shm").c_str());
+    }
+};
+
+TEST_F(TileDiskCacheTest, StoreAndFind)
+{
+    tile::TileDiskCache cache{FILE_NAME, MAX_SIZE};
+
+    EXPECT_FALSE(cache.find(SOURCE, {1, 2, 3}));
+
+    cache.store(SOURCE, {1, 2, 3}, makeEntry(10));
+
+    const auto entry = cache.find(SOURCE, {1, 2, 3});
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->data, makeEntry(10).data);
+    EXPECT_EQ(entry->etag, "\"etag\"");
+    EXPECT_EQ(entry->lastModified, "Wed, 21 Oct 2015 07:28:00 GMT");
+    EXPECT_EQ(entry->validated, 100);
+
+    EXPECT_FALSE(cache.contains("other source", {1, 2, 3}));
+    EXPECT_FALSE(cache.contains(SOURCE, {2, 1, 3}));
+
+    // replaced
+    cache.store(SOURCE, {1, 2, 3}, makeEntry(20, std::byte{2}));
+    EXPECT_EQ(cache.find(SOURCE, {1, 2, 3})->data, makeEntry(20, std::byte{2}).data);
+    EXPECT_EQ(cache.getSize(), 20u);
+}
+
+TEST_F(TileDiskCacheTest, Revalidate)
+{
+    tile::TileDiskCache cache{FILE_NAME, MAX_SIZE};
+    cache.store(SOURCE, {1, 2, 3}, makeEntry(10));
+
+    cache.revalidate(SOURCE, {1, 2, 3}, 200);
+
+    EXPECT_EQ(cache.find(SOURCE, {1, 2, 3})->validated, 200);
+}
+
+TEST_F(TileDiskCacheTest, EvictLeastRecentlyUsed)
+{
+    tile::TileDiskCache cache{FILE_NAME, MAX_SIZE};
+
+    for (int x = 0; x < 4; x++) {
+        cache.store(SOURCE, {x, 0, 1}, makeEntry(200));
+    }
+
+    // used recently
+    EXPECT_TRUE(cache.find(SOURCE, {0, 0, 1}));
+
+    cache.store(SOURCE, {4, 0, 1}, makeEntry(300));
+
+    EXPECT_LE(cache.getSize(), MAX_SIZE);
+    EXPECT_TRUE(cache.contains(SOURCE, {0, 0, 1}));
+    EXPECT_FALSE(cache.contains(SOURCE, {1, 0, 1}));
+    EXPECT_TRUE(cache.contains(SOURCE, {4, 0, 1}));
+
+    cache.setMaxSize(400);
+    EXPECT_EQ(cache.getSize(), 300u);
+    EXPECT_TRUE(cache.contains(SOURCE, {4, 0, 1}));
+}
+
+TEST_F(TileDiskCacheTest, KeptAfterReopen)
+{
+    {
+        tile::TileDiskCache cache{FILE_NAME, MAX_SIZE};
+        cache.store(SOURCE, {1, 2, 3}, makeEntry(10));
+    }
+
+    tile::TileDiskCache cache{FILE_NAME, MAX_SIZE};
+    EXPECT_EQ(cache.getSize(), 10u);
+    EXPECT_TRUE(cache.find(SOURCE, {1, 2, 3}));
+}
+
+TEST_F(TileDiskCacheTest, EvictionShrinksFile)
+{
+    constexpr uint64_t LARGE_SIZE = 1 << 22;
+    {
+        tile::TileDiskCache cache{FILE_NAME, LARGE_SIZE};
+        for (int x = 0; x < 64; x++) {
+            cache.store(SOURCE, {x, 0, 6}, makeEntry(1 << 14));
+        }
+    }
+    const auto fullSize = std::filesystem::file_size(FILE_NAME);
+
+    {
+        tile::TileDiskCache cache{FILE_NAME, LARGE_SIZE};
+        cache.setMaxSize(1 << 14);
+        EXPECT_LE(cache.getSize(), 1u << 14);
+    }
+
+    EXPECT_LT(std::filesystem::file_size(FILE_NAME), fullSize / 4);
+}
+}
@@ -0,0 +1,258 @@
+#include "src/tile/TileExecutor.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace {
+using namespace std::chrono_literals;
+
+constexpr size_t FETCH_WORKERS = 2;
+constexpr size_t DECODE_WORKERS = 1;
+const int FIRST_MAP = 0;
+const int SECOND_MAP = 1;
+
+class FakeSource: public tile::TileSource {
+public:
+    std::vector<std::byte> request(const tile::Coordinate& coord, const std::atomic_bool&) override
+    {
+        const auto running = ++fetching;
+        for (auto max = maxFetching.load(); running > max && !maxFetching.compare_exchange_weak(max, running);) {
+        }
+
+        std::this_thread::sleep_for(1ms);
+        fetching--;
+
+        if (coord.z < 0) {
+            return {};
+        }
+
+        return {static_cast<std::byte>(coord.x)};
+    }
+
+    void stop() override {}
+    void restart() override {}
+
+    std::atomic<size_t> fetching = 0;
+    std::atomic<size_t> maxFetching = 0;
+};
+
+class FakeEngine: public tile::TileEngine {
+public:
+    Image toImage(const std::vector<std::byte>& rawBlob) override
+    {
+        return {rawBlob, 1, 1, 1};
+    }
+};
+
+TEST(TileExecutorTest, LoadTiles)
+{
+    auto source = std::make_shared<FakeSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{FETCH_WORKERS, DECODE_WORKERS};
+
+    std::vector<std::future<std::optional<tile::TileExecutor::Image>>> futures;
+    for (int x = 0; x < 32; x++) {
+        futures.emplace_back(executor.submit({x, 0, 1}, source, engine));
+    }
+
+    for (int x = 0; x < 32; x++) {
+        const auto image = futures[x].get();
+        ASSERT_TRUE(image);
+        EXPECT_EQ(std::get<0>(*image), std::vector<std::byte>{static_cast<std::byte>(x)});
+    }
+
+    EXPECT_LE(source->maxFetching, FETCH_WORKERS);
+
+    const auto metrics = executor.getMetrics();
+    EXPECT_EQ(metrics.queuedFetches, 0u);
+    EXPECT_EQ(metrics.queuedDecodes, 0u);
+}
+
+TEST(TileExecutorTest, EmptyData)
+{
+    tile::TileExecutor executor{FETCH_WORKERS, DECODE_WORKERS};
+
+    EXPECT_FALSE(executor.submit({0, 0, -1}, std::make_shared<FakeSource>(), std::make_shared<FakeEngine>()).get());
+}
+
+TEST(TileExecutorTest, ClearQueuedTiles)
+{
+    auto source = std::make_shared<FakeSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{FETCH_WORKERS, DECODE_WORKERS};
+
+    std::vector<std::future<std::optional<tile::TileExecutor::Image>>> futures;
+    for (int x = 0; x < 256; x++) {
+        futures.emplace_back(executor.submit({x, 0, 1}, source, engine));
+    }
+
+    executor.clear();
+
+    // every request is resolved, the ones not started yet without an image
+    size_t dropped = 0;
+    for (auto& future : futures) {
+        if (!future.get()) {
+            dropped++;
+        }
+    }
+    EXPECT_GT(dropped, 0u);
+}
+
+TEST(TileExecutorTest, SetConcurrency)
+{
+    auto source = std::make_shared<FakeSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{FETCH_WORKERS, DECODE_WORKERS};
+
+    auto first = executor.submit({1, 0, 1}, source, engine);
+    executor.setConcurrency(1, 1);
+    auto second = executor.submit({2, 0, 1}, source, engine);
+
+    EXPECT_TRUE(first.get());
+    EXPECT_TRUE(second.get());
+}
+
+// blocks the first request until it is released, then records the order of the requests
+class BlockingSource: public tile::TileSource {
+public:
+    std::vector<std::byte> request(const tile::Coordinate& coord, const std::atomic_bool& canceled) override
+    {
+        if (first.exchange(false)) {
+            started.set_value();
+            released.get_future().wait();
+
+            if (waitCanceled) {
+                while (!canceled) {
+                    std::this_thread::sleep_for(1ms);
+                }
+                return {};
+            }
+        }
+
+        std::scoped_lock lk{lock};
+        order.emplace_back(coord);
+        return {std::byte{1}};
+    }
+
+    void stop() override {}
+    void restart() override {}
+
+    std::atomic_bool first = true;
+    bool waitCanceled = false;
+    std::promise<void> started;
+    std::promise<void> released;
+    std::mutex lock;
+    std::vector<tile::Coordinate> order;
+};
+
+TEST(TileExecutorTest, ViewportPriority)
+{
+    auto source = std::make_shared<BlockingSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{1, DECODE_WORKERS};
+
+    auto blocker = executor.submit({100, 100, 3}, source, engine);
+    source->started.get_future().wait();
+
+    std::vector<std::future<std::optional<tile::TileExecutor::Image>>> futures;
+    for (int x = 0; x < 7; x++) {
+        futures.emplace_back(executor.submit({x, 0, 3}, source, engine));
+    }
+    auto otherZoom = executor.submit({2, 0, 4}, source, engine);
+
+    // tiles 1 and 4 are just around the view, the rest out of it are dropped
+    executor.setViewport(&FIRST_MAP, {3, 2, 3, 0, 0});
+    source->released.set_value();
+
+    // fetched but canceled once it is out of the view
+    EXPECT_FALSE(blocker.get());
+    EXPECT_FALSE(otherZoom.get());
+    for (int x = 0; x < 7; x++) {
+        EXPECT_EQ(futures[x].get().has_value(), x >= 1 && x <= 4);
+    }
+
+    const std::vector<tile::Coordinate> expected{{100, 100, 3}, {2, 0, 3}, {3, 0, 3}, {1, 0, 3}, {4, 0, 3}};
+    EXPECT_EQ(source->order, expected);
+    EXPECT_EQ(executor.getMetrics().dropped, 4u);
+
+    // a request out of the view is dropped right away
+    EXPECT_FALSE(executor.submit({10, 10, 3}, source, engine).get());
+}
+
+TEST(TileExecutorTest, SetConcurrencyWithoutWaiting)
+{
+    auto source = std::make_shared<BlockingSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{1, DECODE_WORKERS};
+
+    auto blocked = executor.submit({1, 0, 1}, source, engine);
+    source->started.get_future().wait();
+
+    // the worker blocked in the transfer is replaced, the new ones take the next tile
+    executor.setConcurrency(2, 1);
+    EXPECT_EQ(executor.getFetchWorkers(), 2u);
+    EXPECT_TRUE(executor.submit({2, 0, 1}, source, engine).get());
+
+    source->released.set_value();
+    EXPECT_TRUE(blocked.get());
+}
+
+TEST(TileExecutorTest, CancelFetchingTile)
+{
+    auto source = std::make_shared<BlockingSource>();
+    source->waitCanceled = true;
+    tile::TileExecutor executor{1, DECODE_WORKERS};
+    executor.setViewport(&FIRST_MAP, {3, 0, 1, 0, 1});
+
+    auto future = executor.submit({1, 1, 3}, source, std::make_shared<FakeEngine>());
+    source->started.get_future().wait();
+    source->released.set_value();
+
+    executor.setViewport(&FIRST_MAP, {4, 0, 1, 0, 1});
+
+    EXPECT_FALSE(future.get());
+}
+
+TEST(TileExecutorTest, TwoViewports)
+{
+    auto source = std::make_shared<FakeSource>();
+    auto engine = std::make_shared<FakeEngine>();
+    tile::TileExecutor executor{1, DECODE_WORKERS};
+    const tile::Viewport first{3, 0, 3, 0, 3};
+    const tile::Viewport second{5, 20, 23, 20, 23};
+
+    std::vector<std::future<std::optional<tile::TileExecutor::Image>>> futures;
+    executor.setViewport(&FIRST_MAP, first);
+    executor.setViewport(&SECOND_MAP, second);
+    for (int x = 0; x <= 3; x++) {
+        for (int y = 0; y <= 3; y++) {
+            futures.emplace_back(executor.submit({x, y, 3}, source, engine));
+            futures.emplace_back(executor.submit({x + 20, y + 20, 5}, source, engine));
+        }
+    }
+
+    // both maps set their viewports every frame, neither drops the tiles of the other
+    for (int frame = 0; frame < 20; frame++) {
+        executor.setViewport(&FIRST_MAP, first);
+        executor.setViewport(&SECOND_MAP, second);
+        std::this_thread::sleep_for(1ms);
+    }
+
+    for (auto& future : futures) {
+        EXPECT_TRUE(future.get());
+    }
+    EXPECT_EQ(executor.getMetrics().dropped, 0u);
+
+    // the tiles of a removed viewport are dropped
+    auto removed = executor.submit({0, 0, 3}, source, engine);
+    auto kept = executor.submit({20, 20, 5}, source, engine);
+    executor.removeViewport(&FIRST_MAP);
+    EXPECT_FALSE(executor.submit({1, 1, 3}, source, engine).get());
+    EXPECT_TRUE(kept.get());
+    removed.get();
+}
+}
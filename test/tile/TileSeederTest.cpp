@@ -0,0 +1,297 @@
+#include "src/tile/TileSeeder.h"
+#include "src/tile/TileSourceMBTiles.h"
+#include "src/tile/TileSourceUrl.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+using namespace std::chrono_literals;
+
+constexpr auto FILE_NAME = "tileSeederTest.mbtiles";
+const std::atomic_bool NOT_CANCELED = false;
+
+std::vector<std::byte> tileData(const tile::Coordinate& coord)
+{
+    const auto text = std::to_string(coord.z) + "/" + std::to_string(coord.x) + "/" + std::to_string(coord.y);
+    const auto bytes = reinterpret_cast<const std::byte*>(text.data());
+    return {bytes, bytes + text.size()};
+}
+
+// stands in for the tile server
+class FakeTileSource: public tile::TileSource {
+public:
+    explicit FakeTileSource(std::set<tile::Coordinate> missing = {}):
+        missing{std::move(missing)}
+    {}
+
+    std::vector<std::byte> request(const tile::Coordinate& coord, const std::atomic_bool& canceled) override
+    {
+        std::this_thread::sleep_for(delay);
+
+        std::scoped_lock lk{lock};
+        requested.push_back(coord);
+        if (canceled || missing.contains(coord)) {
+            return {};
+        }
+
+        return tileData(coord);
+    }
+
+    void stop() override {}
+    void restart() override {}
+
+    std::vector<tile::Coordinate> getRequested()
+    {
+        std::scoped_lock lk{lock};
+        return requested;
+    }
+
+    std::chrono::milliseconds delay = 0ms;
+
+private:
+    std::mutex lock;
+    std::set<tile::Coordinate> missing;
+    std::vector<tile::Coordinate> requested;
+};
+
+#ifndef _WIN32
+// serves z/x/y.png on the loopback interface with tileData as the body, the missing tiles are 404
+class LoopbackTileServer {
+public:
+    explicit LoopbackTileServer(std::set<tile::Coordinate> missing = {}):
+        missing{std::move(missing)}
+    {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t length = sizeof(address);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+            getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+            listen(listener, SOMAXCONN) != 0) {
+            return;
+        }
+
+        port = ntohs(address.sin_port);
+        thread = std::thread{[this]() { serve(); }};
+    }
+
+    ~LoopbackTileServer()
+    {
+        run = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        close(listener);
+    }
+
+    std::string getUrl() const { return "http://127.0.0.1:" + std::to_string(port) + "/{z}/{x}/{y}.png"; }
+    bool isListening() const noexcept { return port != 0; }
+
+private:
+    static constexpr int POLL_INTERVAL_MS = 20;
+
+    std::set<tile::Coordinate> missing;
+    int listener = -1;
+    int port = 0;
+    std::atomic_bool run = true;
+    std::thread thread;
+
+    void serve()
+    {
+        pollfd listening{listener, POLLIN, 0};
+        while (run) {
+            if (poll(&listening, 1, POLL_INTERVAL_MS) <= 0) {
+                continue;
+            }
+
+            if (const auto connection = accept(listener, nullptr, nullptr); connection >= 0) {
+                respond(connection);
+                close(connection);
+            }
+        }
+    }
+
+    void respond(int connection)
+    {
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            const auto received = recv(connection, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return;
+            }
+            request.append(buffer, received);
+        }
+
+        tile::Coordinate coord{};
+        std::string response;
+        if (std::sscanf(request.c_str(), "GET /%d/%d/%d.png", &coord.z, &coord.x, &coord.y) == 3 && !missing.contains(coord)) {
+            const auto data = tileData(coord);
+            response = "HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: " + std::to_string(data.size()) +
+                       "\r\nConnection: close\r\n\r\n" + std::string{reinterpret_cast<const char*>(data.data()), data.size()};
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        }
+
+        for (size_t sent = 0; sent < response.size();) {
+            const auto ret = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (ret <= 0) {
+                return;
+            }
+            sent += ret;
+        }
+    }
+};
+#endif
+
+class TileSeederTest : public ::testing::Test {
+public:
+    TileSeederTest()
+    {
+        std::remove(FILE_NAME);
+    }
+
+    ~TileSeederTest()
+    {
+        std::remove(FILE_NAME);
+    }
+};
+
+TEST_F(TileSeederTest, SeedRanges)
+{
+    auto source = std::make_shared<FakeTileSource>(std::set<tile::Coordinate>{{1, 1, 1}});
+    tile::TileSeeder seeder{FILE_NAME, source, {4, 0}};
+
+    ASSERT_TRUE(seeder.start({tile::Viewport{0, 0, 0, 0, 0}, tile::Viewport{1, 0, 1, 0, 1}}));
+    seeder.wait();
+
+    const auto progress = seeder.getProgress();
+    EXPECT_FALSE(seeder.isRunning());
+    EXPECT_EQ(progress.total, 5u);
+    EXPECT_EQ(progress.stored, 4u);
+    EXPECT_EQ(progress.failed, 1u);
+    EXPECT_EQ(progress.finished(), progress.total);
+
+    tile::TileSourceMBTiles mbtiles{FILE_NAME};
+    ASSERT_TRUE(mbtiles.isOpen());
+    EXPECT_EQ(mbtiles.request({0, 0, 0}, NOT_CANCELED), tileData({0, 0, 0}));
+    EXPECT_EQ(mbtiles.request({1, 0, 1}, NOT_CANCELED), tileData({1, 0, 1}));
+    EXPECT_TRUE(mbtiles.request({1, 1, 1}, NOT_CANCELED).empty());
+}
+
+TEST_F(TileSeederTest, ResumeSkipsStoredTiles)
+{
+    {
+        auto source = std::make_shared<FakeTileSource>(std::set<tile::Coordinate>{{1, 1, 1}});
+        tile::TileSeeder seeder{FILE_NAME, source, {2, 0}};
+        ASSERT_TRUE(seeder.start({tile::Viewport{1, 0, 1, 0, 1}}));
+        seeder.wait();
+    }
+
+    auto source = std::make_shared<FakeTileSource>();
+    tile::TileSeeder seeder{FILE_NAME, source, {2, 0}};
+    ASSERT_TRUE(seeder.start({tile::Viewport{1, 0, 1, 0, 1}}));
+    seeder.wait();
+
+    const auto progress = seeder.getProgress();
+    EXPECT_EQ(progress.skipped, 3u);
+    EXPECT_EQ(progress.stored, 1u);
+    EXPECT_EQ(source->getRequested(), (std::vector<tile::Coordinate>{{1, 1, 1}}));
+}
+
+TEST_F(TileSeederTest, RateLimit)
+{
+    auto source = std::make_shared<FakeTileSource>();
+    tile::TileSeeder seeder{FILE_NAME, source, {4, 20}};
+
+    const auto begin = std::chrono::steady_clock::now();
+    ASSERT_TRUE(seeder.start({tile::Viewport{2, 0, 1, 0, 2}}));
+    seeder.wait();
+
+    // 6 requests at 20 per second, the first one goes at once
+    EXPECT_GE(std::chrono::steady_clock::now() - begin, 240ms);
+    EXPECT_EQ(seeder.getProgress().stored, 6u);
+}
+
+TEST_F(TileSeederTest, Stop)
+{
+    auto source = std::make_shared<FakeTileSource>();
+    tile::TileSeeder seeder{FILE_NAME, source, {1, 10}};
+
+    ASSERT_TRUE(seeder.start({tile::Viewport{4, 0, 15, 0, 15}}));
+    std::this_thread::sleep_for(250ms);
+    seeder.stop();
+
+    const auto progress = seeder.getProgress();
+    EXPECT_FALSE(seeder.isRunning());
+    EXPECT_GT(progress.stored, 0u);
+    EXPECT_LT(progress.finished(), progress.total);
+
+    // the stored tiles are committed
+    tile::TileSourceMBTiles mbtiles{FILE_NAME};
+    EXPECT_EQ(mbtiles.request({0, 0, 4}, NOT_CANCELED), tileData({0, 0, 4}));
+}
+
+TEST_F(TileSeederTest, StartTwice)
+{
+    auto source = std::make_shared<FakeTileSource>();
+    source->delay = 50ms;
+    tile::TileSeeder seeder{FILE_NAME, source, {1, 0}};
+
+    ASSERT_TRUE(seeder.start({tile::Viewport{1, 0, 1, 0, 1}}));
+    EXPECT_FALSE(seeder.start({tile::Viewport{1, 0, 1, 0, 1}}));
+    seeder.wait();
+
+    EXPECT_TRUE(seeder.start({tile::Viewport{1, 0, 1, 0, 1}}));
+    seeder.wait();
+    EXPECT_EQ(seeder.getProgress().skipped, 4u);
+}
+
+#ifndef _WIN32
+TEST_F(TileSeederTest, SeedFromTileServer)
+{
+    LoopbackTileServer server{std::set<tile::Coordinate>{{1, 1, 1}}};
+    ASSERT_TRUE(server.isListening());
+    // the loopback server is never reached through a proxy
+    setenv("NO_PROXY", "127.0.0.1", 1);
+
+    auto source = std::make_shared<tile::TileSourceUrl>(server.getUrl());
+    tile::TileSeeder seeder{FILE_NAME, source, {2, 0}};
+
+    ASSERT_TRUE(seeder.start({tile::Viewport{0, 0, 0, 0, 0}, tile::Viewport{1, 0, 1, 0, 1}}));
+    seeder.wait();
+
+    const auto progress = seeder.getProgress();
+    EXPECT_EQ(progress.total, 5u);
+    EXPECT_EQ(progress.stored, 4u);
+    EXPECT_EQ(progress.failed, 1u);
+
+    tile::TileSourceMBTiles mbtiles{FILE_NAME};
+    ASSERT_TRUE(mbtiles.isOpen());
+    EXPECT_EQ(mbtiles.request({0, 0, 0}, NOT_CANCELED), tileData({0, 0, 0}));
+    EXPECT_EQ(mbtiles.request({0, 1, 1}, NOT_CANCELED), tileData({0, 1, 1}));
+    EXPECT_EQ(mbtiles.request({1, 0, 1}, NOT_CANCELED), tileData({1, 0, 1}));
+    EXPECT_TRUE(mbtiles.request({1, 1, 1}, NOT_CANCELED).empty());
+}
+#endif
+}
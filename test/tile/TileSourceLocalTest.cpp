@@ -0,0 +1,114 @@
+#include "src/tile/TileSourceMBTiles.h"
+#include "src/tile/TileSourceDirectory.h"
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr auto MBTILES_NAME = "tileSourceLocalTest.mbtiles";
+constexpr auto DIRECTORY_NAME = "tileSourceLocalTest";
+const std::atomic_bool NOT_CANCELED = false;
+
+std::vector<std::byte> toBytes(const std::string& text)
+{
+    const auto bytes = reinterpret_cast<const std::byte*>(text.data());
+    return {bytes, bytes + text.size()};
+}
+
+class TileSourceLocalTest : public ::testing::Test {
+public:
+    TileSourceLocalTest()
+    {
+        remove();
+    }
+
+    ~TileSourceLocalTest()
+    {
+        remove();
+    }
+
+protected:
+    void createMBTiles()
+    {
+        sqlite3* db = nullptr;
+        ASSERT_EQ(sqlite3_open(MBTILES_NAME, &db), SQLITE_OK);
+        // x=1, y=0 in XYZ at zoom 1 is row 1 in TMS
+        ASSERT_EQ(sqlite3_exec(db,
+                               "CREATE TABLE metadata (name TEXT, value TEXT);"
+                               "CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB);"
+                               "INSERT INTO tiles VALUES (1, 1, 1, CAST('north' AS BLOB));"
+                               "INSERT INTO tiles VALUES (1, 1, 0, CAST('south' AS BLOB));",
+                               nullptr, nullptr, nullptr), SQLITE_OK);
+        sqlite3_close(db);
+    }
+
+    void createDirectory()
+    {
+        std::filesystem::create_directories(std::filesystem::path{DIRECTORY_NAME} / "2" / "3");
+        std::ofstream{std::filesystem::path{DIRECTORY_NAME} / "2" / "3" / "1.png", std::ios::binary} << "png";
+        std::ofstream{std::filesystem::path{DIRECTORY_NAME} / "2" / "3" / "2.jpg", std::ios::binary} << "jpg";
+    }
+
+private:
+    void remove()
+    {
+        std::remove(MBTILES_NAME);
+        std::filesystem::remove_all(DIRECTORY_NAME);
+    }
+};
+
+TEST_F(TileSourceLocalTest, MBTilesFlipRow)
+{
+    createMBTiles();
+    tile::TileSourceMBTiles source{MBTILES_NAME};
+
+    ASSERT_TRUE(source.isOpen());
+    EXPECT_EQ(source.request(tile::Coordinate{1, 0, 1}, NOT_CANCELED), toBytes("north"));
+    EXPECT_EQ(source.request(tile::Coordinate{1, 1, 1}, NOT_CANCELED), toBytes("south"));
+    EXPECT_TRUE(source.request(tile::Coordinate{0, 0, 1}, NOT_CANCELED).empty());
+}
+
+TEST_F(TileSourceLocalTest, MBTilesStop)
+{
+    createMBTiles();
+    tile::TileSourceMBTiles source{MBTILES_NAME};
+
+    source.stop();
+    EXPECT_TRUE(source.request(tile::Coordinate{1, 0, 1}, NOT_CANCELED).empty());
+
+    source.restart();
+    EXPECT_EQ(source.request(tile::Coordinate{1, 0, 1}, NOT_CANCELED), toBytes("north"));
+}
+
+TEST_F(TileSourceLocalTest, MBTilesInvalidFile)
+{
+    EXPECT_FALSE(tile::TileSourceMBTiles{MBTILES_NAME}.isOpen());
+
+    std::ofstream{MBTILES_NAME} << "not a database";
+    EXPECT_FALSE(tile::TileSourceMBTiles{MBTILES_NAME}.isOpen());
+}
+
+TEST_F(TileSourceLocalTest, Directory)
+{
+    createDirectory();
+    tile::TileSourceDirectory source{DIRECTORY_NAME};
+
+    ASSERT_TRUE(source.isOpen());
+    EXPECT_EQ(source.request(tile::Coordinate{3, 1, 2}, NOT_CANCELED), toBytes("png"));
+    EXPECT_EQ(source.request(tile::Coordinate{3, 2, 2}, NOT_CANCELED), toBytes("jpg"));
+    EXPECT_TRUE(source.request(tile::Coordinate{3, 3, 2}, NOT_CANCELED).empty());
+}
+
+TEST_F(TileSourceLocalTest, DirectoryMissing)
+{
+    tile::TileSourceDirectory source{DIRECTORY_NAME};
+
+    EXPECT_FALSE(source.isOpen());
+    EXPECT_TRUE(source.request(tile::Coordinate{3, 1, 2}, NOT_CANCELED).empty());
+}
+}
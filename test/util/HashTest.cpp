@@ -0,0 +1,34 @@
+#include "src/util/Hash.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+// the expected values are from the reference MurmurHash3_x64_128 with seed 0
+TEST(HashTest, Empty)
+{
+    EXPECT_EQ(util::hash128(std::string_view{}), (util::Hash128{0, 0}));
+}
+
+TEST(HashTest, ShorterThanOneBlock)
+{
+    EXPECT_EQ(util::hash128("a"), (util::Hash128{0x85555565f6597889ULL, 0xe6b53a48510e895aULL}));
+    EXPECT_EQ(util::hash128("hello world"), (util::Hash128{0x533f6046eb7f610eULL, 0xab97467d60eb63b1ULL}));
+}
+
+TEST(HashTest, BlocksAndTail)
+{
+    EXPECT_EQ(util::hash128("0123456789abcdef0123456789abcdefXYZ"), (util::Hash128{0x263a542fa3e51fc6ULL, 0x27c22087bbcaa495ULL}));
+}
+
+TEST(HashTest, BytesRoundTrip)
+{
+    const auto hash = util::hash128("hello world");
+    const auto bytes = hash.bytes();
+
+    EXPECT_EQ(util::Hash128::fromBytes(bytes.data(), bytes.size()), hash);
+    EXPECT_EQ(util::Hash128::fromBytes(bytes.data(), bytes.size() - 1), std::nullopt);
+    EXPECT_EQ(util::Hash128::fromBytes(nullptr, 0), std::nullopt);
+}
+}